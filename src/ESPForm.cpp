@@ -53,23 +53,33 @@ ESPFormClass::ESPFormClass()
 #if defined(ESP32)
     _index = -1;
     _xTaskHandle = NULL;
+    _update_mutex = xSemaphoreCreateRecursiveMutex();
 #endif
 }
 
 ESPFormClass::~ESPFormClass()
 {
     terminateServer();
+#if defined(ESP32)
+    vSemaphoreDelete(_update_mutex);
+#endif
 }
 
 void ESPFormClass::terminateServer()
 {
     stopServer();
-    if (_form_config)
-    {
-        _form_config->clear();
-        _form_config.reset();
-        _form_config = nullptr;
-    }
+    _elements.clear();
+    _app_script.clear();
+    _app_script_rdy = false;
+    _pending.clear();
+    _pending_data.clear();
+    _pending_frames = 0;
+    _pending_bytes = 0;
+    _update_started = false;
+    _shadow.clear();
+    _shadow_connected.clear();
+    _shadow_dropped.clear();
+    _assembly.clear();
     if (_web_socket_ptr)
     {
         _web_socket_ptr.reset();
@@ -78,6 +88,8 @@ void ESPFormClass::terminateServer()
         _web_server_ptr = nullptr;
     }
     _file_info.clear();
+    _file_slots.clear();
+    _bundles.clear();
 #if defined(ESP8266)
     if (_dns_server_ptr)
     {
@@ -89,42 +101,86 @@ void ESPFormClass::terminateServer()
 
 size_t ESPFormClass::getFileCount()
 {
-    return _file_info.size();
+    size_t count = _file_info.size();
+    for (size_t i = 0; i < _bundles.size(); i++)
+        count += ESPFormBundle(_bundles[i]).size();
+    return count;
 }
 
 void ESPFormClass::deleteAllFiles()
 {
     _file_info.clear();
+    _file_slots.clear();
+    _bundles.clear();
 }
 
 void ESPFormClass::addFileData(PGM_P content, const char *fileName)
 {
     file_content_info_t f;
     f.content = content;
-    f.name = fileName;
-    f.gzip = false;
     f.len = strlen_P(content);
-    _file_info.push_back(f);
+    f.hash = contentHash(content, f.len);
+    addFileInfo(f, fileName);
 }
 
 void ESPFormClass::addFileData(const uint8_t *content, const char *fileName, size_t length, bool gzip)
+{
+    addFileData(content, fileName, length, gzip ? esp_form_encoding_gzip : esp_form_encoding_identity);
+}
+
+void ESPFormClass::addFileData(const uint8_t *content, const char *fileName, size_t length, ESPFormEncoding encoding)
 {
     file_content_info_t f;
     f.content = reinterpret_cast<const char *>(content);
     f.len = length;
-    f.gzip = gzip;
-    f.name = fileName;
-    _file_info.push_back(f);
+    f.encoding = encoding;
+    f.hash = contentHash(f.content, f.len);
+    addFileInfo(f, fileName);
 }
 
 void ESPFormClass::addFile(const char *fileName, const char *filePath, ESPFormStorageType storagetype)
 {
     file_content_info_t f;
     f.content = NULL;
-    f.name = fileName;
     f.path = filePath;
     f.storageType = storagetype;
-    _file_info.push_back(f);
+    addFileInfo(f, fileName);
+}
+
+bool ESPFormClass::addBundle(const uint8_t *bundle)
+{
+    if (!bundle || !ESPFormBundle(bundle).valid())
+        return false;
+    _bundles.push_back(bundle);
+    return true;
+}
+
+String ESPFormClass::getFileURL(const char *fileName)
+{
+    MB_String s;
+    if (fileName[0] != '/')
+        s = espform_str_13;
+    s += fileName;
+
+    uint32_t hash = 0;
+    int index = findFile(s.c_str(), s.length());
+    espform_bundle_entry_t e;
+    const uint8_t *bundle = nullptr;
+
+    // the version is the hash of the first variant
+    if (index > -1)
+        hash = _file_info[index].content ? _file_info[index].hash : 0;
+    else if (findBundleFile(s.c_str(), s.length(), e, bundle) > -1)
+        hash = e.hash;
+
+    if (hash)
+    {
+        char buf[12];
+        sprintf(buf, "?%s=%08x", pgm2Str(espform_str_102), (unsigned int)hash);
+        s += buf;
+    }
+
+    return s.c_str();
 }
 
 void ESPFormClass::setIP(IPAddress local_ip, IPAddress gateway, IPAddress subnet)
@@ -192,170 +248,242 @@ void ESPFormClass::begin(ElementEventCallback eventCallback, IdleTimeoutCallback
 
 void ESPFormClass::addElementEventListener(const String &id, ESPFormEventType event, const char *defaultValue)
 {
-    prepareConfig();
-
-    FirebaseJson json;
-    json.add(pgm2Str(espform_str_16), id);
-    json.add(pgm2Str(espform_str_17), (int)event);
-    if (defaultValue != NULL)
-        json.add(pgm2Str(espform_str_18), defaultValue);
-    else
-        json.add(pgm2Str(espform_str_18));
-    _form_config->add(json);
+    // the registry is shared with the server task, see lockUpdate
+    lockUpdate();
+    _elements.add(id.c_str(), (uint8_t)event, defaultValue);
+    unlockUpdate();
 }
 
 void ESPFormClass::saveElementEventConfig(const String &fileName, ESPFormStorageType storagetype)
 {
-    prepareConfig();
+    lockUpdate();
 
-    if (_form_config->size() == 0)
+    if (_elements.size() == 0)
+    {
+        unlockUpdate();
         return;
+    }
 
-    FirebaseJson json;
-    json.add(pgm2Str(espform_str_23), *_form_config);
-
-    if (_mbfs.open(fileName, (mb_fs_mem_storage_type)storagetype, mb_fs_open_mode_write) < 0)
+    int handle = _mbfs.openHandle(fileName, (mb_fs_mem_storage_type)storagetype, mb_fs_open_mode_write);
+    if (handle < 0)
+    {
+        unlockUpdate();
         return;
+    }
 
+    Stream *out = nullptr;
     if (storagetype == esp_form_storage_flash)
-        json.toString(_mbfs.getFlashFile());
+        out = &_mbfs.getFlashFile(handle);
     else if (storagetype == esp_form_storage_sd)
-        json.toString(_mbfs.getSDFile());
+        out = &_mbfs.getSDFile(handle);
+
+    // the elements are written to the file one by one, only one element is in memory
+    // instead of the whole {"esp":[..]} tree and its string
+    if (out)
+    {
+        FirebaseJson item;
+        bool ok = out->print(pgm2Str(espform_str_106)) > 0;
+        for (size_t k = 0; ok && k < _elements.size(); k++)
+        {
+            item.clear();
+            item.add(pgm2Str(espform_str_16), _elements.id(k));
+            item.add(pgm2Str(espform_str_17), (int)_elements.event(k));
+            if (_elements.hasValue(k))
+                item.add(pgm2Str(espform_str_18), _elements.value(k));
+            else
+                item.add(pgm2Str(espform_str_18));
+
+            ok = (k == 0 || out->write(',') == 1) && item.toString(*out);
+        }
+
+        if (ok)
+            out->print(pgm2Str(espform_str_107));
+    }
 
-    _mbfs.close((mb_fs_mem_storage_type)storagetype);
+    _mbfs.closeHandle(handle);
+    unlockUpdate();
 }
 
-void ESPFormClass::loadElementEventConfig(const String &fileName, ESPFormStorageType storagetype)
+// loads the {"esp":[{"id":..,"event":..,"value":..},..]} config into the elements while reading
+class ESPFormConfigVisitor : public MB_JSONVisitor
 {
-    FirebaseJson js;
-
-    if (_mbfs.open(fileName, (mb_fs_mem_storage_type)storagetype, mb_fs_open_mode_read) < 0)
-        return;
+public:
+    ESPFormConfigVisitor(ESPFormElements &elements) : _elements(elements) {}
 
-    if (storagetype == esp_form_storage_flash)
-        js.readFrom(_mbfs.getFlashFile());
-    else if (storagetype == esp_form_storage_sd)
-        js.readFrom(_mbfs.getSDFile());
+    // the element list was found
+    bool started() const { return _started; }
 
-    _mbfs.close((mb_fs_mem_storage_type)storagetype);
+    bool startObject() override
+    {
+        _depth++;
+        if (_depth == 3 && _inList)
+        {
+            _id.clear();
+            _value.clear();
+            _event = 0;
+            _hasId = false;
+            _hasValue = false;
+        }
+        return true;
+    }
 
-    FirebaseJsonData d;
-    MB_String s = espform_str_13;
-    s += espform_str_23;
-    js.get(d, s);
-    if (d.success)
+    bool endObject() override
     {
-        _form_config.reset();
-        _form_config = nullptr;
-        _form_config = std::shared_ptr<FirebaseJsonArray>(new FirebaseJsonArray());
-        d.getArray(*_form_config);
+        if (_depth == 3 && _inList && _hasId)
+            _elements.add(_id.c_str(), _event, _hasValue ? _value.c_str() : NULL);
+        _depth--;
+        return true;
     }
-}
 
-ESPFormClass::HTMLElementItem ESPFormClass::getElementEventConfigItem(const String &id)
-{
+    bool startArray() override
+    {
+        _depth++;
+        if (_depth == 2 && _listKey)
+        {
+            _inList = true;
+            _started = true;
+            _elements.clear();
+        }
+        return true;
+    }
 
-    FirebaseJsonData result;
-    bool res = false;
-    MB_String s;
-    HTMLElementItem element;
+    bool endArray() override
+    {
+        if (_depth == 2)
+            _inList = false;
+        _depth--;
+        return true;
+    }
 
-    prepareConfig();
+    bool key(const char *key, size_t len) override
+    {
+        if (_depth == 1)
+            _listKey = strcmp_P(key, espform_str_23) == 0;
+        else if (_depth == 3)
+        {
+            _field = -1;
+            if (strcmp_P(key, espform_str_16) == 0)
+                _field = 0;
+            else if (strcmp_P(key, espform_str_17) == 0)
+                _field = 1;
+            else if (strcmp_P(key, espform_str_18) == 0)
+                _field = 2;
+        }
+        return true;
+    }
 
-    for (size_t k = 0; k < _form_config->size(); k++)
+    bool value(const mb_json_reader_value_t &value) override
     {
-        getPath(0, k, s);
-        _form_config->get(result, s);
-        if (result.success)
+        if (_depth != 3 || !_inList || value.type == MB_JSON_NULL)
+            return true;
+
+        // the long string comes in pieces
+        if (_field == 0)
         {
-            if (id == result.stringValue)
-            {
-                element.id = id;
-                res = true;
-                getPath(1, k, s);
-                _form_config->get(result, s);
-                if (result.success)
-                {
-                    res &= true;
-                    element.event = (ESPFormEventType)result.intValue;
-                }
-                getPath(2, k, s);
-                _form_config->get(result, s);
-                if (result.success)
-                {
-                    res &= true;
-                    element.value = result.to<String>();
-                }
-                element.success = res;
-                break;
-            }
+            if (!_continued)
+                _id.clear();
+            _id.append(value.str, value.len);
+            _hasId = true;
         }
+        else if (_field == 1)
+            _event = value.type == MB_JSON_Number ? (int)value.number : 0;
+        else if (_field == 2)
+        {
+            if (!_continued)
+                _value.clear();
+            _value.append(value.str, value.len);
+            _hasValue = true;
+        }
+        _continued = value.more;
+        return true;
     }
-    return element;
-}
 
-void ESPFormClass::setElementEventConfigItem(HTMLElementItem &element)
+private:
+    ESPFormElements &_elements;
+    size_t _depth = 0;
+    bool _listKey = false;
+    bool _inList = false;
+    bool _started = false;
+    int _field = -1;
+    MB_String _id;
+    MB_String _value;
+    uint8_t _event = 0;
+    bool _hasId = false;
+    bool _hasValue = false;
+    bool _continued = false;
+};
+
+void ESPFormClass::loadElementEventConfig(const String &fileName, ESPFormStorageType storagetype)
 {
+    int handle = _mbfs.openHandle(fileName, (mb_fs_mem_storage_type)storagetype, mb_fs_open_mode_read);
+    if (handle < 0)
+        return;
 
-    FirebaseJsonData result;
-    MB_String s;
+    // the elements are added as the file was read in chunks, no JSON text or tree is kept,
+    // the registry is replaced only when the whole file was read
+    ESPFormElements elements;
+    ESPFormConfigVisitor visitor(elements);
+    MB_JSONReader reader(visitor);
+    bool ret = false;
 
-    prepareConfig();
+    if (storagetype == esp_form_storage_flash)
+        ret = reader.read(_mbfs.getFlashFile(handle));
+    else if (storagetype == esp_form_storage_sd)
+        ret = reader.read(_mbfs.getSDFile(handle));
 
-    for (size_t k = 0; k < _form_config->size(); k++)
-    {
-        getPath(0, k, s);
-        _form_config->get(result, s);
-        if (result.success)
-        {
-            if (element.id == result.stringValue)
-            {
-                if (element.event > 0)
-                {
-                    getPath(1, k, s);
-                    _form_config->set(s, (int)element.event);
-                }
+    _mbfs.closeHandle(handle);
 
-                getPath(2, k, s);
-                _form_config->set(s, element.value);
-                break;
-            }
-        }
+    // the broken config or the config without element list keeps the current elements
+    if (ret && visitor.started())
+    {
+        lockUpdate();
+        _elements.swap(elements);
+        unlockUpdate();
     }
 }
 
-void ESPFormClass::removeElementEventConfigItem(const String &id)
+ESPFormClass::HTMLElementItem ESPFormClass::getElementEventConfigItem(const String &id)
 {
-    FirebaseJsonData result;
-    MB_String s;
+    HTMLElementItem element;
 
-    prepareConfig();
+    lockUpdate();
+    int index = _elements.find(id.c_str(), id.length());
+    if (index > -1)
+    {
+        element.id = id;
+        element.event = (ESPFormEventType)_elements.event(index);
+        element.value = _elements.value(index);
+        element.success = true;
+    }
+    unlockUpdate();
+    return element;
+}
 
-    for (size_t k = 0; k < _form_config->size(); k++)
+void ESPFormClass::setElementEventConfigItem(HTMLElementItem &element)
+{
+    lockUpdate();
+    int index = _elements.find(element.id.c_str(), element.id.length());
+    if (index > -1)
     {
-        getPath(0, k, s);
-        _form_config->get(result, s.c_str());
-        if (result.success)
-        {
-            if (id == result.stringValue)
-            {
-                _form_config->remove(k);
-                break;
-            }
-        }
+        if (element.event > 0)
+            _elements.setEvent(index, (uint8_t)element.event);
+        _elements.setValue(index, element.value.c_str(), element.value.length());
     }
+    unlockUpdate();
 }
 
-void ESPFormClass::clearElementEventConfig()
+void ESPFormClass::removeElementEventConfigItem(const String &id)
 {
-    prepareConfig();
-    _form_config->clear();
+    lockUpdate();
+    _elements.remove(id.c_str());
+    unlockUpdate();
 }
 
-void ESPFormClass::prepareConfig()
+void ESPFormClass::clearElementEventConfig()
 {
-    if (!_form_config)
-        _form_config = std::shared_ptr<FirebaseJsonArray>(new FirebaseJsonArray());
+    lockUpdate();
+    _elements.clear();
+    unlockUpdate();
 }
 
 String ESPFormClass::getElementEventString(ESPFormEventType event)
@@ -492,204 +620,944 @@ String ESPFormClass::getWiFiEncrytionTypeString(EncriptionType encType)
 
 void ESPFormClass::getElementContent(const char *id)
 {
-    MB_String s = espform_str_19;
-    s += id;
-    s += espform_str_22;
     if (_debug)
         Serial.println(pgm2Str(espform_str_73));
 
-    _web_socket_ptr->broadcastTXT(s.c_str(), s.length());
+    lockUpdate();
+
+    if (batchingUpdate())
+    {
+        queueGet(id);
+        unlockUpdate();
+        return;
+    }
+
+    if (_binary_mode)
+    {
+        beginFrame();
+        frameGet(id);
+        endFrame();
+    }
+    else
+    {
+        _frame_text = espform_str_19;
+        escapeString(_frame_text, id, strlen(id));
+        _frame_text += espform_str_22;
+    }
+
+    sendFrame(-1);
+
+    unlockUpdate();
 }
 
 void ESPFormClass::setElementContent(const char *id, const String &content)
 {
-    MB_String s = espform_str_20;
-    s += id;
-    s += espform_str_21;
-    s += content;
-    s += espform_str_22;
-    if (_debug)
-        Serial.println(pgm2Str(espform_str_74));
-
-    _web_socket_ptr->broadcastTXT(s.c_str(), s.length());
+    setElementContent(id, content.c_str());
 }
 
-void ESPFormClass::runScript(const String &script)
+void ESPFormClass::setElementContent(const char *id, const char *content)
 {
-    if (_debug)
-    {
-        Serial.println(pgm2Str(espform_str_75));
-        Serial.println(script.c_str());
-    }
-    _web_socket_ptr->broadcastTXT(script.c_str(), script.length());
+    espform_value_t value;
+    value.type = espform_value_type_string;
+    value.str = content;
+    value.len = strlen(content);
+    updateElementContent(id, value);
 }
 
-void ESPFormClass::getPath(uint8_t type, int index, MB_String &buf)
+void ESPFormClass::setElementContent(const char *id, int content)
 {
-    buf = espform_str_14;
-    buf += index;
-    buf += espform_str_15;
-
-    switch (type)
-    {
-    case 0:
-        buf += espform_str_16;
-        break;
-    case 1:
-        buf += espform_str_17;
-        break;
+    espform_value_t value;
+    value.type = espform_value_type_int;
+    value.intValue = content;
+    updateElementContent(id, value);
+}
 
-    case 2:
-        buf += espform_str_18;
-        break;
+void ESPFormClass::setElementContent(const char *id, unsigned int content)
+{
+    setIntegerContent(id, false, content);
+}
 
-    default:
-        break;
-    }
+void ESPFormClass::setElementContent(const char *id, long content)
+{
+    setIntegerContent(id, content < 0, content < 0 ? 0ULL - (unsigned long long)content : content);
 }
 
-void ESPFormClass::stopServer()
+void ESPFormClass::setElementContent(const char *id, unsigned long content)
 {
-    if (_web_socket_ptr)
-    {
-        _web_socket_ptr->disconnect();
-        _web_socket_ptr->close();
-    }
-    if (_web_server_ptr)
-        _web_server_ptr->close();
+    setIntegerContent(id, false, content);
+}
 
-    _ap_started = false;
-    _idle_to._serverStarted = false;
-    _idle_to._serverRun = false;
-    _idle_to._idleTime = 0;
-    _idle_to._clientCount = 0;
-    _idle_to._idleStarted = false;
+void ESPFormClass::setElementContent(const char *id, long long content)
+{
+    setIntegerContent(id, content < 0, content < 0 ? 0ULL - (unsigned long long)content : content);
 }
 
-void ESPFormClass::startServer()
+void ESPFormClass::setElementContent(const char *id, unsigned long long content)
 {
-    stopServer();
+    setIntegerContent(id, false, content);
+}
 
-    if (!_ap_started && _ap_ssid.length() > 0 && _ap_ssid.length() < 32 && _ap_psw.length() >= 8 && _ap_psw.length() < 64)
+void ESPFormClass::setIntegerContent(const char *id, bool negative, unsigned long long magnitude)
+{
+    espform_value_t value;
+    if (magnitude <= (negative ? 0x80000000ULL : 0x7fffffffULL))
     {
-        startAP();
-        startDNSServer();
-        _ap_started = true;
+        value.type = espform_value_type_int;
+        value.intValue = negative ? (int32_t)(0U - (uint32_t)magnitude) : (int32_t)magnitude;
+        updateElementContent(id, value);
+        return;
     }
-    if (!_idle_to._serverStarted)
-    {
-        startWebSocket();
-        startWebServer();
-        if (!_task_created)
-        {
-            _idle_to._serverRun = true;
-            serverRun();
-        }
 
-        _idle_to._serverStarted = true;
-    }
+    // the binary int value is 32-bit, the wider integer is sent as its decimal text
+    char buf[ESPFORM_VALUE_TEXT_SIZE];
+    char *p = buf + sizeof(buf);
+    *--p = 0;
+    do
+    {
+        *--p = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (negative)
+        *--p = '-';
+
+    value.type = espform_value_type_string;
+    value.str = p;
+    value.len = buf + sizeof(buf) - 1 - p;
+    updateElementContent(id, value);
 }
 
-void ESPFormClass::startAP()
+void ESPFormClass::setElementContent(const char *id, double content)
 {
-    stopAP();
+    espform_value_t value;
+    value.type = espform_value_type_float;
+    value.floatValue = content;
+    updateElementContent(id, value);
+}
 
-    if (_ipConfig)
-    {
-        if (!WiFi.softAPConfig(_ip, _gateway, _subnet) && _debug)
-        {
-            Serial.println(pgm2Str(espform_str_76));
-            return;
-        }
-    }
+void ESPFormClass::setElementContent(const char *id, bool content)
+{
+    espform_value_t value;
+    value.type = content ? espform_value_type_true : espform_value_type_false;
+    updateElementContent(id, value);
+}
 
-    WiFi.enableAP(true);
+bool ESPFormClass::setBinaryMode(bool enable)
+{
+    if (enable == _binary_mode)
+        return true;
 
-    if (WiFi.softAP(_ap_ssid.c_str(), _ap_psw.c_str(), _channel, _ssid_hidden, _max_connection))
-    {
-        IPAddress address = WiFi.softAPIP();
-        if (_debug)
-            Serial.printf(pgm2Str(espform_str_77), _ap_ssid.c_str(), _ap_psw.c_str(), address.toString().c_str());
-    }
-    else
+    // the connected webpages keep decoding the previous mode until they were reloaded
+    if (getClientCount() > 0)
     {
         if (_debug)
-            Serial.println(pgm2Str(espform_str_78));
+            Serial.println(pgm2Str(espform_str_108));
+        return false;
     }
+
+    _binary_mode = enable;
+    _app_script_rdy = false;
+    return true;
 }
 
-void ESPFormClass::stopAP()
+void ESPFormClass::setMaxClients(uint8_t max)
 {
-    WiFi.softAPdisconnect(true);
+    if (max > 0)
+        _web_socket_client_max = max;
 }
 
-void ESPFormClass::startDNSServer()
+void ESPFormClass::setMaxMessageSize(size_t size)
 {
-#ifdef ESP32
-    MB_String s = espform_str_4;
-    MDNS.begin(s.c_str());
-#elif defined(ESP8266)
-    _dns_server_ptr.reset(new DNSServer());
-    _dns_server_ptr->setErrorReplyCode(DNSReplyCode::NoError);
-    _dns_server_ptr->start(_dns_port, "*", WiFi.softAPIP());
-
-    if (_debug)
-        Serial.println(pgm2Str(espform_str_79));
-#endif
+    _max_message_size = size;
 }
 
-void ESPFormClass::startWebServer()
+void ESPFormClass::setMessageStreamCallback(MessageStreamCallback streamCallback)
 {
-    _web_server_ptr->on("/", std::bind(&ESPFormClass::handleFileRead, this));
-    _web_server_ptr->onNotFound(std::bind(&ESPFormClass::handleNotFound, this));
-    _web_server_ptr->begin();
-    if (_debug)
-        Serial.println(pgm2Str(espform_str_80));
+    _messageStreamCallback = streamCallback;
 }
 
-void ESPFormClass::startWebSocket()
+void ESPFormClass::setSendQueue(size_t maxBytes, WSqueuePolicy_t policy)
 {
+    _send_queue_size = maxBytes;
+    _send_queue_policy = policy;
     if (_web_socket_ptr)
-    {
-        _web_socket_ptr->begin();
-        _web_socket_ptr->onEvent(std::bind(&ESPFormClass::webSocketEvent, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
-        if (_debug)
-            Serial.println(pgm2Str(espform_str_81));
-    }
+        _web_socket_ptr->setSendQueue(_send_queue_size, _send_queue_policy);
 }
 
-void ESPFormClass::handleNotFound()
+bool ESPFormClass::getSendQueueStats(uint8_t num, WSqueueStats_t &stats)
 {
-    if (!isIP(_web_server_ptr->hostHeader()))
-        goLandingPage();
-    else if (!handleFileRead())
-        _web_server_ptr->send(404, pgm2Str(espform_str_7), pgm2Str(espform_str_38));
+    if (!_web_socket_ptr)
+        return false;
+    return _web_socket_ptr->getSendQueueStats(num, &stats);
 }
 
-void ESPFormClass::getMIME(const String &ext, String &mime)
+void ESPFormClass::updateElementContent(const char *id, const espform_value_t &value)
 {
-    mime = "";
-    char *tmp = new char[50];
-    for (int i = 0; i < maxType; i++)
-    {
-        if (strcmp_P(ext.c_str(), ESPForm_MIMEInfo[i].endsWith) == 0)
-        {
-            memset(tmp, 0, 50);
-            strcpy_P(tmp, ESPForm_MIMEInfo[i].mimeType);
-            mime = tmp;
-            break;
-        }
-    }
-    delete[] tmp;
-}
+    if (_debug)
+        Serial.println(pgm2Str(espform_str_74));
 
-bool ESPFormClass::handleFileRead()
-{
-    bool res = false;
+    char buf[ESPFORM_VALUE_TEXT_SIZE];
+    size_t len = 0;
+    const char *text = value.text(buf, len);
 
-    String path = _web_server_ptr->uri();
+    // the registry value is changed by the server task on the client events, the lock is kept until the frame was sent
+    lockUpdate();
+
+    int index = _elements.find(id);
+    if (index > -1)
+        _elements.setValue(index, text, len);
+
+    if (batchingUpdate())
+    {
+        queueSet(id, value.type, text, len);
+        unlockUpdate();
+        return;
+    }
+
+    if (_binary_mode)
+    {
+        beginFrame();
+        frameSet(id, value);
+        endFrame();
+    }
+    else
+    {
+        _frame_text = espform_str_20;
+        escapeString(_frame_text, id, strlen(id));
+        _frame_text += espform_str_21;
+        escapeString(_frame_text, text, len);
+        _frame_text += espform_str_22;
+    }
+
+    if (index < 0)
+    {
+        sendFrame(-1);
+        unlockUpdate();
+        return;
+    }
+
+    syncShadow();
+
+    size_t clients = 0;
+    std::vector<uint8_t> nums;
+
+    for (size_t num = 0; num < _shadow.size(); num++)
+    {
+        if (!_shadow_connected[num])
+            continue;
+        clients++;
+        if (updateShadow(num, index, text, len))
+            nums.push_back(num);
+    }
+
+    _update_stats.framesSaved += clients - nums.size();
+    _update_stats.bytesSaved += (clients - nums.size()) * frameSize(frameLength());
+
+    if (nums.size() > 0 && nums.size() == clients)
+        sendFrame(-1);
+    else
+    {
+        for (size_t i = 0; i < nums.size(); i++)
+            sendFrame(nums[i]);
+    }
+
+    unlockUpdate();
+}
+
+void ESPFormClass::beginUpdate()
+{
+    lockUpdate();
+    _update_started = true;
+    unlockUpdate();
+}
+
+void ESPFormClass::commitUpdate()
+{
+    lockUpdate();
+    _update_started = false;
+    flushUpdate();
+    unlockUpdate();
+}
+
+void ESPFormClass::setUpdateWindow(unsigned long interval, size_t maxSize)
+{
+    lockUpdate();
+    _update_interval = interval;
+    _update_max_size = maxSize;
+    if (interval == 0 && !_update_started)
+        flushUpdate();
+    unlockUpdate();
+}
+
+bool ESPFormClass::batchingUpdate()
+{
+    // called with the update lock held
+    return _update_started || _update_interval > 0;
+}
+
+ESPFormClass::UpdateStats ESPFormClass::getUpdateStats()
+{
+    return _update_stats;
+}
+
+void ESPFormClass::escapeString(MB_String &buf, const char *str, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    buf.reserve(buf.length() + len);
+    for (size_t i = 0; i < len; i++)
+    {
+        char c = str[i];
+        if (c == '"' || c == '\\')
+        {
+            buf += '\\';
+            buf += c;
+        }
+        else if (c == '\n')
+            buf += "\\n";
+        else if (c == '\r')
+            buf += "\\r";
+        else if (c == '\t')
+            buf += "\\t";
+        else if ((uint8_t)c < 0x20)
+        {
+            buf += "\\u00";
+            buf += hex[(uint8_t)c >> 4];
+            buf += hex[c & 0x0f];
+        }
+        else
+            buf += c;
+    }
+}
+
+ESPFormClass::pending_update_t &ESPFormClass::pendingUpdate(const char *id, size_t idLen)
+{
+    // called with the update lock held, the pending list is short as it is flushed every update window
+    uint32_t h = ESPFormElements::hash(id, idLen);
+    for (size_t k = 0; k < _pending.size(); k++)
+    {
+        if (_pending[k].hash == h && _pending[k].idLen == idLen && memcmp(pendingId(_pending[k]), id, idLen) == 0)
+            return _pending[k];
+    }
+
+    pending_update_t update;
+    update.hash = h;
+    update.id = _pending_data.size();
+    update.idLen = idLen;
+    _pending_data.insert(_pending_data.end(), id, id + idLen);
+    _pending_data.push_back(0);
+    _pending.push_back(update);
+    return _pending.back();
+}
+
+void ESPFormClass::queueSet(const char *id, uint8_t type, const char *value, size_t len)
+{
+    lockUpdate();
+
+    size_t idLen = strlen(id);
+    pending_update_t &update = pendingUpdate(id, idLen);
+
+    // the new value replaces the queued one, the old value bytes are released when flushed
+    update.set = true;
+    update.valueType = type;
+    update.value = _pending_data.size();
+    update.valueLen = len;
+    _pending_data.insert(_pending_data.end(), value, value + len);
+    _pending_data.push_back(0);
+
+    // the size of the frame that would be sent without batching
+    if (_binary_mode)
+        queuedUpdate(4 + len);
+    else
+        queuedUpdate(strlen_P(espform_str_20) + idLen + strlen_P(espform_str_21) + len + strlen_P(espform_str_22));
+
+    unlockUpdate();
+}
+
+void ESPFormClass::queueGet(const char *id)
+{
+    lockUpdate();
+
+    size_t idLen = strlen(id);
+    pendingUpdate(id, idLen).get = true;
+
+    if (_binary_mode)
+        queuedUpdate(2);
+    else
+        queuedUpdate(strlen_P(espform_str_19) + idLen + strlen_P(espform_str_22));
+
+    unlockUpdate();
+}
+
+void ESPFormClass::queuedUpdate(size_t size)
+{
+    // called with the update lock held
+    if (_pending_frames == 0)
+        _update_ms = millis();
+
+    _pending_frames++;
+    _pending_bytes += frameSize(size);
+    _update_stats.updates++;
+
+    if (!_update_started && _pending_bytes >= _update_max_size)
+        flushUpdate();
+}
+
+void ESPFormClass::flushUpdate()
+{
+    lockUpdate();
+
+    if (_pending.size() == 0 || !_web_socket_ptr)
+    {
+        unlockUpdate();
+        return;
+    }
+
+    syncShadow();
+
+    bool built = false;
+    size_t clients = 0, frames = 0, bytes = 0;
+    // the coalescing key of the frame, the same set of elements without get has the same key
+    uint32_t key = 0;
+    // the set items included for the previous client, the same frame is reused when unchanged
+    std::vector<uint8_t> items, lastItems;
+
+    for (size_t num = 0; num < _shadow.size(); num++)
+    {
+        if (!_shadow_connected[num])
+            continue;
+
+        clients++;
+        items.assign(_pending.size(), 0);
+        bool any = false;
+
+        for (size_t k = 0; k < _pending.size(); k++)
+        {
+            const pending_update_t &update = _pending[k];
+
+            if (update.get)
+                any = true;
+
+            if (!update.set)
+                continue;
+
+            int index = _elements.find(pendingId(update), update.idLen);
+            if (index < 0 || updateShadow(num, index, &_pending_data[update.value], update.valueLen))
+            {
+                items[k] = 1;
+                any = true;
+            }
+        }
+
+        if (!any)
+            continue;
+
+        if (!built || items != lastItems)
+        {
+            beginFrame();
+            key = 0;
+
+            for (size_t k = 0; k < _pending.size(); k++)
+            {
+                if (items[k])
+                {
+                    espform_value_t value;
+                    value.parse(_pending[k].valueType, &_pending_data[_pending[k].value], _pending[k].valueLen);
+                    frameSet(pendingId(_pending[k]), value);
+                    // the sum does not depend on the update order
+                    key += _pending[k].hash;
+                }
+            }
+
+            for (size_t k = 0; k < _pending.size(); k++)
+            {
+                if (_pending[k].get)
+                {
+                    frameGet(pendingId(_pending[k]));
+                    // the get requests are never coalesced
+                    key = 0;
+                }
+            }
+
+            endFrame();
+
+            lastItems = items;
+            built = true;
+        }
+
+        sendFrame(num, key);
+        frames++;
+        bytes += frameSize(frameLength());
+    }
+
+    _update_stats.frames += frames;
+    if (_pending_frames * clients > frames)
+        _update_stats.framesSaved += _pending_frames * clients - frames;
+    if (_pending_bytes * clients > bytes)
+        _update_stats.bytesSaved += _pending_bytes * clients - bytes;
+
+    _pending.clear();
+    _pending_data.clear();
+    _pending_frames = 0;
+    _pending_bytes = 0;
+
+    unlockUpdate();
+}
+
+void ESPFormClass::beginFrame()
+{
+    _frame_section = 0;
+    _frame_items = 0;
+    if (_binary_mode)
+        _frame_bin.clear();
+    else
+        _frame_text = espform_str_90;
+}
+
+void ESPFormClass::frameSet(const char *id, const espform_value_t &value)
+{
+    _frame_items++;
+
+    if (_binary_mode)
+    {
+        _frame_bin.set(_elements.find(id), id, value);
+        return;
+    }
+
+    char buf[ESPFORM_VALUE_TEXT_SIZE];
+    size_t len = 0;
+    const char *text = value.text(buf, len);
+
+    _frame_text += _frame_section == 1 ? "," : espform_str_91;
+    _frame_text += "[\"";
+    escapeString(_frame_text, id, strlen(id));
+    _frame_text += "\",\"";
+    escapeString(_frame_text, text, len);
+    _frame_text += "\"]";
+    _frame_section = 1;
+}
+
+void ESPFormClass::frameGet(const char *id)
+{
+    _frame_items++;
+
+    if (_binary_mode)
+    {
+        _frame_bin.get(_elements.find(id), id);
+        return;
+    }
+
+    if (_frame_section == 1)
+        _frame_text += ']';
+    _frame_text += _frame_section == 2 ? "," : espform_str_92;
+    _frame_text += '"';
+    escapeString(_frame_text, id, strlen(id));
+    _frame_text += '"';
+    _frame_section = 2;
+}
+
+void ESPFormClass::endFrame()
+{
+    if (_binary_mode)
+        return;
+    if (_frame_section > 0)
+        _frame_text += ']';
+    _frame_text += '}';
+}
+
+size_t ESPFormClass::frameLength()
+{
+    return _binary_mode ? _frame_bin.buf.size() : _frame_text.length();
+}
+
+void ESPFormClass::sendFrame(int num, uint32_t key)
+{
+    if (!_web_socket_ptr)
+        return;
+
+    // the key belongs to this message only
+    _web_socket_ptr->lock();
+    _web_socket_ptr->setMessageKey(key);
+
+    if (_binary_mode)
+    {
+        if (num < 0)
+            _web_socket_ptr->broadcastBIN(_frame_bin.buf.data(), _frame_bin.buf.size());
+        else
+            _web_socket_ptr->sendBIN(num, _frame_bin.buf.data(), _frame_bin.buf.size());
+    }
+    else
+    {
+        if (num < 0)
+            _web_socket_ptr->broadcastTXT(_frame_text.c_str(), _frame_text.length());
+        else
+            _web_socket_ptr->sendTXT(num, _frame_text.c_str(), _frame_text.length());
+    }
+    _web_socket_ptr->unlock();
+}
+
+void ESPFormClass::sendSnapshot(uint8_t num)
+{
+    lockUpdate();
+
+    syncShadow();
+
+    if (_shadow.size() <= num)
+    {
+        _shadow.resize(num + 1);
+        _shadow_connected.resize(num + 1, 0);
+        _shadow_dropped.resize(num + 1, 0);
+    }
+
+    _shadow_connected[num] = 1;
+
+    WSqueueStats_t stats;
+    _shadow_dropped[num] = _web_socket_ptr->getSendQueueStats(num, &stats) ? stats.dropped : 0;
+    _shadow[num].assign(_elements.size(), 0);
+
+    beginFrame();
+
+    // the element handles of the binary messages
+    if (_binary_mode)
+        _frame_bin.handles(_elements);
+
+    for (size_t k = 0; k < _elements.size(); k++)
+    {
+        if (!_elements.hasValue(k))
+            continue;
+        updateShadow(num, k, _elements.value(k), _elements.valueLength(k));
+
+        espform_value_t value;
+        value.parse(espform_value_type_string, _elements.value(k), _elements.valueLength(k));
+        frameSet(_elements.id(k), value);
+    }
+
+    endFrame();
+
+    if (_binary_mode || _frame_items > 0)
+        sendFrame(num);
+
+    unlockUpdate();
+}
+
+void ESPFormClass::syncShadow()
+{
+    // the element handles were changed, all values are unknown
+    if (_shadow_layout != _elements.layout())
+    {
+        for (size_t num = 0; num < _shadow.size(); num++)
+            _shadow[num].clear();
+        _shadow_layout = _elements.layout();
+
+        // the clients need the new handles before any binary message that uses them
+        if (_binary_mode && _web_socket_ptr)
+        {
+            ESPFormBinaryWriter writer;
+            writer.handles(_elements);
+            _web_socket_ptr->broadcastBIN(writer.buf.data(), writer.buf.size());
+        }
+    }
+
+    for (size_t num = 0; num < _shadow.size(); num++)
+    {
+        if (_shadow[num].size() < _elements.size())
+            _shadow[num].resize(_elements.size(), 0);
+    }
+}
+
+bool ESPFormClass::updateShadow(uint8_t num, int index, const char *value, size_t len)
+{
+    // the value is skipped only when its bytes are the element value that the client already has,
+    // the value other than the element value (changed after it was queued) is sent and the client value is unknown
+    uint32_t version = _elements.valueEquals(index, value, len) ? _elements.version(index) : 0;
+
+    if (version > 0 && _shadow[num][index] == version)
+        return false;
+
+    _shadow[num][index] = version;
+    return true;
+}
+
+size_t ESPFormClass::frameSize(size_t len)
+{
+    return len + (len > 125 ? 4 : 2);
+}
+
+void ESPFormClass::runUpdateWindow()
+{
+    lockUpdate();
+    if (_update_interval > 0 && !_update_started && _pending_frames > 0 && millis() - _update_ms >= _update_interval)
+        flushUpdate();
+    unlockUpdate();
+}
+
+void ESPFormClass::checkSendQueue()
+{
+    if (!_web_socket_ptr)
+        return;
+
+    lockUpdate();
+
+    // the client that lost messages to the send queue overflow gets all values again once its queue was sent
+    for (size_t num = 0; num < _shadow_connected.size(); num++)
+    {
+        WSqueueStats_t stats;
+        if (_shadow_connected[num] && _web_socket_ptr->getSendQueueStats(num, &stats) && stats.frames == 0 && stats.dropped != _shadow_dropped[num])
+            sendSnapshot(num);
+    }
+
+    unlockUpdate();
+}
+
+void ESPFormClass::lockUpdate()
+{
+#if defined(ESP32)
+    // the element registry, pending updates and client shadows are shared with the server task,
+    // the mutex is recursive as sending to client may trigger the disconnected event,
+    // it is always taken before the WebSocket server lock, the send and disconnect calls are made with it held
+    xSemaphoreTakeRecursive(_update_mutex, portMAX_DELAY);
+#endif
+}
+
+void ESPFormClass::unlockUpdate()
+{
+#if defined(ESP32)
+    xSemaphoreGiveRecursive(_update_mutex);
+#endif
+}
+
+void ESPFormClass::runScript(const String &script)
+{
+    if (_debug)
+    {
+        Serial.println(pgm2Str(espform_str_75));
+        Serial.println(script.c_str());
+    }
+    lockUpdate();
+    _web_socket_ptr->broadcastTXT(script.c_str(), script.length());
+    unlockUpdate();
+}
+
+void ESPFormClass::stopServer()
+{
+    if (_web_socket_ptr)
+    {
+        lockUpdate();
+        _web_socket_ptr->disconnect();
+        _web_socket_ptr->close();
+        unlockUpdate();
+    }
+    if (_web_server_ptr)
+        _web_server_ptr->close();
+
+    _ap_started = false;
+    _idle_to._serverStarted = false;
+    _idle_to._serverRun = false;
+    _idle_to._idleTime = 0;
+    _idle_to._clientCount = 0;
+    _idle_to._idleStarted = false;
+}
+
+void ESPFormClass::startServer()
+{
+    stopServer();
+
+    if (!_ap_started && _ap_ssid.length() > 0 && _ap_ssid.length() < 32 && _ap_psw.length() >= 8 && _ap_psw.length() < 64)
+    {
+        startAP();
+        startDNSServer();
+        _ap_started = true;
+    }
+    if (!_idle_to._serverStarted)
+    {
+        startWebSocket();
+        startWebServer();
+        if (!_task_created)
+        {
+            _idle_to._serverRun = true;
+            serverRun();
+        }
+
+        _idle_to._serverStarted = true;
+    }
+}
+
+void ESPFormClass::startAP()
+{
+    stopAP();
+
+    if (_ipConfig)
+    {
+        if (!WiFi.softAPConfig(_ip, _gateway, _subnet) && _debug)
+        {
+            Serial.println(pgm2Str(espform_str_76));
+            return;
+        }
+    }
+
+    WiFi.enableAP(true);
+
+    if (WiFi.softAP(_ap_ssid.c_str(), _ap_psw.c_str(), _channel, _ssid_hidden, _max_connection))
+    {
+        IPAddress address = WiFi.softAPIP();
+        if (_debug)
+            Serial.printf(pgm2Str(espform_str_77), _ap_ssid.c_str(), _ap_psw.c_str(), address.toString().c_str());
+    }
+    else
+    {
+        if (_debug)
+            Serial.println(pgm2Str(espform_str_78));
+    }
+}
+
+void ESPFormClass::stopAP()
+{
+    WiFi.softAPdisconnect(true);
+}
+
+void ESPFormClass::startDNSServer()
+{
+#ifdef ESP32
+    MB_String s = espform_str_4;
+    MDNS.begin(s.c_str());
+#elif defined(ESP8266)
+    _dns_server_ptr.reset(new DNSServer());
+    _dns_server_ptr->setErrorReplyCode(DNSReplyCode::NoError);
+    _dns_server_ptr->start(_dns_port, "*", WiFi.softAPIP());
+
+    if (_debug)
+        Serial.println(pgm2Str(espform_str_79));
+#endif
+}
+
+void ESPFormClass::startWebServer()
+{
+    // keep the header keys in RAM, they are copied to String by the server
+    static const char *headerKeys[] = {"If-None-Match", "Range", "If-Range", "Accept-Encoding"};
+    _web_server_ptr->collectHeaders(headerKeys, 4);
+    _web_server_ptr->on("/", std::bind(&ESPFormClass::handleFileRead, this));
+    _web_server_ptr->onNotFound(std::bind(&ESPFormClass::handleNotFound, this));
+    _web_server_ptr->begin();
+    if (_debug)
+        Serial.println(pgm2Str(espform_str_80));
+}
+
+void ESPFormClass::startWebSocket()
+{
+    if (_web_socket_ptr)
+    {
+        _web_socket_ptr->setClientMax(_web_socket_client_max);
+        // the large frames are delivered as fragments and collected or streamed by handleMessageFragment
+        _web_socket_ptr->setStreamChunkSize(ESPFORM_STREAM_CHUNK_SIZE);
+        _web_socket_ptr->setSendQueue(_send_queue_size, _send_queue_policy);
+#if defined(WEBSOCKETS_USE_DEFLATE)
+        _web_socket_ptr->setDeflate(true);
+#endif
+        _web_socket_ptr->begin();
+        _web_socket_ptr->onEvent(std::bind(&ESPFormClass::webSocketEvent, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
+        if (_debug)
+            Serial.println(pgm2Str(espform_str_81));
+    }
+}
+
+void ESPFormClass::handleNotFound()
+{
+    if (!isIP(_web_server_ptr->hostHeader()))
+        goLandingPage();
+    else if (!handleFileRead())
+        _web_server_ptr->send(404, pgm2Str(espform_str_7), pgm2Str(espform_str_38));
+}
+
+uint8_t ESPFormClass::mimeIndex(const char *fileName)
+{
+    const char *ext = strrchr(fileName, '.');
+    if (!ext || strchr(ext, '/'))
+        return none;
+
+    for (uint8_t i = 0; i < none; i++)
+    {
+        if (strcasecmp_P(ext, ESPForm_MIMEInfo[i].endsWith) == 0)
+            return i;
+    }
+    return none;
+}
+
+void ESPFormClass::addFileInfo(file_content_info_t &f, const char *fileName)
+{
+    // the route is the request path
+    if (fileName[0] != '/')
+        f.name = espform_str_13;
+    f.name += fileName;
+    f.mime = mimeIndex(f.name.c_str());
+    f.route = ESPFormElements::hash(f.name.c_str(), f.name.length());
+
+    int first = findFile(f.name.c_str(), f.name.length());
+    int index = _file_info.size();
+    _file_info.push_back(f);
+
+    // the data of other encoding is linked to the variants of the first added file
+    if (first > -1 && f.content && _file_info[first].content)
+    {
+        int k = first;
+        while (_file_info[k].encoding != f.encoding && _file_info[k].alt > -1)
+            k = _file_info[k].alt;
+        if (_file_info[k].encoding != f.encoding)
+            _file_info[k].alt = index;
+    }
+
+    if ((_file_info.size() << 1) > _file_slots.size())
+        rehashFiles();
+    else if (findFile(f.name.c_str(), f.name.length()) < 0)
+    {
+        size_t mask = _file_slots.size() - 1;
+        size_t i = f.route & mask;
+        while (_file_slots[i] > -1)
+            i = (i + 1) & mask;
+        _file_slots[i] = index;
+    }
+}
+
+int ESPFormClass::findFile(const char *path, size_t len)
+{
+    if (_file_slots.size() == 0)
+        return -1;
+
+    uint32_t h = ESPFormElements::hash(path, len);
+    size_t mask = _file_slots.size() - 1;
+    size_t i = h & mask;
+    while (_file_slots[i] > -1)
+    {
+        const file_content_info_t &f = _file_info[_file_slots[i]];
+        if (f.route == h && f.name.length() == len && memcmp(f.name.c_str(), path, len) == 0)
+            return _file_slots[i];
+        i = (i + 1) & mask;
+    }
+    return -1;
+}
+
+void ESPFormClass::rehashFiles()
+{
+    size_t n = ESPFORM_ELEMENTS_MIN_SLOTS;
+    while (n < (_file_info.size() << 1))
+        n <<= 1;
+
+    _file_slots.assign(n, -1);
+
+    for (size_t k = 0; k < _file_info.size(); k++)
+    {
+        // the first added file of the same name is served
+        if (findFile(_file_info[k].name.c_str(), _file_info[k].name.length()) > -1)
+            continue;
+
+        size_t mask = n - 1;
+        size_t i = _file_info[k].route & mask;
+        while (_file_slots[i] > -1)
+            i = (i + 1) & mask;
+        _file_slots[i] = k;
+    }
+}
 
-    prepareConfig();
+bool ESPFormClass::handleFileRead()
+{
+    String path = _web_server_ptr->uri();
 
     if (path.endsWith(pgm2Str(espform_str_13)))
         path += espform_str_12;
@@ -702,166 +1570,441 @@ bool ESPFormClass::handleFileRead()
 
     delay(0);
 
-    _web_server_ptr->sendHeader(pgm2Str(espform_str_10), pgm2Str(espform_str_11));
+    // the built-in data does not change while running, hashed once for the ETag
+    static uint32_t faviconHash = 0, scriptHash = 0;
+
+    if (strcmp_P(path.c_str(), espform_str_26) == 0)
+    {
+        if (scriptHash == 0)
+            scriptHash = contentHash((const char *)espform_js_gz, sizeof(espform_js_gz));
+        sendContentData((const char *)espform_js_gz, sizeof(espform_js_gz), ESPForm_MIMEInfo[js].mimeType, esp_form_encoding_gzip, scriptHash);
+        return true;
+    }
+
+    if (strcmp_P(path.c_str(), espform_str_27) == 0)
+    {
+        // the script is built from the registry which the other task may change
+        lockUpdate();
+        prepareAppScript();
+        unlockUpdate();
+
+        // the cached script is gzip compressed, the client that does not accept gzip gets the plain script
+        bool gzip = _app_script_gzip && (acceptEncoding() & (1 << esp_form_encoding_gzip)) > 0;
+        char etag[16];
+        sprintf(etag, gzip ? "\"%08x-gz\"" : "\"%08x\"", (unsigned int)_app_script_hash);
+
+        delay(0);
+        _web_server_ptr->sendHeader(pgm2Str(espform_str_10), pgm2Str(espform_str_89));
+        _web_server_ptr->sendHeader(pgm2Str(espform_str_87), etag);
+        if (_app_script_gzip)
+            _web_server_ptr->sendHeader(pgm2Str(espform_str_105), pgm2Str(espform_str_103));
+
+        if (_web_server_ptr->hasHeader(pgm2Str(espform_str_88)) && etagMatch(_web_server_ptr->header(pgm2Str(espform_str_88)).c_str(), etag))
+        {
+            _web_server_ptr->send(304);
+            return true;
+        }
+
+        if (gzip || !_app_script_gzip)
+        {
+            if (gzip)
+                _web_server_ptr->sendHeader(pgm2Str(espform_str_8), pgm2Str(espform_str_9));
+            _web_server_ptr->send_P(200, ESPForm_MIMEInfo[js].mimeType, (const char *)_app_script.data(), _app_script.size());
+        }
+        else
+        {
+            MB_String s;
+            lockUpdate();
+            buildAppScript(s);
+            unlockUpdate();
+            _web_server_ptr->send_P(200, ESPForm_MIMEInfo[js].mimeType, s.c_str(), s.length());
+        }
+        return true;
+    }
+
+    int index = findFile(path.c_str(), path.length());
 
-    if (strcmp(path.c_str(), pgm2Str(espform_str_25)) == 0)
+    if (index < 0)
     {
-        MB_String filename;
-        bool fvc = false;
-        for (size_t i = 0; i < _file_info.size(); i++)
+        espform_bundle_entry_t e, v;
+        const uint8_t *bundle = nullptr;
+        int k = findBundleFile(path.c_str(), path.length(), e, bundle);
+        if (k > -1)
         {
-            if (_file_info[i].name.find_first_of("/") != 0)
-                filename = espform_str_13;
-            filename += _file_info[i].name.c_str();
+            ESPFormBundle b(bundle);
+            uint8_t accepted = acceptEncoding();
+            uint32_t version = e.hash, pathOffset = e.path;
+            bool vary = false;
 
-            if (strcmp(filename.c_str(), pgm2Str(espform_str_25)) == 0)
+            while ((size_t)++k < b.size())
             {
-                fvc = true;
-                break;
+                b.get(k, v);
+                if (v.path != pathOffset)
+                    break;
+                vary = true;
+                if (encodingRank(v.flags & ESPFORM_BUNDLE_ENCODING_MASK, accepted) > encodingRank(e.flags & ESPFORM_BUNDLE_ENCODING_MASK, accepted))
+                    e = v;
             }
+
+            sendFileContent((const char *)bundle + e.data, e.len, e.mime, e.flags & ESPFORM_BUNDLE_ENCODING_MASK, e.hash, version, vary);
+            return true;
         }
 
-        if (!fvc)
+        // the built-in icon unless the file was added
+        if (strcmp_P(path.c_str(), espform_str_25) == 0)
         {
-            delay(0);
-            _web_server_ptr->sendHeader(pgm2Str(espform_str_8), pgm2Str(espform_str_9));
-            _web_server_ptr->send_P(200, ESPForm_MIMEInfo[ico].mimeType, (const char *)favicon_gz, sizeof(favicon_gz));
+            if (faviconHash == 0)
+                faviconHash = contentHash((const char *)favicon_gz, sizeof(favicon_gz));
+            sendContentData((const char *)favicon_gz, sizeof(favicon_gz), ESPForm_MIMEInfo[ico].mimeType, esp_form_encoding_gzip, faviconHash);
             return true;
         }
+        return false;
     }
 
-    if (strcmp(path.c_str(), pgm2Str(espform_str_26)) == 0)
+    const file_content_info_t &f = _file_info[index];
+
+    delay(0);
+
+    if (f.path.length() > 0)
     {
-        delay(0);
-        _web_server_ptr->sendHeader(pgm2Str(espform_str_8), pgm2Str(espform_str_9));
-        _web_server_ptr->send_P(200, ESPForm_MIMEInfo[js].mimeType, (const char *)espform_js_gz, sizeof(espform_js_gz));
-        res = true;
+        // the pool handle, the other requests and the config file have their own
+        int handle = _mbfs.openHandle(f.path.c_str(), (mb_fs_mem_storage_type)f.storageType, mb_fs_open_mode_read);
+        if (handle < 0)
+            return false;
+
+        // the file can be changed at any time
+        _web_server_ptr->sendHeader(pgm2Str(espform_str_10), pgm2Str(espform_str_11));
+
+        String mime = pgm2Str(ESPForm_MIMEInfo[f.mime].mimeType);
+        if (f.storageType == esp_form_storage_flash)
+            _web_server_ptr->streamFile(_mbfs.getFlashFile(handle), mime);
+        else if (f.storageType == esp_form_storage_sd)
+            _web_server_ptr->streamFile(_mbfs.getSDFile(handle), mime);
+
+        _mbfs.closeHandle(handle);
+        return true;
     }
-    else if (strcmp(path.c_str(), pgm2Str(espform_str_27)) == 0)
+
+    if (!f.content)
+        return false;
+
+    int selected = index;
+    if (f.alt > -1)
     {
-        String ap;
-        FirebaseJsonData result;
-        String id;
-        int event = 0;
-        String value;
+        uint8_t accepted = acceptEncoding();
+        for (int k = f.alt; k > -1; k = _file_info[k].alt)
+        {
+            if (encodingRank(_file_info[k].encoding, accepted) > encodingRank(_file_info[selected].encoding, accepted))
+                selected = k;
+        }
+    }
 
-        MB_String s, s1;
+    const file_content_info_t &s = _file_info[selected];
+    sendFileContent(s.content, s.len, f.mime, s.encoding, s.hash, f.hash, f.alt > -1);
+    return true;
+}
 
-        for (size_t k = 0; k < _form_config->size(); k++)
+int ESPFormClass::findBundleFile(const char *path, size_t len, espform_bundle_entry_t &entry, const uint8_t *&bundle)
+{
+    for (size_t i = 0; i < _bundles.size(); i++)
+    {
+        int index = ESPFormBundle(_bundles[i]).find(path, len, entry);
+        if (index > -1)
         {
-            getPath(0, k, s);
-            _form_config->get(result, s);
-            if (result.success)
-                id = result.stringValue;
-            getPath(1, k, s);
-            _form_config->get(result, s);
-            if (result.success)
-                event = result.intValue;
-            getPath(2, k, s);
-            _form_config->get(result, s);
-            if (result.success)
-                value = result.stringValue;
-
-            if (value.length() > 0 && result.typeNum != FirebaseJson::JSON_NULL)
-            {
-                s1 += espform_str_32;
-                s1 += id;
-                s1 += espform_str_33;
-                s1 += value;
-                s1 += espform_str_34;
-            }
+            bundle = _bundles[i];
+            return index;
+        }
+    }
+    return -1;
+}
+
+uint8_t ESPFormClass::acceptEncoding()
+{
+    // the bit mask of the accepted ESPFormEncoding, any encoding is accepted without the header
+    if (!_web_server_ptr->hasHeader(pgm2Str(espform_str_103)))
+        return 0xff;
+
+    String header = _web_server_ptr->header(pgm2Str(espform_str_103));
+    const char *p = header.c_str();
+    uint8_t accepted = 1 << esp_form_encoding_identity;
+
+    while (*p)
+    {
+        while (*p == ' ' || *p == ',')
+            p++;
+
+        const char *token = p;
+        while (*p && *p != ',' && *p != ';' && *p != ' ')
+            p++;
+        size_t len = p - token;
 
-            s1 += espform_str_35;
-            s1 += id;
-            s1 += espform_str_36;
-            s1 += event;
-            s1 += espform_str_37;
+        // the coding with q=0 is not acceptable
+        bool allowed = true;
+        while (*p && *p != ',')
+        {
+            if (*p == 'q' && p[1] == '=')
+                allowed = atof(p + 2) > 0;
+            p++;
         }
 
-        if (s1.length() > 0)
-            ap = s1.c_str();
+        if (!allowed || len == 0)
+            continue;
 
-#ifdef ESP32
-        _web_server_ptr->send(200, ESPForm_MIMEInfo[js].mimeType, ap);
-#elif defined(ESP8266)
-        _web_server_ptr->send(200, ESPForm_MIMEInfo[js].mimeType, ap.c_str(), ap.length());
-#endif
-        res = true;
+        if (len == 1 && token[0] == '*')
+            accepted = 0xff;
+        else if (len == strlen_P(espform_str_9) && strncmp_P(token, espform_str_9, len) == 0)
+            accepted |= 1 << esp_form_encoding_gzip;
+        else if (len == strlen_P(espform_str_104) && strncmp_P(token, espform_str_104, len) == 0)
+            accepted |= 1 << esp_form_encoding_br;
+    }
+
+    return accepted;
+}
+
+int ESPFormClass::encodingRank(uint8_t encoding, uint8_t accepted)
+{
+    // the smaller content is preferred, br, gzip and then identity
+    if ((accepted & (1 << encoding)) == 0)
+        return 0;
+    if (encoding == esp_form_encoding_br)
+        return 3;
+    return encoding == esp_form_encoding_gzip ? 2 : 1;
+}
+
+void ESPFormClass::sendFileContent(PGM_P content, size_t len, uint8_t mime, uint8_t encoding, uint32_t hash, uint32_t version, bool vary)
+{
+    static uint32_t loaderHash = 0;
+
+    if (vary)
+        _web_server_ptr->sendHeader(pgm2Str(espform_str_105), pgm2Str(espform_str_103));
+
+    // the page is loaded by the loader which adds the espf argument
+    if (mime == html && !_web_server_ptr->hasArg("espf"))
+    {
+        if (loaderHash == 0)
+            loaderHash = contentHash((const char *)loader_html_gz, sizeof(loader_html_gz));
+        sendContentData((const char *)loader_html_gz, sizeof(loader_html_gz), ESPForm_MIMEInfo[html].mimeType, esp_form_encoding_gzip, loaderHash);
     }
     else
+        sendContentData(content, len, ESPForm_MIMEInfo[mime].mimeType, encoding, hash, version);
+}
+
+uint32_t ESPFormClass::contentHash(PGM_P content, size_t len)
+{
+    // FNV-1a, the PROGMEM data is read in blocks as it may not be byte addressable
+    uint8_t buf[64];
+    uint32_t h = 2166136261UL;
+
+    for (size_t pos = 0; pos < len; pos += sizeof(buf))
     {
-        MB_String filename;
-        String ext;
-        String mime;
-        for (size_t i = 0; i < _file_info.size(); i++)
+        size_t n = len - pos < sizeof(buf) ? len - pos : sizeof(buf);
+        memcpy_P(buf, content + pos, n);
+        for (size_t i = 0; i < n; i++)
         {
-            if (_file_info[i].name.find_first_of("/") != 0)
-                filename = espform_str_13;
-            filename += _file_info[i].name.c_str();
+            h ^= buf[i];
+            h *= 16777619UL;
+        }
 
-            if (path.endsWith(filename.c_str()))
-            {
-                ext = _file_info[i].name.c_str();
-                ext = ext.substring(ext.lastIndexOf("."), ext.length());
+        if ((pos & 0x3fff) == 0)
+            delay(0);
+    }
 
-                if (_file_info[i].path.length() > 0)
-                {
-                    getMIME(ext, mime);
+    // 0 is not hashed yet
+    return h == 0 ? 1 : h;
+}
 
-                    FirebaseJson js;
-                    FirebaseJsonData d;
+void ESPFormClass::sendContentData(PGM_P content, size_t len, PGM_P mime, uint8_t encoding, uint32_t hash, uint32_t version)
+{
+    char etag[20], buf[40];
+    sprintf(etag, "\"%08x-%x\"", (unsigned int)hash, (unsigned int)len);
+
+    // the versioned URI (getFileURL) always has the same content
+    if (version == 0)
+        version = hash;
+    if (_web_server_ptr->hasArg(pgm2Str(espform_str_102)) && strtoul(_web_server_ptr->arg(pgm2Str(espform_str_102)).c_str(), NULL, 16) == version)
+        _web_server_ptr->sendHeader(pgm2Str(espform_str_10), pgm2Str(espform_str_101));
+    else
+        _web_server_ptr->sendHeader(pgm2Str(espform_str_10), pgm2Str(espform_str_89));
 
-                    if (_mbfs.open(_file_info[i].path.c_str(), (mb_fs_mem_storage_type)_file_info[i].storageType, mb_fs_open_mode_read) > -1)
-                    {
+    _web_server_ptr->sendHeader(pgm2Str(espform_str_87), etag);
+    _web_server_ptr->sendHeader(pgm2Str(espform_str_98), pgm2Str(espform_str_99));
 
-                        if (_file_info[i].storageType == esp_form_storage_flash)
-                            _web_server_ptr->streamFile(_mbfs.getFlashFile(), mime.c_str());
-                        else if (_file_info[i].storageType == esp_form_storage_sd)
-                            _web_server_ptr->streamFile(_mbfs.getSDFile(), mime.c_str());
+    if (_web_server_ptr->hasHeader(pgm2Str(espform_str_88)) && etagMatch(_web_server_ptr->header(pgm2Str(espform_str_88)).c_str(), etag))
+    {
+        _web_server_ptr->send(304);
+        return;
+    }
 
-                        res = true;
+    size_t start = 0, end = len;
+    int code = 200;
 
-                        _mbfs.close((mb_fs_mem_storage_type)_file_info[i].storageType);
-                    }
-                }
-                else if (_file_info[i].content && _file_info[i].path.length() == 0)
-                {
+    // the range of the other version is ignored (If-Range)
+    if (_web_server_ptr->hasHeader(pgm2Str(espform_str_95)) && (!_web_server_ptr->hasHeader(pgm2Str(espform_str_96)) || strcmp(_web_server_ptr->header(pgm2Str(espform_str_96)).c_str(), etag) == 0))
+    {
+        int ret = parseRange(_web_server_ptr->header(pgm2Str(espform_str_95)).c_str(), len, start, end);
+        if (ret == 0)
+        {
+            sprintf(buf, "%s */%u", pgm2Str(espform_str_99), (unsigned int)len);
+            _web_server_ptr->sendHeader(pgm2Str(espform_str_97), buf);
+            _web_server_ptr->send(416);
+            return;
+        }
 
-                    if (strcmp(ext.c_str(), pgm2Str(espform_str_28)) == 0)
-                    {
+        if (ret > 0)
+        {
+            sprintf(buf, "%s %u-%u/%u", pgm2Str(espform_str_99), (unsigned int)start, (unsigned int)(end - 1), (unsigned int)len);
+            _web_server_ptr->sendHeader(pgm2Str(espform_str_97), buf);
+            code = 206;
+        }
+    }
 
-                        delay(0);
-
-                        if (!_web_server_ptr->hasArg("espf"))
-                        {
-                            _web_server_ptr->sendHeader(pgm2Str(espform_str_8), pgm2Str(espform_str_9));
-                            _web_server_ptr->send_P(200, ESPForm_MIMEInfo[html].mimeType, (const char *)loader_html_gz, sizeof(loader_html_gz));
-                        }
-                        else
-                        {
-                            if (_file_info[i].gzip)
-                                _web_server_ptr->sendHeader(pgm2Str(espform_str_8), pgm2Str(espform_str_9));
-                            _web_server_ptr->send_P(200, ESPForm_MIMEInfo[html].mimeType, _file_info[i].content, _file_info[i].len);
-                        }
-
-                        res = true;
-                    }
-                    else
-                    {
-                        delay(0);
-                        getMIME(ext, mime);
-                        if (_file_info[i].gzip)
-                            _web_server_ptr->sendHeader(pgm2Str(espform_str_8), pgm2Str(espform_str_9));
-                        _web_server_ptr->send_P(200, mime.c_str(), _file_info[i].content, _file_info[i].len);
-                        res = true;
-                        break;
-                    }
-                    break;
-                }
-            }
+    if (encoding == esp_form_encoding_gzip)
+        _web_server_ptr->sendHeader(pgm2Str(espform_str_8), pgm2Str(espform_str_9));
+    else if (encoding == esp_form_encoding_br)
+        _web_server_ptr->sendHeader(pgm2Str(espform_str_8), pgm2Str(espform_str_104));
+
+    // the headers only, the content follows in chunks
+    _web_server_ptr->setContentLength(end - start);
+    _web_server_ptr->send_P(code, mime, content, 0);
+
+    for (size_t pos = start; pos < end; pos += ESPFORM_ASSET_CHUNK_SIZE)
+    {
+        if (!_web_server_ptr->client().connected())
+            break;
+        _web_server_ptr->sendContent_P(content + pos, end - pos < ESPFORM_ASSET_CHUNK_SIZE ? end - pos : ESPFORM_ASSET_CHUNK_SIZE);
+        delay(0);
+    }
+}
+
+bool ESPFormClass::etagMatch(const char *header, const char *etag)
+{
+    // If-None-Match is * or the list of entity tags, the tags are compared with the weak comparison (RFC 7232 3.2)
+    if (etag[0] == 'W' && etag[1] == '/')
+        etag += 2;
+    size_t len = strlen(etag);
+    const char *p = header;
+
+    while (*p)
+    {
+        while (*p == ' ' || *p == '\t' || *p == ',')
+            p++;
+
+        if (*p == '*')
+            return true;
+
+        if (p[0] == 'W' && p[1] == '/')
+            p += 2;
+
+        if (*p == '"')
+        {
+            const char *q = strchr(p + 1, '"');
+            if (!q)
+                return false;
+            if ((size_t)(q + 1 - p) == len && strncmp(p, etag, len) == 0)
+                return true;
+            p = q + 1;
         }
+
+        while (*p && *p != ',')
+            p++;
+    }
+
+    return false;
+}
+
+int ESPFormClass::parseRange(const char *range, size_t len, size_t &start, size_t &end)
+{
+    // only the single byte range is served, the others get the whole content (-1)
+    size_t prefix = strlen_P(espform_str_100);
+    if (strncmp_P(range, espform_str_100, prefix) != 0 || strchr(range, ','))
+        return -1;
+
+    const char *p = range + prefix;
+    char *q = nullptr;
+
+    // the suffix range, the last n bytes
+    if (*p == '-')
+    {
+        unsigned long n = strtoul(p + 1, &q, 10);
+        if (q == p + 1)
+            return -1;
+        if (n == 0 || len == 0)
+            return 0;
+        start = n < len ? len - n : 0;
+        end = len;
+        return 1;
+    }
+
+    unsigned long first = strtoul(p, &q, 10);
+    if (q == p || *q != '-')
+        return -1;
+
+    // not satisfiable
+    if (first >= len)
+        return 0;
+
+    start = first;
+    end = len;
+
+    p = q + 1;
+    if (*p)
+    {
+        unsigned long last = strtoul(p, &q, 10);
+        if (q == p || last < first)
+            return -1;
+        if (last + 1 < len)
+            end = last + 1;
+    }
+
+    return 1;
+}
+
+void ESPFormClass::prepareAppScript()
+{
+    if (_app_script_rdy && _app_script_rev == _elements.revision())
+        return;
+
+    MB_String s;
+    buildAppScript(s);
+
+    _app_script_hash = ESPFormElements::hash(s.c_str(), s.length());
+
+    _app_script.clear();
+    _app_script_gzip = false;
+
+#if defined(ESPFORM_USE_APP_SCRIPT_GZIP)
+    if (s.length() > 0)
+    {
+        MB_Deflate deflate;
+        _app_script_gzip = deflate.compress((const uint8_t *)s.c_str(), s.length(), _app_script, mb_deflate_format_gzip);
+        if (!_app_script_gzip)
+            _app_script.clear();
+    }
+#endif
+
+    if (!_app_script_gzip)
+        _app_script.insert(_app_script.end(), s.c_str(), s.c_str() + s.length());
+
+    _app_script.shrink_to_fit();
+    _app_script_rev = _elements.revision();
+    _app_script_rdy = true;
+}
+
+void ESPFormClass::buildAppScript(MB_String &s)
+{
+    // only the element events are in the script, it is unchanged until the elements were added, removed
+    // or their events changed, the values are sent in the snapshot when the client is connected
+    if (_binary_mode)
+        s += espform_str_93;
+
+    for (size_t k = 0; k < _elements.size(); k++)
+    {
+        s += espform_str_35;
+        s += _elements.id(k);
+        s += espform_str_36;
+        s += (int)_elements.event(k);
+        s += espform_str_37;
     }
-    return res;
 }
 
 void ESPFormClass::goLandingPage()
@@ -893,20 +2036,78 @@ void ESPFormClass::webSocketEvent(uint8_t num, WStype_t type, uint8_t *payload,
             Serial.printf(pgm2Str(espform_str_83), num);
         break;
     case WStype_BIN:
+    {
+        ESPFormBinaryReader reader(payload, lenght);
+        uint8_t op = 0;
+
+        while (reader.available())
+        {
+            int handle = -1;
+            const char *id = nullptr;
+            size_t idLen = 0;
+            uint32_t event = 0;
+            espform_value_t value;
+
+            if (!reader.byte(op) || (op != ESPFORM_BIN_OP_EVENT && op != ESPFORM_BIN_OP_GET_REPLY))
+                break;
+
+            if (!reader.ref(handle, id, idLen))
+                break;
+
+            if (op == ESPFORM_BIN_OP_EVENT && !reader.varint(event))
+                break;
+
+            if (!reader.value(value))
+                break;
+
+            if (handle > -1)
+            {
+                if ((size_t)handle >= _elements.size())
+                    continue;
+                id = _elements.id(handle);
+                idLen = strlen(id);
+            }
+            else // the byte after id was already decoded
+                ((char *)id)[idLen] = '\0';
+
+            char buf[ESPFORM_VALUE_TEXT_SIZE];
+            size_t len = 0;
+            const char *text = value.text(buf, len);
+
+            // terminate the string value in place, the byte after it belongs to the next record
+            char *tail = value.type == espform_value_type_string ? (char *)text + len : nullptr;
+            char next = tail ? *tail : 0;
+            if (tail)
+                *tail = '\0';
+
+            handleElementMessage(num, op == ESPFORM_BIN_OP_GET_REPLY, id, idLen, event, text, len);
+
+            if (tail)
+                *tail = next;
+        }
+
+        if (_debug)
+            Serial.printf(pgm2Str(espform_str_86), lenght, num);
+
         break;
+    }
     case WStype_FRAGMENT_TEXT_START:
-        break;
     case WStype_FRAGMENT_BIN_START:
-        break;
     case WStype_FRAGMENT:
-        break;
     case WStype_FRAGMENT_FIN:
+        handleMessageFragment(num, type, payload, lenght);
         break;
     case WStype_PING:
         break;
     case WStype_PONG:
         break;
     case WStype_DISCONNECTED:
+        lockUpdate();
+        if (num < _shadow_connected.size())
+            _shadow_connected[num] = 0;
+        unlockUpdate();
+        if (num < _assembly.size())
+            _assembly[num] = message_assembly_t();
         _idle_to._clientCount--;
         if (_idle_to._clientCount == 0 && _idle_to._idleTimeoutCallback != nullptr && !_idle_to._idleStarted)
         {
@@ -924,49 +2125,162 @@ void ESPFormClass::webSocketEvent(uint8_t num, WStype_t type, uint8_t *payload,
         if (_debug)
             Serial.printf(pgm2Str(espform_str_85), num);
 
+        sendSnapshot(num);
+
         break;
     case WStype_TEXT:
+    {
+        espform_event_message_t msg;
+        // the storage of the fallback parser results
+        MB_String type, id, value;
+
+        if (!ESPFormDecoder::decode((char *)payload, lenght, msg))
+            parseEventMessage((const char *)payload, msg, type, id, value);
 
-        FirebaseJson json;
-        FirebaseJsonData result;
-        json.setJsonData((char *)payload);
-        String type, id, value;
-        uint8_t event = 0;
+        if (msg.type.equals(espform_str_30) || msg.type.equals(espform_str_31))
+            handleElementMessage(num, msg.type.equals(espform_str_31), msg.id.c_str(), msg.id.len, msg.event, msg.value.c_str(), msg.value.len);
 
-        json.get(result, pgm2Str(espform_str_30));
-        if (result.success)
-            event = result.intValue;
+        if (_debug)
+            Serial.printf(pgm2Str(espform_str_86), lenght, num);
+
+        break;
+    }
+    }
+}
 
-        json.get(result, pgm2Str(espform_str_29));
-        if (result.success)
-            type = result.stringValue;
+void ESPFormClass::handleMessageFragment(uint8_t num, WStype_t type, uint8_t *payload, size_t len)
+{
+    if (_assembly.size() <= num)
+        _assembly.resize(num + 1);
 
-        json.get(result, pgm2Str(espform_str_16));
-        if (result.success)
-            id = result.stringValue;
+    message_assembly_t &msg = _assembly[num];
+    bool last = type == WStype_FRAGMENT_FIN;
 
-        json.get(result, pgm2Str(espform_str_18));
-        if (result.success)
-            value = result.stringValue;
+    if (type == WStype_FRAGMENT_TEXT_START || type == WStype_FRAGMENT_BIN_START)
+    {
+        msg = message_assembly_t();
+        msg.active = true;
+        msg.binary = type == WStype_FRAGMENT_BIN_START;
+    }
+    else if (!msg.active) // the continuation without start
+        return;
 
-        if (strcmp(type.c_str(), pgm2Str(espform_str_30)) == 0 || strcmp(type.c_str(), pgm2Str(espform_str_31)) == 0)
+    if (!msg.streaming && !msg.dropped && msg.data.size() + len > _max_message_size)
+    {
+        if (_messageStreamCallback)
         {
-            HTMLElementItem element;
-            element.event = (ESPFormEventType)event;
-            element.value = value;
-            element.success = true;
-            element.type = type;
-            element.id = id;
-            setElementEventConfigItem(element);
-            if (_elementEventCallback)
-                _elementEventCallback(element);
+            // the collected data is the first chunk
+            msg.streaming = true;
+            streamChunk(num, msg, msg.data.data(), msg.data.size(), false);
         }
+        else
+        {
+            msg.dropped = true;
+            if (_debug)
+                Serial.printf(pgm2Str(espform_str_94), _max_message_size, num);
+        }
+        std::vector<uint8_t>().swap(msg.data);
+    }
 
-        if (_debug)
-            Serial.printf(pgm2Str(espform_str_86), lenght, num);
+    if (msg.streaming)
+        streamChunk(num, msg, payload, len, last);
+    else if (!msg.dropped)
+        msg.data.insert(msg.data.end(), payload, payload + len);
 
-        break;
+    if (!last)
+        return;
+
+    msg.active = false;
+
+    // the data is moved out since the message handler may disconnect the client
+    std::vector<uint8_t> data;
+    data.swap(msg.data);
+
+    if (!msg.streaming && !msg.dropped)
+    {
+        // the text message is null terminated
+        data.push_back(0);
+        webSocketEvent(num, msg.binary ? WStype_BIN : WStype_TEXT, data.data(), data.size() - 1);
+    }
+}
+
+void ESPFormClass::streamChunk(uint8_t num, message_assembly_t &msg, const uint8_t *data, size_t len, bool last)
+{
+    if (!_messageStreamCallback || (len == 0 && !last))
+        return;
+
+    MessageChunk chunk;
+    chunk.client = num;
+    chunk.binary = msg.binary;
+    chunk.first = msg.offset == 0;
+    chunk.last = last;
+    chunk.offset = msg.offset;
+    chunk.data = data;
+    chunk.length = len;
+
+    msg.offset += len;
+
+    _messageStreamCallback(chunk);
+}
+
+void ESPFormClass::handleElementMessage(uint8_t num, bool get, const char *id, size_t idLen, int event, const char *value, size_t len)
+{
+    int index = _elements.find(id, idLen);
+    if (index > -1)
+    {
+        if (event > 0)
+            _elements.setEvent(index, (uint8_t)event);
+        _elements.setValue(index, value, len);
+
+        // the sender already has this value
+        lockUpdate();
+        syncShadow();
+        if (num < _shadow.size())
+            updateShadow(num, index, value, len);
+        unlockUpdate();
     }
+
+    if (_elementEventCallback)
+    {
+        HTMLElementItem element;
+        element.event = (ESPFormEventType)event;
+        element.value = value;
+        element.success = true;
+        element.type = pgm2Str(get ? espform_str_31 : espform_str_30);
+        element.id = id;
+        _elementEventCallback(element);
+    }
+}
+
+void ESPFormClass::parseEventMessage(const char *payload, espform_event_message_t &msg, MB_String &type, MB_String &id, MB_String &value)
+{
+    FirebaseJson json;
+    FirebaseJsonData result;
+    json.setArenaMode(true);
+    json.setJsonData(payload);
+
+    json.get(result, pgm2Str(espform_str_30));
+    if (result.success)
+        msg.event = result.intValue;
+
+    json.get(result, pgm2Str(espform_str_29));
+    if (result.success)
+        type = result.stringValue;
+
+    json.get(result, pgm2Str(espform_str_16));
+    if (result.success)
+        id = result.stringValue;
+
+    json.get(result, pgm2Str(espform_str_18));
+    if (result.success)
+        value = result.stringValue;
+
+    msg.type.ptr = type.c_str();
+    msg.type.len = type.length();
+    msg.id.ptr = id.c_str();
+    msg.id.len = id.length();
+    msg.value.ptr = value.c_str();
+    msg.value.len = value.length();
 }
 
 void ESPFormClass::serverRun()
@@ -995,8 +2309,13 @@ void ESPFormClass::serverRun()
 
             if (_idleTimeoutInfo[objIndex - 1].get()._serverStarted)
             {
+                // the update lock is taken before the server lock as in the sending calls of the other tasks
+                _this->lockUpdate();
                 _webSocket[objIndex - 1].get().loop();
+                _this->unlockUpdate();
                 _webServer[objIndex - 1].get().handleClient();
+                _this->runUpdateWindow();
+                _this->checkSendQueue();
 
                 if (_idleTimeoutInfo[objIndex - 1].get()._clientCount == 0 && _idleTimeoutInfo[objIndex - 1].get()._idleTimeoutCallback != nullptr && !_idleTimeoutInfo[objIndex - 1].get()._idleStarted)
                 {
@@ -1039,6 +2358,8 @@ void ESPFormClass::serverRun()
     {
         _web_socket_ptr->loop();
         _web_server_ptr->handleClient();
+        runUpdateWindow();
+        checkSendQueue();
 
         if (_idle_to._clientCount == 0 && _idle_to._idleTimeoutCallback != nullptr && !_idle_to._idleStarted)
         {
@@ -1237,8 +2558,7 @@ size_t ESPFormClass::getClientCount()
 
 size_t ESPFormClass::getElementCount()
 {
-    prepareConfig();
-    return _form_config->size();
+    return _elements.size();
 }
 
 bool ESPFormClass::setClock(float offset)
@@ -90,6 +90,14 @@
 
 #include "mbfs/MB_FS.h"
 #include "MIMEInfo.h"
+#include "ESPFormElements.h"
+#include "ESPFormDecoder.h"
+#include "ESPFormBinary.h"
+#include "ESPFormBundle.h"
+#include "json/MB_JSONReader.h"
+#if defined(ESPFORM_USE_APP_SCRIPT_GZIP)
+#include "deflate/MB_Deflate.h"
+#endif
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -98,6 +106,26 @@
 #define ESP_DEFAULT_TS 1618971013
 #endif
 
+// the maximum size of the message collected from fragments
+#ifndef ESPFORM_MAX_MESSAGE_SIZE
+#define ESPFORM_MAX_MESSAGE_SIZE WEBSOCKETS_MAX_DATA_SIZE
+#endif
+
+// the chunk size of the frames larger than WEBSOCKETS_MAX_DATA_SIZE
+#ifndef ESPFORM_STREAM_CHUNK_SIZE
+#define ESPFORM_STREAM_CHUNK_SIZE 1024
+#endif
+
+// the chunk size of the PROGMEM file data sent to the web client
+#ifndef ESPFORM_ASSET_CHUNK_SIZE
+#define ESPFORM_ASSET_CHUNK_SIZE 2048
+#endif
+
+// the bytes queued for each client when its network can not take the messages at once
+#ifndef ESPFORM_SEND_QUEUE_SIZE
+#define ESPFORM_SEND_QUEUE_SIZE WEBSOCKETS_TX_QUEUE_BYTES
+#endif
+
 static const char espform_str_1[] PROGMEM = "\r\n<script src=\"espform.js\"></script>\r\n";
 static const char espform_str_2[] PROGMEM = "task";
 static const char espform_str_3[] PROGMEM = "_ref";
@@ -184,6 +212,28 @@ static const char espform_str_83[] PROGMEM = "DEBUG:  WS IO error with client [%
 static const char espform_str_84[] PROGMEM = "DEBUG:  WS Disconnected from client [%u]!\n";
 static const char espform_str_85[] PROGMEM = "DEBUG:  WS Connected with client [%u]\n";
 static const char espform_str_86[] PROGMEM = "DEBUG:  WS Get text payload [%u] from client [%u]\n";
+static const char espform_str_87[] PROGMEM = "ETag";
+static const char espform_str_88[] PROGMEM = "If-None-Match";
+static const char espform_str_89[] PROGMEM = "no-cache";
+static const char espform_str_90[] PROGMEM = "{\"type\":\"batch\"";
+static const char espform_str_91[] PROGMEM = ",\"set\":[";
+static const char espform_str_92[] PROGMEM = ",\"get\":[";
+static const char espform_str_93[] PROGMEM = "espf.bin=1;\r\n";
+static const char espform_str_94[] PROGMEM = "DEBUG:  WS Message larger than [%u] bytes from client [%u] was dropped\n";
+static const char espform_str_95[] PROGMEM = "Range";
+static const char espform_str_96[] PROGMEM = "If-Range";
+static const char espform_str_97[] PROGMEM = "Content-Range";
+static const char espform_str_98[] PROGMEM = "Accept-Ranges";
+static const char espform_str_99[] PROGMEM = "bytes";
+static const char espform_str_100[] PROGMEM = "bytes=";
+static const char espform_str_101[] PROGMEM = "public, max-age=31536000, immutable";
+static const char espform_str_102[] PROGMEM = "v";
+static const char espform_str_103[] PROGMEM = "Accept-Encoding";
+static const char espform_str_104[] PROGMEM = "br";
+static const char espform_str_105[] PROGMEM = "Vary";
+static const char espform_str_106[] PROGMEM = "{\"esp\":[";
+static const char espform_str_107[] PROGMEM = "]}";
+static const char espform_str_108[] PROGMEM = "DEBUG:  The binary mode can't be changed while the clients are connected";
 
 static const uint8_t favicon_gz[] PROGMEM = {
     0x1F, 0x8B, 0x08, 0x08, 0xFD, 0x2F, 0xAC, 0x5E, 0x04, 0x00, 0x66, 0x61, 0x76, 0x69, 0x63, 0x6F,
@@ -351,123 +401,164 @@ static const uint8_t favicon_gz[] PROGMEM = {
 
 static const uint8_t espform_js_gz[] PROGMEM = {
 
-    0x1F, 0x8B, 0x08, 0x08, 0x85, 0xC5, 0xB6, 0x5E, 0x04, 0x00, 0x65, 0x73, 0x70, 0x66, 0x6F, 0x72,
-    0x6D, 0x2E, 0x6A, 0x73, 0x00, 0x95, 0x18, 0x09, 0xCF, 0xD2, 0x30, 0xF4, 0xAF, 0x48, 0x63, 0x70,
-    0x95, 0x39, 0xF9, 0xBC, 0xDD, 0x9C, 0x78, 0x61, 0xD4, 0x78, 0x45, 0xF1, 0x48, 0x00, 0x4D, 0xD9,
-    0xFA, 0x41, 0x75, 0xAC, 0x64, 0x2D, 0x28, 0x81, 0xFD, 0x77, 0xDF, 0x6B, 0x3B, 0x36, 0x0E, 0xAF,
-    0xE4, 0xCB, 0xC7, 0xDE, 0xEB, 0xBB, 0xCF, 0x6E, 0x49, 0xC6, 0x94, 0xBA, 0xD0, 0x7F, 0xFF, 0xF6,
-    0xA9, 0x2C, 0xE6, 0x9B, 0x44, 0xE6, 0x4A, 0x17, 0xCB, 0x44, 0xCB, 0xC2, 0xA3, 0x1B, 0x3D, 0x13,
-    0x2A, 0xF8, 0xC1, 0x27, 0x4A, 0x26, 0xDF, 0xB9, 0x8E, 0xF3, 0x65, 0x96, 0xF9, 0x16, 0xA7, 0x12,
-    0xF9, 0x3D, 0x6E, 0x9D, 0x59, 0x68, 0x59, 0x64, 0x31, 0xF9, 0xA1, 0xC2, 0xAB, 0x57, 0x49, 0x27,
-    0x93, 0x09, 0xD3, 0x42, 0xE6, 0xC1, 0x4C, 0x2A, 0x9D, 0xB3, 0x39, 0xEF, 0x90, 0xF0, 0xCE, 0xD9,
-    0x55, 0x52, 0xF1, 0xE9, 0xB9, 0xB4, 0x8F, 0x49, 0xFD, 0x24, 0x27, 0xDF, 0xE2, 0x4D, 0x69, 0x01,
-    0xBE, 0xB2, 0x50, 0x39, 0xE5, 0x1E, 0xF7, 0x35, 0xDD, 0xAC, 0x58, 0x71, 0x41, 0x19, 0xD5, 0x51,
-    0xC1, 0xF5, 0xB2, 0xC8, 0x01, 0x32, 0x94, 0x29, 0x3F, 0xF7, 0x34, 0xED, 0xE9, 0x60, 0xCA, 0x75,
-    0x3F, 0xE3, 0x73, 0x9E, 0xEB, 0x47, 0xEB, 0xE7, 0xA9, 0xC7, 0x69, 0x98, 0xCA, 0x64, 0x89, 0xF0,
-    0xF1, 0x91, 0xBF, 0x63, 0x55, 0xB4, 0xA7, 0x42, 0x4F, 0xC5, 0x27, 0x68, 0xD5, 0xA3, 0xF5, 0x80,
-    0x4D, 0x5F, 0x83, 0xF1, 0xC0, 0x31, 0xEC, 0x8E, 0x9B, 0x4C, 0xBE, 0xA2, 0x65, 0x52, 0x70, 0xA6,
-    0x79, 0x3F, 0x83, 0xD3, 0x8D, 0xB3, 0x69, 0x27, 0xC5, 0x9E, 0x39, 0x41, 0x40, 0x50, 0x22, 0x5B,
-    0x4D, 0xB7, 0x92, 0x22, 0xBD, 0xD0, 0x6D, 0xC5, 0x31, 0x6F, 0xB7, 0xD1, 0xA7, 0x56, 0xCC, 0x4B,
-    0xA1, 0xDE, 0x4C, 0xBE, 0xF1, 0x44, 0xD7, 0x64, 0x44, 0x1A, 0x04, 0x89, 0x63, 0xBD, 0x5E, 0x70,
-    0x79, 0x7E, 0x81, 0x97, 0x33, 0xA6, 0xEA, 0xF3, 0x56, 0xAB, 0xB2, 0x08, 0x70, 0xED, 0xB6, 0xE7,
-    0x60, 0x56, 0x14, 0x6C, 0x0D, 0x98, 0xED, 0xD6, 0x3B, 0x96, 0xB0, 0xDD, 0x76, 0x41, 0x59, 0x90,
-    0xF1, 0x7C, 0xAA, 0x67, 0xC0, 0x43, 0x94, 0x16, 0xF9, 0x94, 0xB4, 0x0E, 0x09, 0x74, 0x21, 0xE6,
-    0x1E, 0x75, 0x74, 0x94, 0xD2, 0xD2, 0x4A, 0xAD, 0x5D, 0x78, 0x88, 0x70, 0x20, 0x94, 0xF9, 0x45,
-    0x0F, 0x93, 0x4C, 0xD9, 0x54, 0x89, 0x73, 0x6F, 0xCF, 0x2E, 0x03, 0xA0, 0xE1, 0x9A, 0xD2, 0x73,
-    0x28, 0x28, 0x9B, 0x4A, 0x1D, 0xA8, 0x45, 0x26, 0xB4, 0x47, 0x2E, 0x10, 0xEA, 0x8B, 0xB8, 0x1B,
-    0x89, 0x7B, 0xCA, 0xA9, 0x8B, 0x44, 0xA7, 0x43, 0x77, 0x5C, 0x6A, 0x28, 0xC6, 0x20, 0x85, 0x07,
-    0xA6, 0x44, 0x5F, 0x0A, 0xA5, 0x03, 0x96, 0xA6, 0x16, 0x5D, 0x16, 0x7C, 0xFE, 0xF8, 0x5F, 0xF5,
-    0xBA, 0xE0, 0xEC, 0x6B, 0x36, 0x48, 0xAB, 0x9E, 0x15, 0x27, 0xF5, 0xB3, 0xE2, 0xD8, 0x00, 0x50,
-    0x2B, 0x57, 0xDC, 0x1D, 0x95, 0x6C, 0xB1, 0xE0, 0x79, 0xFA, 0x78, 0x26, 0xB2, 0xD4, 0x5A, 0xB2,
-    0x67, 0x46, 0x5D, 0xA5, 0x46, 0x48, 0x83, 0x18, 0x30, 0xA5, 0x95, 0xF4, 0x8F, 0xBC, 0xD0, 0x96,
-    0x9A, 0x89, 0x5C, 0x39, 0xD0, 0xF2, 0xEE, 0x44, 0x29, 0xAE, 0x9F, 0x3F, 0xB1, 0x42, 0x7E, 0x17,
-    0x07, 0x48, 0x38, 0x0F, 0x44, 0x1A, 0x5B, 0x6A, 0x2C, 0xED, 0x7F, 0xA0, 0xC7, 0xF6, 0x75, 0x1C,
-    0xCF, 0x06, 0xAF, 0x5E, 0xFE, 0x03, 0x87, 0xC8, 0x73, 0x5E, 0x20, 0xAD, 0x63, 0x1B, 0xF0, 0x9F,
-    0xFA, 0x5F, 0xD9, 0x90, 0xD6, 0xB1, 0x7D, 0x14, 0x4A, 0x4C, 0x32, 0xFE, 0xB7, 0xB8, 0xB4, 0xB4,
-    0xE1, 0x56, 0x7A, 0x9D, 0xF1, 0x20, 0x15, 0x90, 0x5C, 0xB6, 0x8E, 0x49, 0x2E, 0x73, 0x4E, 0x8C,
-    0x98, 0x7E, 0xCE, 0xFE, 0x5D, 0x0A, 0xF0, 0x23, 0x75, 0x1A, 0xB7, 0xBA, 0x86, 0xF9, 0xA1, 0x86,
-    0x4E, 0x98, 0x2C, 0xB5, 0xE1, 0xF7, 0xD5, 0x9F, 0x3C, 0xA8, 0x2B, 0xD6, 0x64, 0x67, 0x8F, 0x19,
-    0x59, 0xCB, 0x29, 0x43, 0x21, 0xBB, 0x0E, 0xFA, 0x9D, 0xA4, 0x1E, 0x0F, 0xA6, 0x7B, 0xBC, 0x34,
-    0x24, 0xA4, 0x84, 0x9A, 0x7F, 0x8F, 0x1E, 0x62, 0x0B, 0x66, 0x5C, 0x5F, 0xD0, 0x7F, 0x19, 0x59,
-    0xC4, 0xC4, 0x83, 0xE0, 0xE0, 0x8A, 0xAE, 0x9C, 0xC1, 0x00, 0xA8, 0xB3, 0x02, 0x4F, 0x29, 0xFF,
-    0xF9, 0xC6, 0x29, 0xDE, 0xAB, 0xC8, 0x83, 0x01, 0x86, 0xC9, 0x78, 0x2D, 0x53, 0x54, 0x4A, 0xCB,
-    0xD9, 0xEA, 0xE4, 0xE8, 0x31, 0x0F, 0x53, 0x24, 0x01, 0x69, 0xE4, 0xF9, 0xEB, 0xB7, 0x1F, 0x06,
-    0x30, 0x6F, 0x6A, 0x6C, 0x90, 0x83, 0x00, 0x34, 0xA9, 0x54, 0xAB, 0x5D, 0xA3, 0x9E, 0xE2, 0xAE,
-    0x86, 0xBC, 0x45, 0xB1, 0xC6, 0x91, 0x4F, 0x70, 0x3A, 0xE1, 0x9C, 0x68, 0xCA, 0x95, 0x0B, 0xDC,
-    0x30, 0x2A, 0x6A, 0xCE, 0x72, 0x92, 0xCC, 0x78, 0xF2, 0x7D, 0x22, 0x7F, 0x82, 0x09, 0x6A, 0xBB,
-    0x25, 0x05, 0x4B, 0x85, 0xC4, 0xE7, 0x5E, 0x83, 0xD1, 0xD0, 0x40, 0x8A, 0x31, 0x2A, 0x40, 0x03,
-    0x8B, 0x8E, 0xA3, 0xC5, 0xA1, 0xCD, 0xC1, 0xCA, 0x0E, 0xD3, 0x06, 0xFD, 0x8A, 0x65, 0x4B, 0xEC,
-    0x80, 0x70, 0xA7, 0x49, 0xD0, 0xDE, 0xF1, 0x79, 0x7D, 0x7C, 0x78, 0x76, 0x92, 0xBA, 0x46, 0x35,
-    0x0B, 0x1F, 0x36, 0x1E, 0x18, 0xF0, 0x97, 0x18, 0xE9, 0x3F, 0xC5, 0x48, 0x9D, 0x8A, 0x11, 0x88,
-    0x6B, 0x64, 0x8C, 0xD2, 0xBA, 0x04, 0xEB, 0x35, 0x38, 0x6C, 0xF0, 0x29, 0x9E, 0xC1, 0xDE, 0xE0,
-    0xE9, 0x73, 0xAC, 0x94, 0xB1, 0xB5, 0xF9, 0xEF, 0x14, 0xE1, 0x9F, 0x28, 0x34, 0xFF, 0xF9, 0x5F,
-    0x21, 0x3A, 0x19, 0x20, 0x74, 0xA4, 0x99, 0x63, 0xDD, 0xC8, 0xB1, 0xAE, 0xBC, 0x3A, 0x4E, 0x35,
-    0xB2, 0xD5, 0xD9, 0xAD, 0xE8, 0x0E, 0x35, 0x96, 0x16, 0x0F, 0xCD, 0x26, 0x13, 0x40, 0x36, 0x42,
-    0x1D, 0xED, 0xF6, 0xD6, 0x05, 0x01, 0x7C, 0xE6, 0xAE, 0x42, 0xD1, 0x14, 0x50, 0x0B, 0x1B, 0x93,
-    0x43, 0x81, 0x59, 0x72, 0x11, 0x43, 0x3B, 0xAE, 0x20, 0x9C, 0xA8, 0x51, 0xB4, 0x62, 0x4B, 0x3A,
-    0x54, 0x10, 0x20, 0x4B, 0xC0, 0x1A, 0x28, 0x11, 0xED, 0x9E, 0xE3, 0x8D, 0x08, 0x99, 0xBF, 0x0A,
-    0x45, 0x19, 0x21, 0xD5, 0x2C, 0xCE, 0xF9, 0x8F, 0x0B, 0xFD, 0x15, 0x74, 0x22, 0xBA, 0xCB, 0xF2,
-    0x29, 0x64, 0x36, 0xC2, 0x4E, 0x07, 0xD1, 0x66, 0xC6, 0x31, 0x9D, 0xCC, 0xEC, 0xF9, 0x8C, 0x96,
-    0x65, 0x99, 0x24, 0xB3, 0xEF, 0x9E, 0xD5, 0xC0, 0xAD, 0xC5, 0x49, 0xC6, 0x59, 0x31, 0x10, 0x73,
-    0x2E, 0x97, 0x30, 0x7B, 0xCD, 0x3D, 0x8B, 0xFA, 0xF6, 0x37, 0x86, 0xD1, 0x54, 0x9D, 0x78, 0x34,
-    0xBE, 0xBF, 0xE1, 0x81, 0x4C, 0xC0, 0x17, 0x3C, 0xB7, 0x82, 0x4A, 0xFF, 0x66, 0x17, 0xF6, 0xDA,
-    0xBF, 0xF7, 0x2B, 0xBA, 0xEB, 0x7A, 0xBF, 0x15, 0x1F, 0x36, 0x3E, 0x8C, 0x85, 0x41, 0xFF, 0xF3,
-    0xE0, 0xE1, 0xBB, 0xFE, 0xC3, 0xD3, 0xA7, 0xEF, 0xFB, 0x2F, 0xFB, 0x8F, 0x7F, 0xC3, 0xF9, 0xE6,
-    0xED, 0xE0, 0xF9, 0x9B, 0xD7, 0xA7, 0xCF, 0x1E, 0x7D, 0x18, 0x0C, 0x7E, 0x77, 0xF6, 0xE6, 0xC3,
-    0xE0, 0xB4, 0x35, 0x2E, 0xFB, 0x91, 0xBB, 0x64, 0x0E, 0xF9, 0x38, 0xD6, 0x3E, 0x8E, 0x82, 0x9E,
-    0x8E, 0x49, 0x92, 0x89, 0xE4, 0x3B, 0x09, 0xAF, 0x39, 0x30, 0x9D, 0x64, 0x0E, 0x73, 0xDD, 0x61,
-    0xE6, 0x72, 0xA9, 0x78, 0x2A, 0x7F, 0xE4, 0x24, 0xBC, 0xD1, 0x40, 0x99, 0x4D, 0x4C, 0xC2, 0x9B,
-    0x0D, 0x14, 0x86, 0x97, 0x84, 0xB7, 0x9A, 0x18, 0xA0, 0x29, 0x48, 0x78, 0xBB, 0x89, 0x5A, 0x2E,
-    0xE0, 0x62, 0xDC, 0x44, 0xFC, 0x98, 0x71, 0x9E, 0x91, 0xF0, 0xAE, 0xC3, 0x39, 0xF0, 0xAC, 0xEB,
-    0xE0, 0xEF, 0x7C, 0x6D, 0xB5, 0x9F, 0x9D, 0xD5, 0x98, 0x45, 0xC1, 0x95, 0x02, 0xD4, 0xB5, 0x1A,
-    0x85, 0x72, 0xCF, 0x8C, 0xD1, 0x1E, 0x20, 0x5C, 0x09, 0xF9, 0xCA, 0xD6, 0x1B, 0x37, 0xF5, 0xD6,
-    0xEA, 0x42, 0xC1, 0xE1, 0xED, 0xB3, 0xA4, 0xE1, 0x59, 0xE5, 0x8C, 0x5A, 0x4E, 0xE6, 0x42, 0x03,
-    0x6F, 0xE5, 0x8A, 0xC8, 0x17, 0x4B, 0x84, 0x2B, 0x47, 0xCE, 0x61, 0x43, 0xA0, 0xAE, 0xCA, 0x0B,
-    0xB8, 0x93, 0x60, 0x67, 0xC3, 0xD2, 0x58, 0x02, 0xB6, 0x72, 0xC5, 0xF6, 0x3E, 0x20, 0xEE, 0xEE,
-    0x10, 0xAC, 0x48, 0x66, 0x10, 0xD9, 0xCA, 0x11, 0x30, 0x99, 0x6B, 0x80, 0xC1, 0x0D, 0xDC, 0xBC,
-    0x46, 0x13, 0x74, 0xA1, 0x48, 0xA1, 0x0C, 0xAB, 0x94, 0xC1, 0xCE, 0x33, 0x35, 0x8E, 0x77, 0x2E,
-    0x0E, 0x13, 0x00, 0xD6, 0x28, 0xD6, 0xAB, 0x6B, 0x4C, 0xA0, 0xC2, 0x6E, 0x8E, 0x6C, 0x61, 0xEE,
-    0x5C, 0xA3, 0xBD, 0xFA, 0x39, 0x10, 0xDB, 0xAD, 0x0A, 0xD4, 0xDC, 0x23, 0x1C, 0xE5, 0x10, 0x1F,
-    0x97, 0x78, 0x9D, 0x78, 0x7A, 0x10, 0x90, 0x33, 0x08, 0x88, 0x86, 0x68, 0xFC, 0x89, 0x25, 0xB2,
-    0x6D, 0x6E, 0xA6, 0xEF, 0xFE, 0xE8, 0x35, 0x3D, 0x5F, 0xED, 0x87, 0x76, 0x7B, 0x37, 0x97, 0x84,
-    0xEB, 0xFC, 0x03, 0x1E, 0xB8, 0x56, 0xED, 0xF1, 0xB0, 0xFA, 0x76, 0x3C, 0xFB, 0xCD, 0x6E, 0xC7,
-    0xF2, 0x05, 0x3A, 0x3F, 0x8F, 0xBB, 0xBE, 0x8C, 0x67, 0xD5, 0x75, 0x35, 0xBF, 0x27, 0xA3, 0x1C,
-    0xAE, 0xAC, 0xB3, 0x61, 0x3E, 0xAE, 0x26, 0xDE, 0x76, 0x6B, 0xA5, 0x1A, 0x9C, 0x48, 0xC1, 0x9E,
-    0x3D, 0xA7, 0x1C, 0xDA, 0x27, 0xE7, 0x2C, 0x53, 0x9C, 0x34, 0x1D, 0x2C, 0x4B, 0xF8, 0x03, 0x52,
-    0xE3, 0xB7, 0x0F, 0xC6, 0xD7, 0x5B, 0x0F, 0x5F, 0x29, 0x44, 0x4C, 0xC0, 0x6A, 0xEB, 0xD0, 0xA5,
-    0x8D, 0xF5, 0x3C, 0x24, 0x97, 0x3A, 0xBC, 0x73, 0x89, 0xF8, 0x44, 0xA4, 0x06, 0xD0, 0x06, 0x30,
-    0x43, 0xD5, 0xC0, 0x0A, 0x61, 0xA7, 0x3B, 0xBC, 0xD4, 0x11, 0x1D, 0x52, 0x92, 0x08, 0x32, 0x5F,
-    0xBF, 0x45, 0xB6, 0xDB, 0xFB, 0x6F, 0x99, 0xB0, 0x3D, 0xF2, 0x14, 0x7C, 0x2D, 0x17, 0x73, 0xB7,
-    0x0E, 0xAF, 0x7E, 0x19, 0x8E, 0xC6, 0x7E, 0xB8, 0x29, 0x47, 0x6A, 0x7C, 0xF9, 0xE2, 0x55, 0xD8,
-    0x27, 0x0A, 0x07, 0x5B, 0xCA, 0x34, 0x83, 0x9B, 0x30, 0x5C, 0xFA, 0x12, 0xEE, 0x5D, 0x1D, 0x8D,
-    0x86, 0x64, 0x34, 0x1A, 0x5D, 0x9D, 0x9C, 0xE7, 0x85, 0x5E, 0x8E, 0xAF, 0x4E, 0x7D, 0xF2, 0x80,
-    0xD0, 0xFA, 0x9C, 0x0C, 0xBF, 0xE0, 0x79, 0x3E, 0x2A, 0xC6, 0x97, 0xC9, 0x16, 0x37, 0xFF, 0xD6,
-    0x44, 0x60, 0x8B, 0x7D, 0xB0, 0xBD, 0xD2, 0x1B, 0xA5, 0x1D, 0xAF, 0x17, 0x8E, 0x82, 0x51, 0x7A,
-    0x99, 0xF6, 0xE0, 0x69, 0xC8, 0xFB, 0xE3, 0x61, 0x67, 0x74, 0x65, 0x8C, 0x27, 0xB4, 0x87, 0xF2,
-    0xC6, 0x4D, 0x79, 0x40, 0xF2, 0x65, 0x1B, 0x6E, 0x7D, 0x8A, 0x5C, 0xEA, 0xF2, 0x68, 0x48, 0x3B,
-    0x48, 0x43, 0xAA, 0xE9, 0x88, 0xD6, 0xC5, 0x2F, 0xDE, 0xBF, 0x79, 0x1D, 0x2C, 0x58, 0xA1, 0xB8,
-    0xB3, 0x97, 0x46, 0x04, 0xF2, 0x0A, 0xA5, 0x61, 0x8C, 0xC7, 0x10, 0xE2, 0xF6, 0x33, 0x09, 0xDA,
-    0x61, 0x7C, 0x7C, 0xC2, 0x14, 0x55, 0x13, 0xD7, 0xC1, 0x6E, 0x57, 0xF9, 0x5D, 0xB8, 0x15, 0xAA,
-    0x7D, 0x21, 0xED, 0x76, 0x3D, 0xA7, 0x4F, 0x73, 0xD1, 0xDE, 0x69, 0xBC, 0x91, 0xE1, 0xD6, 0xEE,
-    0x6F, 0x45, 0xD4, 0x5B, 0x18, 0xAA, 0xE9, 0x0F, 0xA7, 0xB5, 0x30, 0xBC, 0x35, 0x72, 0x88, 0xEE,
-    0x05, 0x0E, 0x50, 0xE5, 0x7B, 0x99, 0xFF, 0x50, 0xA7, 0x3F, 0x2A, 0x44, 0x8D, 0xF5, 0xA5, 0x8B,
-    0xF5, 0xE6, 0xE8, 0x23, 0x82, 0x53, 0x5B, 0xB3, 0x99, 0x35, 0xF9, 0x89, 0x4F, 0xDE, 0x1B, 0xC8,
-    0xAB, 0x3E, 0x43, 0xF8, 0x43, 0xC2, 0x8A, 0x74, 0x29, 0x72, 0x49, 0xC6, 0x60, 0x42, 0x82, 0xCB,
-    0x12, 0xAA, 0xC8, 0x7C, 0xD6, 0x90, 0xF0, 0x92, 0xF0, 0x83, 0x15, 0x39, 0xBE, 0xB2, 0xDA, 0x57,
-    0xEF, 0x7D, 0x91, 0x47, 0x3A, 0x02, 0x99, 0x27, 0x99, 0x54, 0x3C, 0x3E, 0x5F, 0xE6, 0x09, 0x9A,
-    0xE3, 0xC1, 0x4A, 0xE4, 0xF5, 0xB7, 0x8F, 0xBD, 0x45, 0x8B, 0x78, 0xB3, 0x69, 0xF1, 0xE1, 0xF4,
-    0xAA, 0x05, 0xF7, 0xCD, 0x82, 0xE5, 0xD7, 0xE1, 0xFF, 0x91, 0x2A, 0x09, 0x77, 0xF1, 0xD3, 0x9A,
-    0xBA, 0xC7, 0xD4, 0x10, 0xF0, 0x42, 0x16, 0xBF, 0x31, 0xEC, 0x04, 0xF9, 0x1C, 0xD6, 0x04, 0x9B,
-    0x1E, 0x7A, 0x02, 0x1D, 0xA6, 0xC1, 0x94, 0x1F, 0x22, 0x87, 0xCD, 0x02, 0x54, 0x13, 0x0E, 0x73,
-    0x88, 0x2F, 0xF3, 0x4C, 0xB2, 0xF4, 0x80, 0xB4, 0x16, 0x66, 0x42, 0xE2, 0x51, 0x9C, 0x15, 0x26,
-    0x6B, 0x6A, 0x71, 0x1E, 0x39, 0x09, 0xEE, 0x23, 0x52, 0xEC, 0x7E, 0xFD, 0x4C, 0x25, 0xB5, 0x8D,
-    0xF5, 0xBD, 0xEA, 0x37, 0xDF, 0x4A, 0x08, 0x50, 0x8B, 0x85, 0x36, 0xD7, 0x1D, 0x55, 0x24, 0x31,
-    0xF7, 0x77, 0x84, 0x13, 0x99, 0xAE, 0x0F, 0xDE, 0x9F, 0x7D, 0x0F, 0x35, 0x9B, 0x32, 0x70, 0xEA,
-    0xA8, 0x0D, 0xB0, 0x8F, 0x78, 0x77, 0x9B, 0xD9, 0x97, 0x70, 0xF8, 0xA2, 0x38, 0xC9, 0xC0, 0x23,
-    0x52, 0xFA, 0x38, 0x70, 0x5E, 0x1D, 0x04, 0xA8, 0x1E, 0x82, 0x28, 0xAE, 0xDD, 0x36, 0x42, 0x1B,
-    0xB3, 0xB1, 0xDC, 0x89, 0x3E, 0xDE, 0x55, 0xE4, 0xC9, 0x9B, 0x57, 0x8F, 0x61, 0x39, 0x22, 0x0E,
-    0x22, 0xC9, 0x53, 0x58, 0x25, 0x50, 0x00, 0x10, 0x0D, 0x38, 0x43, 0x41, 0x60, 0xEC, 0x57, 0xF0,
-    0x26, 0xF8, 0xA6, 0x08, 0xC4, 0x31, 0xFA, 0x05, 0x38, 0x6F, 0xE3, 0x53, 0x82, 0x13, 0x00, 0x00
+    0x1F, 0x8B, 0x08, 0x08, 0x85, 0xC5, 0xB6, 0x5E, 0x02, 0xFF, 0x65, 0x73, 0x70, 0x66, 0x6F, 0x72,
+    0x6D, 0x2E, 0x6A, 0x73, 0x00, 0x95, 0x18, 0x8B, 0x6E, 0xDB, 0x38, 0xF2, 0x57, 0x62, 0xE2, 0x2E,
+    0x15, 0x63, 0x55, 0xB1, 0xD3, 0xF6, 0xDA, 0x95, 0xAA, 0x7A, 0xFB, 0xF0, 0xE2, 0x7A, 0x68, 0x9B,
+    0xE2, 0xE2, 0xEE, 0x1D, 0x60, 0xBB, 0x07, 0x3D, 0x68, 0x8B, 0x89, 0x2C, 0x19, 0x24, 0xED, 0x24,
+    0x88, 0xF5, 0xEF, 0x37, 0x43, 0x52, 0xB2, 0x62, 0x3B, 0x69, 0x16, 0x48, 0x60, 0x71, 0x38, 0x33,
+    0x9C, 0x17, 0xE7, 0xC1, 0x24, 0x8F, 0xA4, 0x3C, 0x1A, 0x5E, 0x7C, 0xFF, 0xA3, 0x14, 0x8B, 0xBB,
+    0xA4, 0x2C, 0xA4, 0x12, 0xAB, 0x44, 0x95, 0xC2, 0xA1, 0x77, 0x2A, 0xE3, 0xD2, 0xBB, 0x66, 0xB1,
+    0x2C, 0x93, 0x2B, 0xA6, 0xC2, 0x62, 0x95, 0xE7, 0xAE, 0x81, 0xC9, 0xA4, 0xBC, 0x0A, 0x3B, 0x7D,
+    0xB3, 0x5A, 0x89, 0x3C, 0x24, 0xD7, 0xD2, 0x3F, 0x3D, 0x25, 0xDD, 0xBC, 0x4C, 0x22, 0xC5, 0xCB,
+    0xC2, 0xCB, 0x4A, 0xA9, 0x8A, 0x68, 0xC1, 0xBA, 0xC4, 0x7F, 0xD3, 0x3F, 0x25, 0x35, 0x9D, 0x5A,
+    0x94, 0xE6, 0x33, 0xD9, 0x7E, 0x95, 0xF1, 0x65, 0x78, 0x57, 0x99, 0x05, 0x5B, 0xB7, 0x57, 0x19,
+    0x4F, 0xC3, 0xF1, 0xD4, 0x7C, 0xC7, 0xBC, 0x08, 0x7B, 0xD5, 0x9C, 0x39, 0xCC, 0x55, 0xF4, 0x6E,
+    0x1D, 0x89, 0x23, 0xA9, 0x25, 0x0A, 0x04, 0x53, 0x2B, 0x51, 0xC0, 0x4A, 0xA3, 0xA5, 0x6C, 0xE6,
+    0x28, 0x3A, 0x50, 0xDE, 0x9C, 0xA9, 0x61, 0xCE, 0x16, 0xAC, 0x50, 0x1F, 0x6E, 0x3F, 0xA7, 0x0E,
+    0xA3, 0x7E, 0x5A, 0x26, 0x2B, 0x5C, 0xEF, 0x6F, 0xB9, 0x0D, 0xA9, 0xA4, 0x03, 0xE9, 0x3B, 0x32,
+    0x3C, 0x80, 0x2B, 0x3F, 0xDC, 0x8E, 0xA2, 0xF9, 0x37, 0xD0, 0x09, 0x28, 0xC6, 0xBD, 0x69, 0x9B,
+    0xC8, 0x95, 0xB4, 0x4A, 0x04, 0x8B, 0x14, 0x1B, 0xE6, 0xB0, 0x7B, 0x67, 0x65, 0x6A, 0xB8, 0xD4,
+    0x7B, 0x9A, 0x11, 0x20, 0x54, 0x48, 0xB6, 0xC5, 0x5B, 0x97, 0x3C, 0x3D, 0xEA, 0x75, 0xC2, 0x90,
+    0x1D, 0x1F, 0xA3, 0x4E, 0x9D, 0x90, 0x55, 0x5C, 0x9E, 0xC7, 0x97, 0x2C, 0x51, 0x5B, 0x34, 0x52,
+    0x6A, 0x00, 0x09, 0x43, 0x75, 0xBB, 0x64, 0xE5, 0xEC, 0x88, 0x55, 0x59, 0x24, 0xB7, 0xFB, 0x9D,
+    0x4E, 0x23, 0x11, 0xA3, 0xC7, 0xC7, 0x8E, 0x5D, 0x47, 0x42, 0x44, 0xB7, 0x00, 0xD9, 0x6C, 0x9C,
+    0x7D, 0x0E, 0x9B, 0x0D, 0x1C, 0xCB, 0xBC, 0x9C, 0x15, 0x73, 0x95, 0x01, 0x0D, 0x91, 0x8A, 0x17,
+    0x73, 0xD2, 0xD9, 0x45, 0x50, 0x82, 0x2F, 0x1C, 0x6A, 0xF1, 0x28, 0xA5, 0x55, 0xCD, 0xB5, 0x56,
+    0xE1, 0x3D, 0xAE, 0x3D, 0x2E, 0xDF, 0x5B, 0x78, 0x95, 0xE4, 0xD2, 0xB8, 0x8A, 0x83, 0x43, 0xDA,
+    0x72, 0x19, 0xCF, 0x82, 0xE0, 0x8A, 0xD2, 0x19, 0xC4, 0x99, 0x71, 0xA5, 0xF2, 0xE4, 0x32, 0xE7,
+    0xCA, 0x21, 0x47, 0x84, 0xBA, 0x3C, 0xEC, 0x05, 0xFC, 0xAD, 0xB4, 0xC7, 0x05, 0xBC, 0xDB, 0xA5,
+    0x0D, 0x95, 0x1C, 0xF3, 0x29, 0x70, 0x61, 0x5E, 0x82, 0x91, 0xFB, 0x85, 0x4B, 0xE5, 0x45, 0x69,
+    0x6A, 0xC0, 0x95, 0x60, 0x8B, 0x8F, 0x4F, 0x3D, 0xD7, 0x1A, 0xE7, 0xFE, 0xC9, 0x1A, 0x68, 0x8E,
+    0x8F, 0xC4, 0xC1, 0xF3, 0x23, 0xB1, 0x2F, 0x00, 0x1C, 0x5B, 0xAE, 0x99, 0xDD, 0xAA, 0xA2, 0xE5,
+    0x92, 0x15, 0xE9, 0xC7, 0x8C, 0xE7, 0xA9, 0x91, 0x64, 0x5F, 0x0C, 0x13, 0xA5, 0xC8, 0xA4, 0x8D,
+    0xAC, 0xB4, 0x02, 0xC0, 0xE9, 0x89, 0xB4, 0x70, 0x5B, 0x55, 0xC4, 0x0B, 0x69, 0x97, 0x6D, 0x5A,
+    0x60, 0x25, 0x99, 0xFA, 0xFC, 0xE9, 0x21, 0x26, 0xC6, 0x0E, 0xE0, 0x70, 0xE6, 0xC1, 0x1D, 0x33,
+    0xD8, 0x26, 0xB4, 0x7F, 0x89, 0x8F, 0xB7, 0xDA, 0x52, 0xFC, 0x73, 0xF4, 0xF5, 0xCB, 0x53, 0x4E,
+    0x28, 0x0A, 0x26, 0x10, 0xD7, 0x92, 0x8D, 0xD8, 0x8D, 0x7A, 0x2A, 0x19, 0xE2, 0x5A, 0xB2, 0x3F,
+    0xB9, 0xE4, 0x71, 0xCE, 0x7E, 0x65, 0x97, 0x8E, 0xD2, 0xD4, 0x52, 0xDD, 0xE6, 0xCC, 0x4B, 0x39,
+    0x38, 0x37, 0xBA, 0x0D, 0x49, 0x51, 0x16, 0x8C, 0x68, 0x36, 0xC3, 0x22, 0x7A, 0x3A, 0x17, 0xA0,
+    0x47, 0xEC, 0x34, 0xEC, 0xF4, 0x34, 0xF1, 0x7B, 0x05, 0x37, 0x21, 0x5E, 0x29, 0x4D, 0x0F, 0xB7,
+    0xFE, 0x11, 0x0D, 0xB6, 0x11, 0xAB, 0xBD, 0x73, 0x8F, 0x18, 0x49, 0xAB, 0x79, 0x64, 0x84, 0xB0,
+    0x37, 0xE8, 0x21, 0x4E, 0x03, 0x86, 0x49, 0xA8, 0x45, 0x4B, 0x7D, 0x42, 0x2A, 0x88, 0xF9, 0x0B,
+    0xD4, 0x10, 0xAF, 0x60, 0xCE, 0xD4, 0x91, 0xFA, 0x45, 0xCA, 0x22, 0xDA, 0x1E, 0x04, 0x13, 0x57,
+    0xF0, 0xBC, 0x0F, 0x09, 0x60, 0xEB, 0x15, 0xF8, 0x4A, 0xD9, 0xCD, 0xB9, 0x3D, 0xF8, 0x5E, 0x44,
+    0xEE, 0x24, 0x30, 0x74, 0xC6, 0xB7, 0x32, 0xC5, 0x43, 0x69, 0x95, 0xAD, 0x0F, 0xA6, 0x1E, 0xFD,
+    0x31, 0xD7, 0x28, 0xC7, 0xC7, 0xE4, 0xF3, 0xB7, 0xEF, 0x3F, 0x46, 0x98, 0x6F, 0x1A, 0xA8, 0x57,
+    0x00, 0x03, 0x14, 0xA9, 0x92, 0xEB, 0xFD, 0x8B, 0xDA, 0xA2, 0xAE, 0x93, 0xBC, 0x01, 0x45, 0xAD,
+    0x2D, 0x97, 0x60, 0x76, 0xD2, 0x79, 0xA2, 0xC5, 0xB7, 0x5C, 0x62, 0xE1, 0x91, 0x41, 0x3B, 0x97,
+    0x93, 0x24, 0x63, 0xC9, 0x55, 0x5C, 0xDE, 0x80, 0x08, 0x72, 0xB3, 0x21, 0x22, 0x4A, 0x79, 0x89,
+    0xDF, 0x83, 0x16, 0xA1, 0xC6, 0x01, 0x17, 0xA3, 0x55, 0x00, 0x07, 0xEA, 0x1F, 0x43, 0x89, 0x7D,
+    0xE3, 0x83, 0xB5, 0x49, 0xA6, 0x2D, 0xFC, 0x75, 0x94, 0xAF, 0xF0, 0x06, 0xF8, 0xCD, 0x49, 0x9C,
+    0x0E, 0xF6, 0xF7, 0xFD, 0x03, 0x4A, 0x99, 0xBD, 0x87, 0xB1, 0x0D, 0xA8, 0x15, 0xF8, 0x55, 0x35,
+    0xD7, 0x66, 0x7E, 0xD4, 0x46, 0xEA, 0x31, 0x1B, 0xC9, 0x43, 0x36, 0x02, 0x76, 0x2D, 0x8F, 0x51,
+    0xBA, 0x1B, 0x82, 0x58, 0x06, 0xC7, 0x2D, 0x3A, 0xC9, 0x72, 0xA8, 0x1B, 0x2C, 0xFD, 0x8C, 0x91,
+    0x32, 0x35, 0x32, 0xFF, 0x1A, 0xC3, 0x7F, 0x0C, 0x43, 0x81, 0x7E, 0x7F, 0xC5, 0x44, 0x07, 0x0D,
+    0x84, 0x8A, 0xB4, 0x7D, 0xAC, 0x5A, 0x3E, 0x56, 0xF7, 0xB4, 0xBA, 0xE7, 0xEA, 0xA0, 0x36, 0xA7,
+    0xF6, 0xEE, 0x01, 0x3C, 0x7D, 0x62, 0x65, 0xCB, 0x2E, 0xA9, 0xCA, 0x04, 0x7D, 0xB0, 0x35, 0x75,
+    0xD0, 0xD4, 0xAD, 0x23, 0x0E, 0x74, 0xBA, 0x85, 0xA1, 0x28, 0x0A, 0x1C, 0x0B, 0x15, 0x93, 0x41,
+    0x80, 0x19, 0x74, 0x08, 0x50, 0x0F, 0x1C, 0x28, 0x29, 0x9E, 0xC8, 0xA1, 0xAA, 0x6A, 0xD4, 0xB1,
+    0x04, 0x03, 0x19, 0x84, 0xA8, 0x05, 0xE2, 0x41, 0xF3, 0x1D, 0xDE, 0x71, 0x3F, 0x72, 0xD7, 0x3E,
+    0xAF, 0x02, 0xC4, 0xCA, 0xC2, 0x82, 0x5D, 0x1F, 0x0D, 0xD7, 0xD8, 0x3C, 0x80, 0xBA, 0x51, 0x31,
+    0x07, 0xCF, 0x06, 0x78, 0xD3, 0x81, 0xB5, 0xCE, 0x71, 0x91, 0x4A, 0x32, 0xB3, 0x9F, 0xD1, 0xAA,
+    0xAA, 0x92, 0x24, 0xBB, 0x72, 0xCC, 0x09, 0xCC, 0x48, 0x9C, 0xE4, 0x2C, 0x12, 0x23, 0xBE, 0x60,
+    0xE5, 0x0A, 0x72, 0xAF, 0x6E, 0xBF, 0xA8, 0x6B, 0x7E, 0x43, 0x4C, 0xC9, 0x76, 0xC7, 0xA1, 0xE1,
+    0xBB, 0x3B, 0xE6, 0x81, 0xC2, 0x84, 0xE8, 0x7D, 0xCD, 0xA8, 0x72, 0x5F, 0x41, 0xFA, 0x8B, 0x9E,
+    0x7E, 0x5F, 0xB5, 0x5F, 0xCC, 0xDD, 0xEF, 0x84, 0xBB, 0x17, 0x1F, 0xD2, 0xC2, 0x68, 0xF8, 0xDF,
+    0xD1, 0xFB, 0x7F, 0x0F, 0xDF, 0x1F, 0xDE, 0xBD, 0x18, 0x7E, 0x19, 0x7E, 0x7C, 0x80, 0xF2, 0xFC,
+    0xFB, 0xE8, 0xF3, 0xF9, 0xB7, 0xC3, 0x7B, 0x1F, 0x7E, 0x8C, 0x46, 0x0F, 0xED, 0x9D, 0xFF, 0x18,
+    0x1D, 0x96, 0xC6, 0x7A, 0x3F, 0xB0, 0xBD, 0xE7, 0x98, 0x4D, 0x43, 0xE5, 0x62, 0x2A, 0x18, 0xA8,
+    0x90, 0x24, 0x39, 0x4F, 0xAE, 0x88, 0x7F, 0x66, 0x97, 0x69, 0x9C, 0x5B, 0xC8, 0x0B, 0x0B, 0x59,
+    0x94, 0x2B, 0xC9, 0xD2, 0xF2, 0xBA, 0x20, 0xFE, 0xCB, 0x36, 0x08, 0x2B, 0x31, 0xF1, 0x5F, 0xB5,
+    0x41, 0x60, 0x5E, 0xE2, 0xFF, 0xE3, 0x1E, 0x64, 0xCD, 0x04, 0xF1, 0x5F, 0xB7, 0x41, 0xAB, 0x25,
+    0xF4, 0xCB, 0x6D, 0xC0, 0x75, 0xC6, 0x58, 0x4E, 0xFC, 0xDF, 0x2C, 0xCC, 0x2E, 0xFB, 0x3D, 0xBB,
+    0xBE, 0x62, 0xB7, 0xE6, 0xF4, 0x7E, 0x7F, 0x0B, 0x59, 0x0A, 0x26, 0x25, 0x80, 0xCE, 0xB6, 0x20,
+    0xE4, 0xDB, 0xD7, 0x42, 0x3B, 0xA8, 0x96, 0x09, 0x21, 0xD7, 0x34, 0xDF, 0xA8, 0x32, 0xC4, 0x5B,
+    0xA7, 0x07, 0x01, 0x87, 0xDD, 0x67, 0x45, 0xFD, 0x7E, 0xAD, 0x8C, 0x5C, 0xC5, 0x0B, 0x0E, 0x72,
+    0xF7, 0x6B, 0x55, 0x78, 0xB1, 0x44, 0x3D, 0xFA, 0xB5, 0x22, 0x33, 0xA8, 0x10, 0x78, 0x56, 0xAD,
+    0x05, 0xF6, 0x24, 0x70, 0x31, 0xA1, 0x68, 0xAC, 0x00, 0x5A, 0xAB, 0x62, 0xEE, 0x3E, 0x00, 0x7E,
+    0x6B, 0x00, 0x91, 0x48, 0x32, 0xB0, 0x6C, 0xAD, 0x08, 0x88, 0xCC, 0x00, 0xE1, 0x0C, 0xD5, 0xC0,
+    0x74, 0x8B, 0x27, 0xC1, 0x2D, 0xE4, 0x29, 0xA6, 0x30, 0xEB, 0x32, 0xA8, 0x79, 0x3A, 0xC6, 0xB1,
+    0xE7, 0x62, 0x90, 0x01, 0xA0, 0x8C, 0xEA, 0x78, 0x35, 0x17, 0x53, 0x7A, 0x3A, 0x55, 0x06, 0x36,
+    0x83, 0xD5, 0xAA, 0xD1, 0xC1, 0xF6, 0xDB, 0xE3, 0x9B, 0x8D, 0xF4, 0xE4, 0xC2, 0x21, 0x0C, 0xF9,
+    0x10, 0x57, 0x17, 0xF1, 0xC6, 0xF1, 0x74, 0xC7, 0x20, 0x7D, 0x30, 0x88, 0x02, 0x6B, 0x3C, 0x46,
+    0x12, 0x98, 0x6B, 0xAE, 0xB3, 0xEF, 0x4E, 0xEA, 0xC5, 0x4B, 0x50, 0xD7, 0x07, 0x88, 0xC0, 0x3A,
+    0x2F, 0xF1, 0xFA, 0xE6, 0xDF, 0xA7, 0xC1, 0xB6, 0xAA, 0x4D, 0x13, 0x6D, 0xBB, 0xE3, 0xEC, 0x81,
+    0xDA, 0xAE, 0x0B, 0x7B, 0x44, 0x5D, 0x18, 0x8C, 0xDC, 0x32, 0xCC, 0xEA, 0x76, 0xB5, 0x78, 0x5B,
+    0x06, 0x05, 0xB4, 0xAC, 0xD9, 0xB8, 0x98, 0xD6, 0x19, 0x0F, 0xF5, 0x46, 0xAE, 0x1A, 0xC6, 0x53,
+    0x90, 0xE7, 0x9E, 0x52, 0x16, 0xEC, 0x92, 0x59, 0x94, 0x4B, 0x1D, 0x18, 0x8D, 0x82, 0x55, 0x05,
+    0x7F, 0x80, 0xAA, 0xF5, 0x76, 0xF9, 0xF6, 0xFA, 0xC3, 0x40, 0x46, 0x5B, 0xF3, 0x8B, 0xD3, 0xB7,
+    0x55, 0x5E, 0x0F, 0x87, 0xB6, 0x83, 0x91, 0xB1, 0x43, 0x40, 0x64, 0x4C, 0x8B, 0x83, 0x97, 0xFE,
+    0x0B, 0xCB, 0x82, 0x06, 0xAD, 0xCA, 0x09, 0x63, 0x09, 0x0F, 0x21, 0xD9, 0x04, 0xC6, 0x28, 0xCF,
+    0xEE, 0x8C, 0xF5, 0x7C, 0xF2, 0xAC, 0xCB, 0xBA, 0xCF, 0x88, 0x4B, 0x20, 0x04, 0x70, 0xA1, 0xF4,
+    0x42, 0x27, 0x66, 0xBD, 0x96, 0x7A, 0x6D, 0xE4, 0xF7, 0x9F, 0x75, 0x79, 0x97, 0x54, 0x24, 0x38,
+    0x24, 0x43, 0x33, 0xC0, 0x42, 0x05, 0x2A, 0x52, 0xB0, 0x57, 0x35, 0xD7, 0xE9, 0xFC, 0x70, 0xC7,
+    0x62, 0xC4, 0x5E, 0x18, 0xB1, 0xD1, 0xD9, 0x3B, 0x45, 0xC1, 0xC5, 0x3E, 0x30, 0xD9, 0x0E, 0xA1,
+    0xC9, 0x23, 0xB5, 0x37, 0x38, 0x7C, 0xC4, 0xBD, 0x8A, 0x95, 0xB4, 0x2A, 0x56, 0xF2, 0xE4, 0xAE,
+    0xE4, 0xAF, 0x75, 0x15, 0x3B, 0xD8, 0x4D, 0xF5, 0xDC, 0xE9, 0x6B, 0xDA, 0xFD, 0x36, 0xAD, 0xD6,
+    0xDC, 0x81, 0x0A, 0x44, 0xEF, 0x30, 0x08, 0x83, 0xF5, 0xBB, 0xFE, 0xD9, 0xEB, 0x80, 0x46, 0xDE,
+    0x72, 0x25, 0x33, 0x07, 0xBE, 0x8F, 0xD7, 0x9B, 0xFE, 0xD9, 0x1B, 0xEA, 0xAE, 0xC3, 0xAF, 0x91,
+    0xCA, 0xBC, 0x59, 0x5E, 0x62, 0xAC, 0x9E, 0x22, 0x2C, 0xB0, 0x58, 0x6B, 0xE0, 0x01, 0xE3, 0x92,
+    0x6B, 0x4B, 0x61, 0x1C, 0x3A, 0x58, 0xC4, 0x90, 0xFF, 0xB0, 0x48, 0x20, 0xF9, 0x0A, 0xEA, 0x31,
+    0xFD, 0xE1, 0x5C, 0x40, 0x6B, 0x5B, 0xCC, 0xA1, 0x94, 0x59, 0x8B, 0xE9, 0xA3, 0xE3, 0x7A, 0xD8,
+    0x6C, 0x8A, 0xAD, 0x19, 0xCB, 0xE2, 0xF6, 0x54, 0x66, 0x8F, 0x8A, 0xF5, 0xDC, 0x05, 0xC1, 0xD6,
+    0x04, 0xA9, 0x09, 0xA6, 0x31, 0xB8, 0x6B, 0x6A, 0x79, 0xA2, 0x28, 0x8A, 0xBA, 0x2F, 0xF4, 0x90,
+    0xBD, 0x3D, 0x86, 0xBF, 0xEB, 0x0D, 0xB8, 0xDF, 0x03, 0x9F, 0xC5, 0x65, 0x09, 0x35, 0xB2, 0xD8,
+    0x0E, 0xC7, 0x72, 0x60, 0xD9, 0x4B, 0x8C, 0xDD, 0x56, 0xBB, 0x07, 0xDD, 0x91, 0x63, 0xB7, 0x5E,
+    0xD9, 0x91, 0xD1, 0x6A, 0x4A, 0x7D, 0x0B, 0xEF, 0x59, 0xF8, 0x4E, 0xF0, 0xA1, 0x05, 0x7E, 0xF0,
+    0x42, 0xBD, 0x31, 0x63, 0x32, 0xDC, 0xF1, 0x4A, 0xC4, 0x4E, 0xDA, 0x2E, 0x9D, 0x6E, 0x1C, 0xEE,
+    0x60, 0xA5, 0x68, 0x66, 0x84, 0x7D, 0x8A, 0x54, 0xF4, 0x27, 0x67, 0xD7, 0x08, 0x29, 0xE1, 0xCE,
+    0x0B, 0x1E, 0xEA, 0xFC, 0x57, 0x1B, 0x48, 0x00, 0x6C, 0x11, 0xF6, 0xDD, 0x24, 0x48, 0xC2, 0x78,
+    0x5C, 0x76, 0xBB, 0x53, 0x57, 0x74, 0x43, 0xED, 0xAE, 0x84, 0x9E, 0x2C, 0xDC, 0xC5, 0x49, 0x08,
+    0x0E, 0x72, 0xE1, 0xFF, 0x38, 0x09, 0x68, 0xFD, 0x70, 0x22, 0x2A, 0x57, 0xC8, 0xB0, 0x49, 0xA4,
+    0x45, 0x28, 0xB8, 0x03, 0xD2, 0x6F, 0xDD, 0xF5, 0x89, 0x59, 0x77, 0xA5, 0xFA, 0xC3, 0x89, 0x3D,
+    0xA8, 0x0A, 0x66, 0xFE, 0x2F, 0xDD, 0xB2, 0x5B, 0xD0, 0x86, 0x55, 0xD9, 0x0D, 0x0B, 0x57, 0x01,
+    0x3F, 0xB1, 0xE5, 0x97, 0x69, 0x7E, 0x35, 0x46, 0x36, 0xD0, 0xAF, 0x3A, 0xE3, 0xEC, 0x79, 0x7F,
+    0xEA, 0x0B, 0x89, 0xAD, 0x85, 0x58, 0x87, 0xAD, 0x2C, 0x5E, 0xCB, 0x5D, 0x13, 0xE8, 0xB2, 0xE6,
+    0x08, 0xCD, 0x84, 0xFE, 0xFD, 0x6C, 0xF0, 0xDC, 0x11, 0xDD, 0x3E, 0x3D, 0x3D, 0xF3, 0x05, 0xFC,
+    0x9F, 0xD9, 0xCD, 0x65, 0x24, 0x24, 0xFB, 0x23, 0x2F, 0x23, 0xE5, 0xAC, 0x31, 0x45, 0xEA, 0xCF,
+    0x17, 0x67, 0x20, 0x1E, 0x8C, 0x6D, 0x9E, 0x2A, 0xBF, 0x0B, 0x96, 0xC0, 0xF0, 0x58, 0x16, 0xCE,
+    0x6B, 0x0A, 0xA6, 0xEB, 0x86, 0x2F, 0x5D, 0x41, 0x4D, 0x0D, 0xEF, 0xF4, 0x75, 0xE1, 0x86, 0x2C,
+    0xA4, 0x2B, 0x1C, 0x8A, 0x04, 0xE3, 0x15, 0xAD, 0x74, 0xD4, 0x05, 0xE5, 0x36, 0xDC, 0x8C, 0x8F,
+    0x96, 0x56, 0x40, 0xCC, 0xD3, 0x20, 0xDA, 0xD2, 0x40, 0xAF, 0x42, 0x21, 0xC0, 0x66, 0x37, 0xA1,
+    0x58, 0x83, 0xAA, 0xFB, 0x91, 0x74, 0x03, 0x5A, 0xC3, 0xB4, 0x73, 0xE5, 0xDE, 0xE8, 0x62, 0x92,
+    0xE8, 0xAF, 0x8A, 0x41, 0xAA, 0x3D, 0x02, 0x3E, 0x67, 0xC8, 0x07, 0x2E, 0x61, 0xE2, 0x20, 0x17,
+    0x1A, 0x20, 0x1C, 0xB3, 0xEC, 0xAB, 0x0E, 0xC0, 0x63, 0x18, 0xBC, 0xAE, 0x82, 0xAD, 0x63, 0x82,
+    0xFA, 0x55, 0xAC, 0xB9, 0x16, 0x97, 0x70, 0x2D, 0x2E, 0xDF, 0x16, 0xC1, 0x25, 0xDC, 0x07, 0xBD,
+    0x69, 0x22, 0x10, 0x35, 0xC1, 0x56, 0x70, 0xB9, 0xB0, 0xF3, 0x03, 0x0C, 0xB3, 0x10, 0x3F, 0xD0,
+    0xB0, 0x4A, 0x15, 0x15, 0x09, 0x8A, 0xA5, 0xC3, 0xEB, 0xC3, 0x6A, 0x36, 0x03, 0xE7, 0xB6, 0x7B,
+    0x60, 0x08, 0x49, 0x83, 0xAC, 0xCB, 0xD1, 0xE9, 0xCF, 0xF1, 0x64, 0xEA, 0xFA, 0x77, 0xD5, 0x44,
+    0x4E, 0x4F, 0xFE, 0x76, 0x0A, 0x8D, 0xBB, 0x54, 0x76, 0xDF, 0x13, 0x0C, 0xA6, 0xEB, 0x84, 0x39,
+    0xA7, 0x93, 0xC9, 0x98, 0x4C, 0x26, 0x93, 0xD3, 0x78, 0x56, 0x08, 0xB5, 0x9A, 0x9E, 0xCE, 0x5D,
+    0xF2, 0x3B, 0xA1, 0xDB, 0x7D, 0x32, 0xFE, 0x89, 0xFB, 0xC5, 0x44, 0x4C, 0x4F, 0xC8, 0x06, 0x93,
+    0xD9, 0x46, 0x97, 0x9A, 0x0D, 0x36, 0x1C, 0x9B, 0xE7, 0x83, 0x49, 0xDA, 0x75, 0x06, 0xFE, 0xC4,
+    0x9B, 0xA4, 0x27, 0x70, 0xB9, 0x06, 0xFE, 0x98, 0x0D, 0xA7, 0xE3, 0xEE, 0xE4, 0xF9, 0x14, 0x77,
+    0xE8, 0x00, 0xF9, 0x4D, 0xDB, 0xFC, 0x00, 0xE5, 0xE7, 0xC6, 0xDF, 0xB8, 0x14, 0xA9, 0xE4, 0xC9,
+    0x64, 0x4C, 0xBB, 0x88, 0x43, 0xEA, 0x36, 0x14, 0xA5, 0x0B, 0xFF, 0x75, 0x71, 0xFE, 0xCD, 0xD3,
+    0xB1, 0x51, 0xEB, 0x63, 0xA7, 0xA1, 0xC0, 0x16, 0x25, 0xAD, 0x03, 0xFA, 0x68, 0xA0, 0xCD, 0xAF,
+    0x97, 0x50, 0x1C, 0x7D, 0x22, 0xF7, 0xB6, 0x65, 0xB3, 0xED, 0xEA, 0x5F, 0x93, 0x72, 0x7D, 0x12,
+    0x63, 0xE7, 0xDD, 0xC6, 0x85, 0x9C, 0x6A, 0xB2, 0x84, 0x86, 0x00, 0x23, 0xC8, 0xB2, 0xF5, 0xA7,
+    0x07, 0x3E, 0x1B, 0x46, 0x49, 0xE6, 0xB0, 0xF0, 0x9D, 0x66, 0xC9, 0xF0, 0x1D, 0x91, 0x8D, 0xFB,
+    0x53, 0x8A, 0xBD, 0x47, 0x43, 0x35, 0xDF, 0x52, 0xCD, 0x77, 0xA9, 0x74, 0xF1, 0xA2, 0x36, 0x7A,
+    0x18, 0x88, 0x51, 0xEB, 0x56, 0x15, 0xD7, 0xF2, 0xF0, 0xA3, 0x6D, 0xD0, 0x9A, 0x03, 0x94, 0xB8,
+    0xBD, 0xDB, 0x7B, 0xA4, 0xAD, 0xEB, 0x40, 0x8B, 0x0C, 0xEE, 0xFE, 0x7F, 0x58, 0x7C, 0xA1, 0x57,
+    0x4E, 0xFD, 0xCC, 0xEB, 0x8E, 0x49, 0x24, 0xD2, 0x15, 0x2F, 0x4A, 0x32, 0xDD, 0x4B, 0x70, 0xD0,
+    0x0F, 0x44, 0xE2, 0x76, 0x04, 0x26, 0x08, 0x89, 0xCE, 0x0E, 0xB1, 0x8E, 0x2C, 0xB8, 0x4B, 0x09,
+    0xDA, 0x08, 0xA3, 0x10, 0x9F, 0x97, 0xE1, 0x6A, 0x78, 0xD7, 0x91, 0x28, 0xF0, 0x8D, 0xD0, 0xBC,
+    0x75, 0xDE, 0xE7, 0xB3, 0x27, 0x8B, 0x57, 0x16, 0x49, 0x5E, 0x4A, 0x16, 0xCE, 0x56, 0x45, 0x82,
+    0x62, 0xC3, 0xC0, 0x0A, 0x23, 0x4A, 0xF3, 0x06, 0xBD, 0x33, 0xD9, 0xE8, 0x37, 0x66, 0x1C, 0x5D,
+    0xF4, 0xC7, 0x81, 0xD9, 0x46, 0x9B, 0x09, 0x26, 0x1A, 0xF6, 0x82, 0x56, 0xEE, 0xDE, 0x51, 0xE5,
+    0x92, 0x15, 0x87, 0x4F, 0xEA, 0x1D, 0xC0, 0x66, 0x42, 0x94, 0xE2, 0x01, 0xC1, 0x0E, 0xA0, 0x2F,
+    0xA0, 0x2F, 0x8F, 0xE6, 0xBB, 0x9A, 0xC0, 0x0D, 0x55, 0x20, 0xCA, 0x35, 0x2F, 0xA0, 0x95, 0x07,
+    0xAC, 0x98, 0x81, 0xC3, 0xD9, 0xAA, 0x80, 0x24, 0x96, 0xEE, 0xF2, 0x6E, 0x98, 0x69, 0x93, 0x80,
+    0x1E, 0x70, 0xC5, 0xB5, 0x77, 0xE5, 0x72, 0x16, 0x58, 0x0E, 0xF6, 0x31, 0x3F, 0xB4, 0xBF, 0x6E,
+    0x2E, 0x93, 0x96, 0x8C, 0xCD, 0x20, 0xFB, 0xC0, 0xE3, 0x34, 0x01, 0x6C, 0xBE, 0x54, 0x7A, 0xBE,
+    0x94, 0x22, 0x09, 0x99, 0xDB, 0x20, 0xC6, 0x65, 0x7A, 0xBB, 0xF3, 0x60, 0xE9, 0x3A, 0x78, 0xB2,
+    0x19, 0x4F, 0xCD, 0x71, 0xD4, 0x18, 0xD8, 0x45, 0xB8, 0x1D, 0x1F, 0x77, 0x38, 0xEC, 0xBC, 0xCC,
+    0xC5, 0x10, 0x8E, 0x57, 0xA4, 0x72, 0xB1, 0x40, 0x7E, 0xDD, 0x35, 0x50, 0x53, 0xD0, 0x91, 0xDD,
+    0xF1, 0xB1, 0x66, 0xDA, 0x6A, 0x46, 0xAB, 0x2D, 0xEB, 0xBD, 0xE1, 0x80, 0x7C, 0x3A, 0xFF, 0xFA,
+    0x11, 0xA7, 0x11, 0x80, 0x81, 0x25, 0x59, 0x0A, 0xED, 0x1C, 0x04, 0x00, 0x5A, 0x03, 0xFA, 0x5E,
+    0x60, 0x04, 0xC2, 0xFE, 0x0F, 0xB4, 0xF1, 0x2E, 0x25, 0xC4, 0x28, 0x0D, 0xFE, 0x0F, 0x09, 0x48,
+    0x08, 0x9D, 0x0A, 0x19, 0x00, 0x00
 
 };
 
@@ -519,6 +610,13 @@ enum ESPFormStorageType
     esp_form_storage_sd = 2
 };
 
+enum ESPFormEncoding
+{
+    esp_form_encoding_identity = 0,
+    esp_form_encoding_gzip = 1,
+    esp_form_encoding_br = 2
+};
+
 typedef void (*IdleTimeoutCallback)(void);
 
 typedef struct idle_timeout_t
@@ -595,7 +693,33 @@ public:
         uint8_t channel = 1;
     } NetworkInfo;
 
+    typedef struct update_stats_t
+    {
+        // the batch frames sent
+        uint32_t frames = 0;
+        // the setElementContent and getElementContent calls collected
+        uint32_t updates = 0;
+        // the frames and bytes that were not sent because of batching and coalescing
+        uint32_t framesSaved = 0;
+        uint32_t bytesSaved = 0;
+    } UpdateStats;
+
+    typedef struct message_chunk_t
+    {
+        // the client number
+        uint8_t client = 0;
+        bool binary = false;
+        // the first and last chunk of message
+        bool first = false;
+        bool last = false;
+        // the position of chunk in message
+        size_t offset = 0;
+        const uint8_t *data = nullptr;
+        size_t length = 0;
+    } MessageChunk;
+
     typedef void (*ElementEventCallback)(HTMLElementItem);
+    typedef void (*MessageStreamCallback)(MessageChunk);
     typedef void (*WiFiScanResultItemCallback)(NetworkInfo);
 
 #if defined(ESP32)
@@ -635,6 +759,16 @@ public:
      */
     void addFileData(const uint8_t *content, const char *fileName, size_t length, bool gzip);
 
+    /** Add the encoding variant of HTML resource data in the form of byte array from SPIFFS (PROGMEM) for webpage rendering.
+     * @param content The constant uint8_t array data.
+     * @param fileName The name of resource file (constant char array) in the form of URI e.g., /image.png.
+     * @param length The length of data.
+     * @param encoding The content encoding of data e.g., esp_form_encoding_identity, esp_form_encoding_gzip or esp_form_encoding_br.
+     * The data of the same file name with the different encodings are the variants of the file,
+     * the variant is selected by the browser's Accept-Encoding in the order of br, gzip and identity.
+     */
+    void addFileData(const uint8_t *content, const char *fileName, size_t length, ESPFormEncoding encoding);
+
     /** Add the HTML resource file from SPIFFS or SD/microSD for webpage rendering.
      * @param fileName The name of resource file (constant char array) in the form of URI e.g., /image.png.
      * @param filePath The full file path in SPIFFS or SD card.
@@ -642,6 +776,22 @@ public:
      */
     void addFile(const char *fileName, const char *filePath, ESPFormStorageType storagetype);
 
+    /** Add the HTML resource bundle made by tools/espform_bundle.py for webpage rendering.
+     * @param bundle The constant uint8_t array of bundle in PROGMEM.
+     * @return The boolean value indicates the bundle was valid and added.
+     * The bundle files are served from its own path table without copying to heap,
+     * the files that added with addFileData and addFile take precedence.
+     */
+    bool addBundle(const uint8_t *bundle);
+
+    /** Get the versioned URI of the HTML resource data that added with addFileData.
+     * @param fileName The name of resource file (constant char array) in the form of URI e.g., /image.png.
+     * @return The URI with the content hash query e.g., /image.png?v=1a2b3c4d, or the file name when no resource data was found.
+     * The resource data requested with its versioned URI is cached by browser as immutable,
+     * the unversioned URI is revalidated with its ETag.
+     */
+    String getFileURL(const char *fileName);
+
     /** Run the javascript in the client's browser.
      * @param script The string that represents the variables, objcts, array and functions in javascript.
      */
@@ -699,6 +849,9 @@ public:
     /** Load the HTML Form Element's event items and their value from file
      * @param fileName The file name to read.
      * @param storagetype The type of storage of file e.g., esp_form_storage_flash or esp_form_storage_sd.
+     *
+     * @note The loaded items replace the current items only when the whole file was read, the current items are kept
+     * when the file is missing or broken.
      */
     void loadElementEventConfig(const String &fileName, ESPFormStorageType storagetype);
 
@@ -737,9 +890,93 @@ public:
      * @param id The id of the HTML Form Element.
      * @param id The content or value to set.
      * Required save to file to save changes.
+     *
+     * The value of element that added with addElementEventListener is only sent to the clients that do not have it yet.
      */
     void setElementContent(const char *id, const String &content);
 
+    /** Set or change a HTML Form Element value with the typed value.
+     * @param id The id of the HTML Form Element.
+     * @param content The string, integer, floating point or bool value to set.
+     * The value type is kept in the binary message mode, otherwise the value is sent as text.
+     * The integer outside the 32-bit signed range is sent as string in the binary message mode.
+     */
+    void setElementContent(const char *id, const char *content);
+    void setElementContent(const char *id, int content);
+    void setElementContent(const char *id, unsigned int content);
+    void setElementContent(const char *id, long content);
+    void setElementContent(const char *id, unsigned long content);
+    void setElementContent(const char *id, long long content);
+    void setElementContent(const char *id, unsigned long long content);
+    void setElementContent(const char *id, double content);
+    void setElementContent(const char *id, bool content);
+
+    /** Enable or disable the binary message mode.
+     * @param enable The binary message mode enable option.
+     * In binary mode, the element updates and events are sent as binary messages with the numeric element handles
+     * and typed values instead of JSON text.
+     * @return The boolean value indicates the mode was set, the mode can't be changed while the clients are connected
+     * as their webpages still use the previous mode.
+     */
+    bool setBinaryMode(bool enable);
+
+    /** Set the maximum number of the WebSocket clients (webpage viewers).
+     * @param max The maximum number of clients, the default is WEBSOCKETS_SERVER_CLIENT_MAX (5).
+     * This should be called before startServer, only the connected clients use the memory.
+     */
+    void setMaxClients(uint8_t max);
+
+    /** Set the maximum size of the message that received in fragments or in the frame larger than WEBSOCKETS_MAX_DATA_SIZE.
+     * @param size The maximum message size in bytes, the default is ESPFORM_MAX_MESSAGE_SIZE.
+     * The message is collected in memory up to this size and then handled as the usual message.
+     * The larger message is passed to the message stream callback or dropped when no callback was set.
+     */
+    void setMaxMessageSize(size_t size);
+
+    /** Set the callback function to receive the messages larger than the maximum message size chunk by chunk.
+     * @param streamCallback The MessageStreamCallback callback function that accepted the MessageChunk data, or nullptr to remove.
+     * The MessageChunk data comprises of client, binary, first, last, offset, data and length properties.
+     * The chunk data is only valid in the callback.
+     */
+    void setMessageStreamCallback(MessageStreamCallback streamCallback);
+
+    /** Set the send queue of each client, the messages that the client network can not take at once are queued and sent later
+     * so the slow client does not hold up the others.
+     * @param maxBytes The queued bytes per client, the default is ESPFORM_SEND_QUEUE_SIZE.
+     * @param policy The WSqueuePolicy_t of the message that does not fit, WSqueue_coalesce (default), WSqueue_dropOldest or WSqueue_disconnect.
+     * With WSqueue_coalesce, the queued update of the same elements is replaced by the newer one.
+     * The client that lost messages gets all element values again when its queue was sent.
+     */
+    void setSendQueue(size_t maxBytes, WSqueuePolicy_t policy = WSqueue_coalesce);
+
+    /** Get the send queue statistics of the client.
+     * @param num The client number.
+     * @param stats The WSqueueStats_t data to get, comprises of frames, highWater, bytes, dropped and coalesced properties.
+     * @return The boolean value indicates success of operation.
+     */
+    bool getSendQueueStats(uint8_t num, WSqueueStats_t &stats);
+
+    /** Begin the batch update.
+     * The setElementContent and getElementContent calls after this are collected, only the latest value of each element is kept
+     * and they will be sent as one message to clients when commitUpdate is called.
+     */
+    void beginUpdate();
+
+    /** Send the updates collected since beginUpdate as one message to all clients.
+     */
+    void commitUpdate();
+
+    /** Set the update window to batch the setElementContent and getElementContent calls automatically.
+     * @param interval The maximum time in milliseconds that the updates are collected before sending, set to 0 to disable.
+     * @param maxSize The collected updates size in bytes that causes them to be sent immediately.
+     */
+    void setUpdateWindow(unsigned long interval, size_t maxSize = 1024);
+
+    /** Get the batch update statistics.
+     * @return UpdateStats type data. The UpdateStats data comprises of frames, updates, framesSaved and bytesSaved properties.
+     */
+    UpdateStats getUpdateStats();
+
     /** Clear all HTML Form Element in config or added with addElementEventListener.
      * Required save to file to save changes.
      */
@@ -853,13 +1090,48 @@ public:
 #endif
 
 private:
+    // the message received in fragments from the client
     typedef struct
     {
+        std::vector<uint8_t> data;
+        bool active = false;
+        bool binary = false;
+        // the message was passed to the stream callback or dropped
+        bool streaming = false;
+        bool dropped = false;
+        size_t offset = 0;
+    } message_assembly_t;
+
+    // the queued set or get of an element, the id and value are stored in _pending_data
+    typedef struct
+    {
+        uint32_t hash = 0;
+        // the offsets in _pending_data, the id is null terminated
+        size_t id = 0;
+        size_t idLen = 0;
+        size_t value = 0;
+        size_t valueLen = 0;
+        uint8_t valueType = 0;
+        bool set = false;
+        bool get = false;
+    } pending_update_t;
+
+    typedef struct
+    {
+        // the request path of the file, starts with /
         MB_String name;
         MB_String path;
         const char *content = nullptr;
-        bool gzip = false;
+        uint8_t encoding = esp_form_encoding_identity;
+        // the _file_info index of the next encoding variant of the same name
+        int alt = -1;
         uint32_t len = 0;
+        // the hash of the PROGMEM content for the ETag and versioned URI
+        uint32_t hash = 0;
+        // the hash of name for the route table
+        uint32_t route = 0;
+        // the ESPForm_FileExtension of the MIME type
+        uint8_t mime = none;
         ESPFormStorageType storageType = esp_form_storage_flash;
     } file_content_info_t;
 
@@ -890,8 +1162,48 @@ private:
     const byte _dns_port = 53;
     const byte _web_server_port = 80;
     const byte _web_socket_port = 81;
-    std::shared_ptr<FirebaseJsonArray> _form_config = std::shared_ptr<FirebaseJsonArray>(new FirebaseJsonArray());
+    uint8_t _web_socket_client_max = WEBSOCKETS_SERVER_CLIENT_MAX;
+    ESPFormElements _elements;
+    // the cached espform_app.js script, either plain or gzip
+    std::vector<uint8_t> _app_script;
+    bool _app_script_gzip = false;
+    bool _app_script_rdy = false;
+    uint32_t _app_script_rev = 0;
+    uint32_t _app_script_hash = 0;
+    // the version of the last element value sent to each client, indexed by client number and element handle, 0 is unknown
+    std::vector<std::vector<uint32_t>> _shadow;
+    std::vector<uint8_t> _shadow_connected;
+    // the send queue dropped count of each client when its last snapshot was sent
+    std::vector<uint32_t> _shadow_dropped;
+    uint32_t _shadow_layout = 0;
+    bool _binary_mode = false;
+    // the outgoing frame builder for the JSON text or binary message
+    MB_String _frame_text;
+    ESPFormBinaryWriter _frame_bin;
+    uint8_t _frame_section = 0;
+    size_t _frame_items = 0;
+    // the pending updates in the queued order, the buffer capacity is kept between the flushes
+    std::vector<pending_update_t> _pending;
+    std::vector<char> _pending_data;
+    bool _update_started = false;
+    unsigned long _update_interval = 0;
+    size_t _update_max_size = 1024;
+    unsigned long _update_ms = 0;
+    size_t _pending_frames = 0;
+    size_t _pending_bytes = 0;
+    UpdateStats _update_stats;
+    std::vector<message_assembly_t> _assembly;
+    size_t _max_message_size = ESPFORM_MAX_MESSAGE_SIZE;
+    MessageStreamCallback _messageStreamCallback = nullptr;
+    size_t _send_queue_size = ESPFORM_SEND_QUEUE_SIZE;
+    WSqueuePolicy_t _send_queue_policy = WSqueue_coalesce;
+#if defined(ESP32)
+    SemaphoreHandle_t _update_mutex = NULL;
+#endif
     std::vector<file_content_info_t> _file_info = std::vector<file_content_info_t>();
+    // the open-addressing table of the _file_info index on the request path, -1 for the empty slot
+    std::vector<int> _file_slots;
+    std::vector<const uint8_t *> _bundles;
     ElementEventCallback _elementEventCallback = nullptr;
 #if defined(ESP8266)
     callback_function_t _callback_function = nullptr;
@@ -908,22 +1220,61 @@ private:
     unsigned long _last_recon_millis = 0;
     unsigned long _reccon_tmo = 10000;
 
-    void getPath(uint8_t type, int index, MB_String &buf);
     void startAP();
     void startDNSServer();
     void startWebServer();
     void startWebSocket();
     void handleNotFound();
-    void getMIME(const String &ext, String &mime);
+    static uint8_t mimeIndex(const char *fileName);
     bool handleFileRead();
+    void prepareAppScript();
+    void buildAppScript(MB_String &s);
+    void addFileInfo(file_content_info_t &f, const char *fileName);
+    int findFile(const char *path, size_t len);
+    void rehashFiles();
+    int findBundleFile(const char *path, size_t len, espform_bundle_entry_t &entry, const uint8_t *&bundle);
+    uint8_t acceptEncoding();
+    static int encodingRank(uint8_t encoding, uint8_t accepted);
+    void sendFileContent(PGM_P content, size_t len, uint8_t mime, uint8_t encoding, uint32_t hash, uint32_t version, bool vary);
+    uint32_t contentHash(PGM_P content, size_t len);
+    void sendContentData(PGM_P content, size_t len, PGM_P mime, uint8_t encoding, uint32_t hash, uint32_t version = 0);
+    static bool etagMatch(const char *header, const char *etag);
+    int parseRange(const char *range, size_t len, size_t &start, size_t &end);
+    void escapeString(MB_String &buf, const char *str, size_t len);
+    void updateElementContent(const char *id, const espform_value_t &value);
+    void setIntegerContent(const char *id, bool negative, unsigned long long magnitude);
+    bool batchingUpdate();
+    pending_update_t &pendingUpdate(const char *id, size_t idLen);
+    void queueSet(const char *id, uint8_t type, const char *value, size_t len);
+    void queueGet(const char *id);
+    void queuedUpdate(size_t size);
+    const char *pendingId(const pending_update_t &update) const { return &_pending_data[update.id]; }
+    void flushUpdate();
+    void beginFrame();
+    void frameSet(const char *id, const espform_value_t &value);
+    void frameGet(const char *id);
+    void endFrame();
+    size_t frameLength();
+    void sendFrame(int num, uint32_t key = 0);
+    void sendSnapshot(uint8_t num);
+    void syncShadow();
+    bool updateShadow(uint8_t num, int index, const char *value, size_t len);
+    size_t frameSize(size_t len);
+    void runUpdateWindow();
+    void checkSendQueue();
+    void lockUpdate();
+    void unlockUpdate();
     void goLandingPage();
     bool isIP(String str);
     String toIpString(IPAddress ip);
     void webSocketEvent(uint8_t num, WStype_t type, uint8_t *payload, size_t lenght);
+    void handleElementMessage(uint8_t num, bool get, const char *id, size_t idLen, int event, const char *value, size_t len);
+    void handleMessageFragment(uint8_t num, WStype_t type, uint8_t *payload, size_t len);
+    void streamChunk(uint8_t num, message_assembly_t &msg, const uint8_t *data, size_t len, bool last);
+    void parseEventMessage(const char *payload, espform_event_message_t &msg, MB_String &type, MB_String &id, MB_String &value);
     void serverRun();
     uint8_t getRSSIasQuality(int RSSI);
     bool reconnect();
-    void prepareConfig();
     void int_scanWiFi(WiFiInfo *result, WiFiScanResultItemCallback scanCallback, uint8_t max = 10, bool showHidden = false);
 #if defined(ESP8266)
     void set_scheduled_callback(callback_function_t callback);
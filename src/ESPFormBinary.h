@@ -0,0 +1,302 @@
+/**
+ * The ESPForm binary message codec v1.0.0
+ *
+ * The binary message is the sequence of records, each record starts with the op code byte.
+ *
+ * set (1)       device to client, ref, value
+ * get (2)       device to client, ref
+ * event (3)     client to device, ref, varint event, value
+ * get reply (4) client to device, ref, value
+ * handles (5)   device to client, varint count, string id x count, the element handle is the id position
+ *
+ * ref is varint (handle + 1) or 0 followed by the string id.
+ * value is the type byte, null (0), int (1, zigzag varint), float (2, float32 LE), false (3), true (4) or string (5).
+ * The float value is kept as double on the device and only narrowed to float32 on the wire.
+ * string is varint length followed by UTF-8 bytes.
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2022 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ESPFORM_BINARY_H
+#define ESPFORM_BINARY_H
+
+#include <Arduino.h>
+#include <vector>
+#include "ESPFormElements.h"
+
+#define ESPFORM_BIN_OP_SET 1
+#define ESPFORM_BIN_OP_GET 2
+#define ESPFORM_BIN_OP_EVENT 3
+#define ESPFORM_BIN_OP_GET_REPLY 4
+#define ESPFORM_BIN_OP_HANDLES 5
+
+// the buffer size for the text form of number
+#define ESPFORM_VALUE_TEXT_SIZE 32
+
+typedef enum
+{
+    espform_value_type_null = 0,
+    espform_value_type_int = 1,
+    espform_value_type_float = 2,
+    espform_value_type_false = 3,
+    espform_value_type_true = 4,
+    espform_value_type_string = 5
+} espform_value_type;
+
+typedef struct espform_value_t
+{
+    uint8_t type = espform_value_type_null;
+    int32_t intValue = 0;
+    double floatValue = 0;
+    const char *str = nullptr;
+    size_t len = 0;
+
+    /**
+     * Get the text form of value.
+     * @param buf The buffer of ESPFORM_VALUE_TEXT_SIZE bytes for the text form of number.
+     * @param textLen The length of text.
+     * @return The text.
+     */
+    const char *text(char *buf, size_t &textLen) const
+    {
+        switch (type)
+        {
+        case espform_value_type_int:
+            textLen = snprintf(buf, ESPFORM_VALUE_TEXT_SIZE, "%d", (int)intValue);
+            return buf;
+        case espform_value_type_float:
+            textLen = floatText(buf);
+            return buf;
+        case espform_value_type_false:
+            textLen = 5;
+            return "false";
+        case espform_value_type_true:
+            textLen = 4;
+            return "true";
+        case espform_value_type_string:
+            textLen = len;
+            return str;
+        default:
+            textLen = 0;
+            return "";
+        }
+    }
+
+    // the text that reads back to the same value, the value that fits float32 (e.g. from the wire) uses the float32 digits
+    size_t floatText(char *buf) const
+    {
+        bool single = (double)(float)floatValue == floatValue;
+        int n = 0;
+        for (int prec = single ? 6 : 15; prec <= 17; prec++)
+        {
+            n = snprintf(buf, ESPFORM_VALUE_TEXT_SIZE, "%.*g", prec, floatValue);
+            double d = strtod(buf, nullptr);
+            if (single ? (float)d == (float)floatValue : d == floatValue)
+                break;
+        }
+        return n;
+    }
+
+    // parse the text form of the value type
+    void parse(uint8_t valueType, const char *text, size_t textLen)
+    {
+        type = valueType;
+        str = text;
+        len = textLen;
+        if (type == espform_value_type_int)
+            intValue = atoi(text);
+        else if (type == espform_value_type_float)
+            floatValue = strtod(text, nullptr);
+    }
+} espform_value_t;
+
+class ESPFormBinaryWriter
+{
+public:
+    std::vector<uint8_t> buf;
+
+    void clear() { buf.clear(); }
+
+    void varint(uint32_t v)
+    {
+        while (v > 0x7f)
+        {
+            buf.push_back((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        buf.push_back(v);
+    }
+
+    void string(const char *s, size_t len)
+    {
+        varint(len);
+        buf.insert(buf.end(), (const uint8_t *)s, (const uint8_t *)s + len);
+    }
+
+    // the handle or the string id when handle is negative
+    void ref(int handle, const char *id, size_t len)
+    {
+        if (handle > -1)
+            varint(handle + 1);
+        else
+        {
+            varint(0);
+            string(id, len);
+        }
+    }
+
+    void value(const espform_value_t &v)
+    {
+        buf.push_back(v.type);
+        if (v.type == espform_value_type_int)
+            varint(((uint32_t)v.intValue << 1) ^ (uint32_t)(v.intValue >> 31));
+        else if (v.type == espform_value_type_float)
+        {
+            uint8_t b[4];
+            float f = (float)v.floatValue;
+            memcpy(b, &f, 4);
+            buf.insert(buf.end(), b, b + 4);
+        }
+        else if (v.type == espform_value_type_string)
+            string(v.str, v.len);
+    }
+
+    void set(int handle, const char *id, const espform_value_t &v)
+    {
+        buf.push_back(ESPFORM_BIN_OP_SET);
+        ref(handle, id, strlen(id));
+        value(v);
+    }
+
+    void get(int handle, const char *id)
+    {
+        buf.push_back(ESPFORM_BIN_OP_GET);
+        ref(handle, id, strlen(id));
+    }
+
+    void handles(const ESPFormElements &elements)
+    {
+        buf.push_back(ESPFORM_BIN_OP_HANDLES);
+        varint(elements.size());
+        for (size_t k = 0; k < elements.size(); k++)
+            string(elements.id(k), strlen(elements.id(k)));
+    }
+};
+
+class ESPFormBinaryReader
+{
+public:
+    ESPFormBinaryReader(const uint8_t *data, size_t len)
+    {
+        p = data;
+        end = data + len;
+    }
+
+    bool available() const { return p < end; }
+
+    bool byte(uint8_t &b)
+    {
+        if (p == end)
+            return false;
+        b = *p++;
+        return true;
+    }
+
+    bool varint(uint32_t &v)
+    {
+        v = 0;
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (p == end)
+                return false;
+            uint8_t b = *p++;
+            v |= (uint32_t)(b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool string(const char *&s, size_t &len)
+    {
+        uint32_t n = 0;
+        if (!varint(n) || (size_t)(end - p) < n)
+            return false;
+        s = (const char *)p;
+        len = n;
+        p += n;
+        return true;
+    }
+
+    // handle is -1 when the string id was given
+    bool ref(int &handle, const char *&id, size_t &len)
+    {
+        uint32_t h = 0;
+        if (!varint(h))
+            return false;
+        handle = (int)h - 1;
+        if (handle > -1)
+            return true;
+        return string(id, len);
+    }
+
+    bool value(espform_value_t &v)
+    {
+        uint32_t u = 0;
+
+        v = espform_value_t();
+
+        if (!byte(v.type))
+            return false;
+
+        switch (v.type)
+        {
+        case espform_value_type_null:
+        case espform_value_type_false:
+        case espform_value_type_true:
+            return true;
+        case espform_value_type_int:
+            if (!varint(u))
+                return false;
+            v.intValue = (int32_t)((u >> 1) ^ (~(u & 1) + 1));
+            return true;
+        case espform_value_type_float:
+            if (end - p < 4)
+                return false;
+            float f;
+            memcpy(&f, p, 4);
+            v.floatValue = f;
+            p += 4;
+            return true;
+        case espform_value_type_string:
+            return string(v.str, v.len);
+        default:
+            return false;
+        }
+    }
+
+private:
+    const uint8_t *p = nullptr;
+    const uint8_t *end = nullptr;
+};
+
+#endif
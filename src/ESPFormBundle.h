@@ -0,0 +1,132 @@
+/**
+ * The ESPForm asset bundle reader v1.0.0
+ *
+ * The bundle is the PROGMEM byte array made by tools/espform_bundle.py, all numbers are little endian.
+ *
+ * header (12 bytes)   magic "ESPB", version (1), reserved (1), count (2), slot count (2), reserved (2)
+ * entries             count x 24 bytes, sorted by path, see espform_bundle_entry_t
+ * slots               slot count x uint16 entry index (0xffff is empty), open-addressing table on the path hash
+ * paths               the null terminated request paths e.g. /index.html
+ * data                the file contents, gzip or brotli compressed as the entry encoding flags
+ *
+ * The encoding variants of a file are the consecutive entries that share the path offset,
+ * only the first one is in the slot table.
+ *
+ * The path and content hashes are FNV-1a, the content hash is the ETag as addFileData computes,
+ * the MIME index is the ESPForm_FileExtension value.
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2022 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ESPFORM_BUNDLE_H
+#define ESPFORM_BUNDLE_H
+
+#include <Arduino.h>
+#include "ESPFormElements.h"
+
+#define ESPFORM_BUNDLE_VERSION 1
+#define ESPFORM_BUNDLE_HEADER_SIZE 12
+#define ESPFORM_BUNDLE_EMPTY_SLOT 0xffff
+#define ESPFORM_BUNDLE_FLAG_GZIP 1
+#define ESPFORM_BUNDLE_FLAG_BR 2
+#define ESPFORM_BUNDLE_ENCODING_MASK 3
+
+typedef struct espform_bundle_entry_t
+{
+    // the offsets from the bundle start
+    uint32_t path = 0;
+    uint32_t data = 0;
+    uint32_t len = 0;
+    // the content hash (ETag) and the path hash
+    uint32_t hash = 0;
+    uint32_t route = 0;
+    uint8_t mime = 0;
+    uint8_t flags = 0;
+    uint16_t pathLen = 0;
+} espform_bundle_entry_t;
+
+class ESPFormBundle
+{
+public:
+    ESPFormBundle(const uint8_t *bundle) { _bundle = bundle; }
+
+    /**
+     * Check the bundle header.
+     * @return The boolean value indicates the bundle is valid.
+     */
+    bool valid() const
+    {
+        uint8_t h[ESPFORM_BUNDLE_HEADER_SIZE];
+        memcpy_P(h, _bundle, sizeof(h));
+        return memcmp(h, "ESPB", 4) == 0 && h[4] == ESPFORM_BUNDLE_VERSION && u16(h + 8) > 0 && (u16(h + 8) & (u16(h + 8) - 1)) == 0;
+    }
+
+    size_t size() const { return read16(6); }
+
+    /**
+     * Find the file.
+     * @param path The request path (not necessarily null terminated).
+     * @param len The length of path.
+     * @param entry The entry of the file found.
+     * @return The entry index or -1 if not found.
+     */
+    int find(const char *path, size_t len, espform_bundle_entry_t &entry) const
+    {
+        size_t slots = read16(8);
+        size_t mask = slots - 1;
+        uint32_t h = ESPFormElements::hash(path, len);
+        size_t base = ESPFORM_BUNDLE_HEADER_SIZE + size() * sizeof(espform_bundle_entry_t);
+
+        for (size_t n = 0, i = h & mask; n < slots; n++, i = (i + 1) & mask)
+        {
+            uint16_t index = read16(base + i * 2);
+            if (index == ESPFORM_BUNDLE_EMPTY_SLOT)
+                return -1;
+
+            get(index, entry);
+            if (entry.route == h && entry.pathLen == len && memcmp_P(path, _bundle + entry.path, len) == 0)
+                return index;
+        }
+        return -1;
+    }
+
+    void get(size_t index, espform_bundle_entry_t &entry) const
+    {
+        memcpy_P(&entry, _bundle + ESPFORM_BUNDLE_HEADER_SIZE + index * sizeof(espform_bundle_entry_t), sizeof(entry));
+    }
+
+    const uint8_t *data(const espform_bundle_entry_t &entry) const { return _bundle + entry.data; }
+
+private:
+    const uint8_t *_bundle = nullptr;
+
+    static uint16_t u16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+    uint16_t read16(size_t offset) const
+    {
+        uint8_t b[2];
+        memcpy_P(b, _bundle + offset, 2);
+        return u16(b);
+    }
+};
+
+#endif
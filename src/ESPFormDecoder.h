@@ -0,0 +1,428 @@
+/**
+ * The ESPForm event message decoder v1.0.0
+ *
+ * The single pass decoder for the fixed {"type","id","value","event"} message sent from the espform.js.
+ *
+ * The payload buffer is parsed and unescaped in place, the results are the null terminated slices of
+ * the payload buffer and no memory is allocated. The buffer is only modified after the whole message
+ * was validated.
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2022 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ESPFORM_DECODER_H
+#define ESPFORM_DECODER_H
+
+#include <Arduino.h>
+
+typedef struct espform_slice_t
+{
+    const char *ptr = nullptr;
+    size_t len = 0;
+    bool escaped = false;
+
+    const char *c_str() const { return ptr ? ptr : ""; }
+
+    // compare with the flash string
+    bool equals(PGM_P p) const
+    {
+        return ptr && len == strlen_P(p) && strncmp_P(ptr, p, len) == 0;
+    }
+} espform_slice_t;
+
+typedef struct espform_event_message_t
+{
+    espform_slice_t type;
+    espform_slice_t id;
+    espform_slice_t value;
+    int event = 0;
+} espform_event_message_t;
+
+static const char espform_decoder_str_1[] PROGMEM = "type";
+static const char espform_decoder_str_2[] PROGMEM = "id";
+static const char espform_decoder_str_3[] PROGMEM = "value";
+static const char espform_decoder_str_4[] PROGMEM = "event";
+
+class ESPFormDecoder
+{
+public:
+    /**
+     * Decode the event message in place.
+     * @param buf The message buffer which will be modified by the string unescaping when decoded.
+     * @param len The length of message.
+     * @param msg The message struct to store the slices of buffer.
+     * @return The boolean value indicates the message was decoded.
+     *
+     * @note The false result means the message is not the flat object of known keys with the scalar values
+     * and should be parsed with the JSON parser instead.
+     */
+    static bool decode(char *buf, size_t len, espform_event_message_t &msg)
+    {
+        char *p = buf, *end = buf + len;
+
+        msg = espform_event_message_t();
+
+        p = skip(p, end);
+        if (p == end || *p != '{')
+            return false;
+        p = skip(p + 1, end);
+
+        if (p < end && *p == '}')
+            return skip(p + 1, end) == end;
+
+        while (p < end)
+        {
+            espform_slice_t key, val;
+            bool str = false;
+
+            if (*p != '"' || !parseString(p, end, key))
+                return false;
+
+            p = skip(p, end);
+            if (p == end || *p != ':')
+                return false;
+            p = skip(p + 1, end);
+
+            if (p == end)
+                return false;
+
+            if (*p == '"')
+            {
+                if (!parseString(p, end, val))
+                    return false;
+                str = true;
+            }
+            else if (!parseScalar(p, end, val))
+                return false;
+
+            // the escaped key never matches
+            if (key.equals(espform_decoder_str_1))
+                msg.type = val;
+            else if (key.equals(espform_decoder_str_2))
+                msg.id = val;
+            else if (key.equals(espform_decoder_str_3))
+            {
+                // null is the empty value
+                if (str || !isNull(val))
+                    msg.value = val;
+            }
+            else if (key.equals(espform_decoder_str_4))
+            {
+                if (val.escaped || !parseInt(val, msg.event))
+                    return false;
+            }
+
+            p = skip(p, end);
+            if (p == end)
+                return false;
+
+            if (*p == ',')
+            {
+                p = skip(p + 1, end);
+                continue;
+            }
+
+            if (*p == '}')
+            {
+                if (skip(p + 1, end) != end)
+                    return false;
+                unescape(msg.type);
+                unescape(msg.id);
+                unescape(msg.value);
+                terminate(msg.type);
+                terminate(msg.id);
+                terminate(msg.value);
+                return true;
+            }
+
+            return false;
+        }
+
+        return false;
+    }
+
+private:
+    static char *skip(char *p, char *end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+            p++;
+        return p;
+    }
+
+    static int hex(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    static bool parseHex4(const char *p, const char *end, uint32_t &cp)
+    {
+        if (end - p < 4)
+            return false;
+        cp = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            int h = hex(p[i]);
+            if (h < 0)
+                return false;
+            cp = (cp << 4) | h;
+        }
+        return true;
+    }
+
+    // p points to the opening quote, on return p points after the closing quote
+    static bool parseString(char *&p, char *end, espform_slice_t &out)
+    {
+        char *r = ++p;
+
+        out.escaped = false;
+
+        while (r < end && *r != '"')
+        {
+            if ((uint8_t)*r < 0x20)
+                return false;
+
+            if (*r++ != '\\')
+                continue;
+
+            if (r == end)
+                return false;
+
+            out.escaped = true;
+
+            if (*r == 'u')
+            {
+                uint32_t cp = 0, lo = 0;
+                if (!parseHex4(r + 1, end, cp))
+                    return false;
+                r += 5;
+                if (cp >= 0xdc00 && cp <= 0xdfff)
+                    return false;
+                if (cp >= 0xd800 && cp <= 0xdbff)
+                {
+                    if (end - r < 6 || r[0] != '\\' || r[1] != 'u' || !parseHex4(r + 2, end, lo) || lo < 0xdc00 || lo > 0xdfff)
+                        return false;
+                    r += 6;
+                }
+            }
+            else if (*r && strchr("\"\\/bfnrt", *r))
+                r++;
+            else
+                return false;
+        }
+
+        if (r == end)
+            return false;
+
+        out.ptr = p;
+        out.len = r - p;
+        p = r + 1;
+        return true;
+    }
+
+    // the byte after the slice is its closing quote, delimiter or the unescaped gap
+    static void terminate(espform_slice_t &s)
+    {
+        if (s.ptr)
+            ((char *)s.ptr)[s.len] = '\0';
+    }
+
+    // the escape sequences were validated by parseString
+    static void unescape(espform_slice_t &s)
+    {
+        if (!s.escaped)
+            return;
+
+        char *r = (char *)s.ptr, *w = (char *)s.ptr, *end = r + s.len;
+
+        while (r < end)
+        {
+            if (*r != '\\')
+            {
+                *w++ = *r++;
+                continue;
+            }
+
+            r++;
+            switch (*r)
+            {
+            case 'b':
+                *w++ = '\b';
+                break;
+            case 'f':
+                *w++ = '\f';
+                break;
+            case 'n':
+                *w++ = '\n';
+                break;
+            case 'r':
+                *w++ = '\r';
+                break;
+            case 't':
+                *w++ = '\t';
+                break;
+            case 'u':
+            {
+                uint32_t cp = 0, lo = 0;
+                parseHex4(r + 1, end, cp);
+                r += 4;
+                if (cp >= 0xd800 && cp <= 0xdbff)
+                {
+                    parseHex4(r + 3, end, lo);
+                    r += 6;
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                }
+
+                // the UTF-8 sequence is never longer than its escaped form
+                if (cp < 0x80)
+                    *w++ = cp;
+                else if (cp < 0x800)
+                {
+                    *w++ = 0xc0 | (cp >> 6);
+                    *w++ = 0x80 | (cp & 0x3f);
+                }
+                else if (cp < 0x10000)
+                {
+                    *w++ = 0xe0 | (cp >> 12);
+                    *w++ = 0x80 | ((cp >> 6) & 0x3f);
+                    *w++ = 0x80 | (cp & 0x3f);
+                }
+                else
+                {
+                    *w++ = 0xf0 | (cp >> 18);
+                    *w++ = 0x80 | ((cp >> 12) & 0x3f);
+                    *w++ = 0x80 | ((cp >> 6) & 0x3f);
+                    *w++ = 0x80 | (cp & 0x3f);
+                }
+                break;
+            }
+            default:
+                // quote, backslash and slash
+                *w++ = *r;
+                break;
+            }
+            r++;
+        }
+
+        s.len = w - s.ptr;
+        s.escaped = false;
+    }
+
+    // number, true, false or null
+    static bool parseScalar(char *&p, char *end, espform_slice_t &out)
+    {
+        char *s = p;
+        while (p < end && *p != ',' && *p != '}' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+            p++;
+
+        size_t len = p - s;
+        if (!(len == 4 && (strncmp(s, "true", 4) == 0 || strncmp(s, "null", 4) == 0)) && !(len == 5 && strncmp(s, "false", 5) == 0) && !isNumber(s, len))
+            return false;
+
+        out.ptr = s;
+        out.len = len;
+        return true;
+    }
+
+    // the JSON number, -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    static bool isNumber(const char *s, size_t len)
+    {
+        size_t i = 0;
+
+        if (i < len && s[i] == '-')
+            i++;
+
+        if (i < len && s[i] == '0')
+            i++;
+        else if (!skipDigits(s, len, i))
+            return false;
+
+        if (i < len && s[i] == '.')
+        {
+            i++;
+            if (!skipDigits(s, len, i))
+                return false;
+        }
+
+        if (i < len && (s[i] == 'e' || s[i] == 'E'))
+        {
+            i++;
+            if (i < len && (s[i] == '+' || s[i] == '-'))
+                i++;
+            if (!skipDigits(s, len, i))
+                return false;
+        }
+
+        return i == len;
+    }
+
+    // at least one digit
+    static bool skipDigits(const char *s, size_t len, size_t &i)
+    {
+        size_t start = i;
+        while (i < len && s[i] >= '0' && s[i] <= '9')
+            i++;
+        return i > start;
+    }
+
+    static bool isNull(const espform_slice_t &s)
+    {
+        return s.len == 4 && strncmp(s.ptr, "null", 4) == 0;
+    }
+
+    static bool parseInt(const espform_slice_t &s, int &value)
+    {
+        size_t i = 0;
+        bool neg = false;
+        value = 0;
+
+        if (isNull(s))
+            return true;
+
+        if (s.len > 0 && s.ptr[0] == '-')
+        {
+            neg = true;
+            i++;
+        }
+
+        if (i == s.len)
+            return false;
+
+        for (; i < s.len; i++)
+        {
+            if (s.ptr[i] < '0' || s.ptr[i] > '9')
+                return false;
+            value = value * 10 + (s.ptr[i] - '0');
+        }
+
+        if (neg)
+            value = -value;
+        return true;
+    }
+};
+
+#endif
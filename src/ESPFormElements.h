@@ -0,0 +1,289 @@
+/**
+ * The ESPForm element registry v1.0.0
+ *
+ * The native store for the HTML form elements and their event listener config.
+ *
+ * The element data is kept as struct-of-arrays and indexed by the open-addressing
+ * hash table on the element id, the element index is its handle.
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2022 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ESPFORM_ELEMENTS_H
+#define ESPFORM_ELEMENTS_H
+
+#include <Arduino.h>
+#include <vector>
+#include "json/FirebaseJson.h"
+
+#define ESPFORM_ELEMENTS_MIN_SLOTS 16
+
+class ESPFormElements
+{
+public:
+    ESPFormElements(){};
+    ~ESPFormElements() { clear(); };
+
+    /**
+     * Append the element.
+     * @param id The element id.
+     * @param event The event type number.
+     * @param value The element value or NULL for no value.
+     * @return The element handle.
+     *
+     * @note The duplicate id is kept in order, the lookup always returns its first item.
+     */
+    int add(const char *id, uint8_t event, const char *value)
+    {
+        uint32_t h = hash(id, strlen(id));
+        int index = _ids.size();
+
+        _ids.push_back(MB_String(id));
+        _values.push_back(MB_String(value));
+        _events.push_back(event);
+        _hasValue.push_back(value != NULL);
+        _hashes.push_back(h);
+        _versions.push_back(nextVersion());
+
+        if ((_ids.size() << 1) > _slots.size())
+            rehash();
+        else if (lookup(id, strlen(id), h) < 0)
+            insert(index, h);
+
+        _revision++;
+        _layout++;
+        return index;
+    }
+
+    /**
+     * Find the element.
+     * @param id The element id (not necessarily null terminated).
+     * @param len The length of id.
+     * @return The element handle or -1 if not found.
+     */
+    int find(const char *id, size_t len) const
+    {
+        if (_ids.size() == 0)
+            return -1;
+        return lookup(id, len, hash(id, len));
+    }
+
+    int find(const char *id) const { return find(id, strlen(id)); }
+
+    /**
+     * Remove the element.
+     * @param id The element id.
+     * @return The boolean value indicates the element was removed.
+     *
+     * @note The handles of the elements after the removed element are shifted by one.
+     */
+    bool remove(const char *id)
+    {
+        int index = find(id);
+        if (index < 0)
+            return false;
+
+        _ids.erase(_ids.begin() + index);
+        _values.erase(_values.begin() + index);
+        _events.erase(_events.begin() + index);
+        _hasValue.erase(_hasValue.begin() + index);
+        _hashes.erase(_hashes.begin() + index);
+        _versions.erase(_versions.begin() + index);
+        rehash();
+        _revision++;
+        _layout++;
+        return true;
+    }
+
+    void clear()
+    {
+        _ids.clear();
+        _values.clear();
+        _events.clear();
+        _hasValue.clear();
+        _hashes.clear();
+        _versions.clear();
+        _slots.clear();
+        _revision++;
+        _layout++;
+    }
+
+    /**
+     * Exchange the elements with other registry.
+     * @param other The registry to exchange.
+     *
+     * @note The revision, layout and value version numbers keep counting on, the handles of both are changed.
+     */
+    void swap(ESPFormElements &other)
+    {
+        _ids.swap(other._ids);
+        _values.swap(other._values);
+        _events.swap(other._events);
+        _hasValue.swap(other._hasValue);
+        _hashes.swap(other._hashes);
+        _versions.swap(other._versions);
+        _slots.swap(other._slots);
+        renumber();
+        other.renumber();
+    }
+
+    size_t size() const { return _ids.size(); }
+
+    const char *id(size_t index) const { return _ids[index].c_str(); }
+
+    uint8_t event(size_t index) const { return _events[index]; }
+
+    const char *value(size_t index) const { return _values[index].c_str(); }
+
+    size_t valueLength(size_t index) const { return _values[index].length(); }
+
+    bool hasValue(size_t index) const { return _hasValue[index] > 0; }
+
+    void setEvent(size_t index, uint8_t event)
+    {
+        if (_events[index] != event)
+        {
+            _events[index] = event;
+            _revision++;
+        }
+    }
+
+    void setValue(size_t index, const char *value, size_t len)
+    {
+        if (valueEquals(index, value, len))
+            return;
+        _values[index].clear();
+        _values[index].append(value, len);
+        _hasValue[index] = 1;
+        _versions[index] = nextVersion();
+    }
+
+    /**
+     * Get the value version which changes whenever the element value was changed.
+     * @param index The element handle.
+     * @return The version number, never 0.
+     */
+    uint32_t version(size_t index) const { return _versions[index]; }
+
+    // compare the bytes with the element value
+    bool valueEquals(size_t index, const char *value, size_t len) const
+    {
+        return _hasValue[index] && _values[index].length() == len && memcmp(_values[index].c_str(), value, len) == 0;
+    }
+
+    /**
+     * Get the revision number which changes whenever the elements were added, removed or their events changed.
+     * The value changes do not change the revision.
+     * @return The revision number.
+     */
+    uint32_t revision() const { return _revision; }
+
+    /**
+     * Get the layout number which changes whenever the elements were added or removed.
+     * @return The layout number.
+     *
+     * @note The element handles are only stable while the layout number is unchanged.
+     */
+    uint32_t layout() const { return _layout; }
+
+    // FNV-1a
+    static uint32_t hash(const char *s, size_t len)
+    {
+        uint32_t h = 2166136261UL;
+        for (size_t i = 0; i < len; i++)
+        {
+            h ^= (uint8_t)s[i];
+            h *= 16777619UL;
+        }
+        return h;
+    }
+
+private:
+    std::vector<MB_String> _ids;
+    std::vector<MB_String> _values;
+    std::vector<uint8_t> _events;
+    std::vector<uint8_t> _hasValue;
+    std::vector<uint32_t> _hashes;
+    std::vector<uint32_t> _versions;
+    // open-addressing table of element index, -1 for the empty slot
+    std::vector<int> _slots;
+    uint32_t _revision = 0;
+    uint32_t _layout = 0;
+    uint32_t _version = 0;
+
+    uint32_t nextVersion()
+    {
+        if (++_version == 0)
+            _version = 1;
+        return _version;
+    }
+
+    // the elements from other registry get the new version numbers of this registry
+    void renumber()
+    {
+        for (size_t k = 0; k < _versions.size(); k++)
+            _versions[k] = nextVersion();
+        _revision++;
+        _layout++;
+    }
+
+    int lookup(const char *id, size_t len, uint32_t h) const
+    {
+        size_t mask = _slots.size() - 1;
+        size_t i = h & mask;
+        while (_slots[i] > -1)
+        {
+            int index = _slots[i];
+            if (_hashes[index] == h && _ids[index].length() == len && memcmp(_ids[index].c_str(), id, len) == 0)
+                return index;
+            i = (i + 1) & mask;
+        }
+        return -1;
+    }
+
+    void insert(int index, uint32_t h)
+    {
+        size_t mask = _slots.size() - 1;
+        size_t i = h & mask;
+        while (_slots[i] > -1)
+            i = (i + 1) & mask;
+        _slots[i] = index;
+    }
+
+    void rehash()
+    {
+        size_t n = ESPFORM_ELEMENTS_MIN_SLOTS;
+        while (n < (_ids.size() << 1))
+            n <<= 1;
+
+        _slots.assign(n, -1);
+
+        for (size_t k = 0; k < _ids.size(); k++)
+        {
+            // keep the first of duplicate ids
+            if (lookup(_ids[k].c_str(), _ids[k].length(), _hashes[k]) < 0)
+                insert(k, _hashes[k]);
+        }
+    }
+};
+
+#endif
@@ -66,4 +66,7 @@ static SdFat sd_fat_fs;   // should declare as static here
 #define ESPFORM_USE_PSRAM
 #endif
 
+// Serve the generated espform_app.js script as gzip, comment this line to serve it as plain text
+#define ESPFORM_USE_APP_SCRIPT_GZIP
+
 #endif
\ No newline at end of file
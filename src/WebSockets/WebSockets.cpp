@@ -36,6 +36,14 @@ extern "C" {
 #endif
 }
 
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32_ETH)
+#include <lwip/sockets.h>
+#endif
+
+#ifdef WEBSOCKETS_USE_DEFLATE
+#include <new>
+#endif
+
 #ifdef ESP8266
 #include <Hash.h>
 #elif defined(ESP32)
@@ -70,6 +78,202 @@ void WebSockets::clientDisconnect(WSclient_t * client, uint16_t code, char * rea
     clientDisconnect(client);
 }
 
+// each block starts with the size class index, one pointer size keeps the data aligned
+#define WEBSOCKETS_POOL_HEADER_SIZE (sizeof(void *))
+
+static const size_t WSpoolSizes[WEBSOCKETS_POOL_CLASSES] = WEBSOCKETS_POOL_SIZES;
+static const uint8_t WSpoolKeep[WEBSOCKETS_POOL_CLASSES]  = WEBSOCKETS_POOL_KEEP;
+
+WSbufferPool::WSbufferPool() {
+    for(uint8_t i = 0; i <= WEBSOCKETS_POOL_CLASSES; i++) {
+        if(i < WEBSOCKETS_POOL_CLASSES) {
+            _free[i] = NULL;
+        }
+        memset(&_stats[i], 0x00, sizeof(WSbufferPoolStats_t));
+        _stats[i].size = (i < WEBSOCKETS_POOL_CLASSES) ? WSpoolSizes[i] : 0;
+    }
+}
+
+WSbufferPool::~WSbufferPool() {
+    trim();
+}
+
+void WSbufferPool::lock(void) {
+#if defined(ESP32)
+    portENTER_CRITICAL(&_lock);
+#endif
+}
+
+void WSbufferPool::unlock(void) {
+#if defined(ESP32)
+    portEXIT_CRITICAL(&_lock);
+#endif
+}
+
+/**
+ * get a buffer of at least size bytes
+ * @param size size_t
+ * @return the buffer or NULL when out of memory, release it with release()
+ */
+uint8_t * WSbufferPool::alloc(size_t size) {
+    uint8_t sizeClass = 0;
+    while(sizeClass < WEBSOCKETS_POOL_CLASSES && WSpoolSizes[sizeClass] < size) {
+        sizeClass++;
+    }
+
+    WSbufferPoolStats_t * stats = &_stats[sizeClass];
+    uint8_t * block             = NULL;
+
+    lock();
+    if(sizeClass < WEBSOCKETS_POOL_CLASSES && _free[sizeClass]) {
+        block             = (uint8_t *)_free[sizeClass];
+        _free[sizeClass]  = _free[sizeClass]->next;
+        stats->cached--;
+        stats->hits++;
+    }
+    unlock();
+
+    if(!block) {
+        block = (uint8_t *)malloc(WEBSOCKETS_POOL_HEADER_SIZE + (sizeClass < WEBSOCKETS_POOL_CLASSES ? WSpoolSizes[sizeClass] : size));
+        if(!block) {
+            return NULL;
+        }
+        lock();
+        stats->misses++;
+        unlock();
+    }
+
+    block[0] = sizeClass;
+
+    lock();
+    stats->inUse++;
+    if(stats->inUse > stats->highWater) {
+        stats->highWater = stats->inUse;
+    }
+    unlock();
+
+    return block + WEBSOCKETS_POOL_HEADER_SIZE;
+}
+
+/**
+ * give back the buffer from alloc(), keeps it for reuse when the class is not full
+ * @param ptr void *  the buffer, may be NULL
+ */
+void WSbufferPool::release(void * ptr) {
+    if(!ptr) {
+        return;
+    }
+
+    uint8_t * block   = (uint8_t *)ptr - WEBSOCKETS_POOL_HEADER_SIZE;
+    uint8_t sizeClass = block[0];
+    bool keep         = false;
+
+    lock();
+    _stats[sizeClass].inUse--;
+    if(sizeClass < WEBSOCKETS_POOL_CLASSES && _stats[sizeClass].cached < WSpoolKeep[sizeClass]) {
+        ((WSpoolBlock_t *)block)->next = _free[sizeClass];
+        _free[sizeClass]                = (WSpoolBlock_t *)block;
+        _stats[sizeClass].cached++;
+        keep = true;
+    }
+    unlock();
+
+    if(!keep) {
+        free(block);
+    }
+}
+
+/**
+ * free all cached blocks
+ */
+void WSbufferPool::trim(void) {
+    for(uint8_t i = 0; i < WEBSOCKETS_POOL_CLASSES; i++) {
+        lock();
+        WSpoolBlock_t * block = _free[i];
+        _free[i]              = NULL;
+        _stats[i].cached      = 0;
+        unlock();
+
+        while(block) {
+            WSpoolBlock_t * next = block->next;
+            free(block);
+            block = next;
+        }
+    }
+}
+
+/**
+ * get the pool statistics
+ * @param sizeClass uint8_t  0 - (WEBSOCKETS_POOL_CLASSES - 1) or WEBSOCKETS_POOL_CLASSES for the oversized buffers
+ * @param stats WSbufferPoolStats_t *
+ * @return false if the size class is out of range
+ */
+bool WSbufferPool::getStats(uint8_t sizeClass, WSbufferPoolStats_t * stats) {
+    if(sizeClass > WEBSOCKETS_POOL_CLASSES || !stats) {
+        return false;
+    }
+    lock();
+    *stats = _stats[sizeClass];
+    unlock();
+    return true;
+}
+
+/**
+ * XOR the data with the mask key (RFC 6455 5.3), masking and unmasking are the same
+ * works on aligned 32 bit words, only the unaligned head and the tail are done byte wise
+ * @param data uint8_t *        data to mask in place
+ * @param length size_t         length of the data
+ * @param maskKey uint8_t[4]    the mask key
+ * @param offset size_t         position of the data in the frame payload
+ */
+void WebSockets::maskPayload(uint8_t * data, size_t length, const uint8_t maskKey[4], size_t offset) {
+    size_t i = 0;
+
+    if(offset & 3) {
+        uint8_t key[4] = { maskKey[offset & 3], maskKey[(offset + 1) & 3], maskKey[(offset + 2) & 3], maskKey[(offset + 3) & 3] };
+        maskPayload(data, length, key);
+        return;
+    }
+
+    // the unaligned head, the word access would fault on the Xtensa cores
+    while(i < length && ((uintptr_t)(data + i) & 3)) {
+        data[i] ^= maskKey[i & 3];
+        i++;
+    }
+
+    if(length - i >= 4) {
+        // key bytes rotated to the alignment offset, in memory order so it is endian independent
+        uint8_t rotated[4] = { maskKey[i & 3], maskKey[(i + 1) & 3], maskKey[(i + 2) & 3], maskKey[(i + 3) & 3] };
+        uint32_t key32;
+        memcpy(&key32, rotated, 4);
+
+        uint32_t * word = (uint32_t *)(data + i);
+        size_t words    = (length - i) >> 2;
+
+        while(words >= 4) {
+            word[0] ^= key32;
+            word[1] ^= key32;
+            word[2] ^= key32;
+            word[3] ^= key32;
+            word += 4;
+            words -= 4;
+        }
+
+        while(words > 0) {
+            *word++ ^= key32;
+            words--;
+        }
+
+        i = length - ((length - i) & 3);
+    }
+
+    // the tail
+    while(i < length) {
+        data[i] ^= maskKey[i & 3];
+        i++;
+    }
+}
+
 /**
  *
  * @param buf uint8_t *         ptr to the buffer for writing
@@ -78,8 +282,9 @@ void WebSockets::clientDisconnect(WSclient_t * client, uint16_t code, char * rea
  * @param mask bool             add dummy mask to the frame (needed for web browser)
  * @param maskkey uint8_t[4]    key used for payload
  * @param fin bool              can be used to send data in more then one frame (set fin on the last frame)
+ * @param rsv1 bool             set RSV1 (the compressed message of permessage-deflate)
  */
-uint8_t WebSockets::createHeader(uint8_t * headerPtr, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin) {
+uint8_t WebSockets::createHeader(uint8_t * headerPtr, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin, bool rsv1) {
     uint8_t headerSize;
     // calculate header Size
     if(length < 126) {
@@ -101,6 +306,9 @@ uint8_t WebSockets::createHeader(uint8_t * headerPtr, WSopcode_t opcode, size_t
     if(fin) {
         *headerPtr |= bit(7);    ///< set Fin
     }
+    if(rsv1) {
+        *headerPtr |= bit(6);    ///< set RSV1
+    }
     *headerPtr |= opcode;    ///< set opcode
     headerPtr++;
 
@@ -204,6 +412,16 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
         //DEBUG_WEBSOCKETS("[WS][%d][sendFrame] text: %s\n", client->num, (payload + (headerToPayload ? 14 : 0)));
     }
 
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    if(!client->cIsClient) {
+        // the server side frames go through the client queue so a slow client never blocks the caller
+        WSsharedFrame_t * frame = createSharedFrame(opcode, payload, length, fin, headerToPayload);
+        bool ret                = queueFrame(client, frame);
+        releaseSharedFrame(frame);
+        return ret;
+    }
+#endif
+
     uint8_t maskKey[4]                         = { 0x00, 0x00, 0x00, 0x00 };
     uint8_t buffer[WEBSOCKETS_MAX_HEADER_SIZE] = { 0 };
 
@@ -231,7 +449,7 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
     // try to send data in one TCP package (only if some free Heap is there)
     if(!headerToPayload && ((length > 0) && (length < 1400)) && (GET_FREE_HEAP > 6000)) {
         //DEBUG_WEBSOCKETS("[WS][%d][sendFrame] pack to one TCP package...\n", client->num);
-        uint8_t * dataPtr = (uint8_t *)malloc(length + WEBSOCKETS_MAX_HEADER_SIZE);
+        uint8_t * dataPtr = _pool.alloc(length + WEBSOCKETS_MAX_HEADER_SIZE);
         if(dataPtr) {
             memcpy((dataPtr + WEBSOCKETS_MAX_HEADER_SIZE), payload, length);
             headerToPayload = true;
@@ -268,9 +486,7 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
             dataMaskPtr = payloadPtr;
         }
 
-        for(size_t x = 0; x < length; x++) {
-            dataMaskPtr[x] = (dataMaskPtr[x] ^ maskKey[x % 4]);
-        }
+        maskPayload(dataMaskPtr, length, maskKey);
     }
 
 #ifndef NO//DEBUG_WEBSOCKETS
@@ -302,13 +518,302 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
 
 #ifdef WEBSOCKETS_USE_BIG_MEM
     if(useInternBuffer && payloadPtr) {
-        free(payloadPtr);
+        _pool.release(payloadPtr);
     }
 #endif
 
     return ret;
 }
 
+/**
+ * encode the unmasked frame once so the same bytes can be written to many clients
+ * @param opcode WSopcode_t
+ * @param payload uint8_t *     ptr to the payload
+ * @param length size_t         length of the payload
+ * @param fin bool              can be used to send data in more then one frame (set fin on the last frame)
+ * @param headerToPayload bool  set true if the payload has reserved 14 Byte at the beginning, the header is written in place and the payload is not copied
+ * @param rsv1 bool             set RSV1 (the compressed message of permessage-deflate)
+ * @return the frame with one reference or NULL when out of memory
+ */
+WSsharedFrame_t * WebSockets::createSharedFrame(WSopcode_t opcode, uint8_t * payload, size_t length, bool fin, bool headerToPayload, bool rsv1) {
+    uint8_t maskKey[4] = { 0x00, 0x00, 0x00, 0x00 };
+    uint8_t buffer[WEBSOCKETS_MAX_HEADER_SIZE];
+
+    uint8_t headerSize = createHeader(&buffer[0], opcode, length, false, maskKey, fin, rsv1);
+
+    WSsharedFrame_t * frame = (WSsharedFrame_t *)_pool.alloc(sizeof(WSsharedFrame_t) + (headerToPayload ? 0 : headerSize + length));
+    if(!frame) {
+        return NULL;
+    }
+
+    frame->borrowed = headerToPayload;
+    // only the complete message can replace the queued one, the fragments are never coalesced
+    frame->key      = (fin && (opcode == WSop_text || opcode == WSop_binary)) ? _messageKey : 0;
+
+    if(headerToPayload) {
+        frame->data = payload + (WEBSOCKETS_MAX_HEADER_SIZE - headerSize);
+    } else {
+        frame->data = (uint8_t *)(frame + 1);
+        if(payload && length > 0) {
+            memcpy(frame->data + headerSize, payload, length);
+        }
+    }
+
+    memcpy(frame->data, &buffer[0], headerSize);
+    frame->length = headerSize + length;
+    frame->refs   = 1;
+    return frame;
+}
+
+WSsharedFrame_t * WebSockets::retainSharedFrame(WSsharedFrame_t * frame) {
+    if(frame) {
+        frame->refs++;
+    }
+    return frame;
+}
+
+void WebSockets::releaseSharedFrame(WSsharedFrame_t * frame) {
+    if(frame && --frame->refs == 0) {
+        if(!frame->borrowed && frame->data != (uint8_t *)(frame + 1)) {
+            // the detached copy
+            _pool.release(frame->data);
+        }
+        _pool.release(frame);
+    }
+}
+
+/**
+ * copy the frame bytes that point into the caller payload so the frame can outlive the send call
+ * @param frame WSsharedFrame_t *
+ * @return false when out of memory
+ */
+bool WebSockets::detachSharedFrame(WSsharedFrame_t * frame) {
+    if(!frame->borrowed) {
+        return true;
+    }
+
+    uint8_t * data = _pool.alloc(frame->length);
+    if(!data) {
+        return false;
+    }
+
+    memcpy(data, frame->data, frame->length);
+    frame->data     = data;
+    frame->borrowed = false;
+    return true;
+}
+
+/**
+ * write the shared frame to the client, only for the server side clients since the frame is not masked
+ * @param client WSclient_t *   ptr to the client struct
+ * @param frame WSsharedFrame_t *
+ * @return true if ok
+ */
+bool WebSockets::sendSharedFrame(WSclient_t * client, WSsharedFrame_t * frame) {
+    if(!frame || client->cIsClient) {
+        return false;
+    }
+
+    if(client->tcp && !client->tcp->connected()) {
+        return false;
+    }
+
+    if(client->status != WSC_CONNECTED) {
+        return false;
+    }
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    return queueFrame(client, frame);
+#else
+    return write(client, frame->data, frame->length) == frame->length;
+#endif
+}
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+static inline uint8_t queueSlot(WSclient_t * client, uint8_t index) {
+    return (client->cTxHead + index) % WEBSOCKETS_TX_QUEUE_SIZE;
+}
+
+/**
+ * queue the frame to the server side client, the bytes the socket takes are written at once
+ * and the rest is written by flushQueue from the loop
+ * @param client WSclient_t *   ptr to the client struct
+ * @param frame WSsharedFrame_t *
+ * @return false if the frame was not queued (dropped or out of memory)
+ */
+bool WebSockets::queueFrame(WSclient_t * client, WSsharedFrame_t * frame) {
+    if(!frame || client->cTxOverflow) {
+        return false;
+    }
+
+    if(client->cTxCount == 0) {
+        size_t n = writeSome(client, frame->data, frame->length);
+        if(n == frame->length) {
+            return true;
+        }
+        client->cTxSent = n;
+    } else {
+        // the newer message of the same key replaces the queued one which was not started
+        if(_queuePolicy == WSqueue_coalesce && frame->key != 0) {
+            for(uint8_t i = (client->cTxSent > 0 ? 1 : 0); i < client->cTxCount; i++) {
+                uint8_t slot             = queueSlot(client, i);
+                WSsharedFrame_t * queued = client->cTxFrames[slot];
+                if(queued->key == frame->key) {
+                    if(!detachSharedFrame(frame)) {
+                        return false;
+                    }
+                    client->cTxBytes -= queued->length;
+                    client->cTxBytes += frame->length;
+                    client->cTxFrames[slot] = retainSharedFrame(frame);
+                    releaseSharedFrame(queued);
+                    client->cTxCoalesced++;
+                    return true;
+                }
+            }
+        }
+
+        while(client->cTxCount == WEBSOCKETS_TX_QUEUE_SIZE || client->cTxBytes + frame->length > _queueBytes) {
+            if(_queuePolicy == WSqueue_disconnect) {
+                //DEBUG_WEBSOCKETS("[WS][%d][queueFrame] queue full, disconnect\n", client->num);
+                client->cTxOverflow = true;
+                return false;
+            }
+            if(!dropQueuedFrame(client)) {
+                break;
+            }
+        }
+
+        if(client->cTxCount == WEBSOCKETS_TX_QUEUE_SIZE) {
+            client->cTxDropped++;
+            return false;
+        }
+    }
+
+    if(!detachSharedFrame(frame)) {
+        if(client->cTxCount == 0 && client->cTxSent > 0) {
+            // the frame was partly written, the stream can not continue
+            client->cTxOverflow = true;
+            client->cTxSent     = 0;
+        }
+        return false;
+    }
+
+    client->cTxFrames[queueSlot(client, client->cTxCount)] = retainSharedFrame(frame);
+    client->cTxCount++;
+    client->cTxBytes += frame->length;
+    if(client->cTxCount > client->cTxHighWater) {
+        client->cTxHighWater = client->cTxCount;
+    }
+    return true;
+}
+
+/**
+ * drop the oldest complete text or binary message that was not started, the control frames are kept
+ * @param client WSclient_t *   ptr to the client struct
+ * @return true if a frame was dropped
+ */
+bool WebSockets::dropQueuedFrame(WSclient_t * client) {
+    for(uint8_t i = (client->cTxSent > 0 ? 1 : 0); i < client->cTxCount; i++) {
+        WSsharedFrame_t * queued = client->cTxFrames[queueSlot(client, i)];
+        // FIN and the text or binary opcode, RSV1 is ignored
+        uint8_t first = queued->data[0] & 0x8F;
+        if(first != (0x80 | WSop_text) && first != (0x80 | WSop_binary)) {
+            continue;
+        }
+
+        for(uint8_t k = i; k + 1 < client->cTxCount; k++) {
+            client->cTxFrames[queueSlot(client, k)] = client->cTxFrames[queueSlot(client, k + 1)];
+        }
+        client->cTxCount--;
+        client->cTxBytes -= queued->length;
+        client->cTxDropped++;
+        releaseSharedFrame(queued);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * write the queued frames until the socket takes no more, called from the loop
+ * @param client WSclient_t *   ptr to the client struct
+ */
+void WebSockets::flushQueue(WSclient_t * client) {
+    while(client->cTxCount > 0) {
+        WSsharedFrame_t * frame = client->cTxFrames[client->cTxHead];
+
+        client->cTxSent += writeSome(client, frame->data + client->cTxSent, frame->length - client->cTxSent);
+        if(client->cTxSent < frame->length) {
+            break;
+        }
+
+        client->cTxFrames[client->cTxHead] = NULL;
+        client->cTxHead                    = queueSlot(client, 1);
+        client->cTxCount--;
+        client->cTxBytes -= frame->length;
+        client->cTxSent = 0;
+        releaseSharedFrame(frame);
+    }
+}
+
+/**
+ * release the queued frames and reset the queue metrics
+ * @param client WSclient_t *   ptr to the client struct
+ */
+void WebSockets::clearQueue(WSclient_t * client) {
+    while(client->cTxCount > 0) {
+        releaseSharedFrame(client->cTxFrames[client->cTxHead]);
+        client->cTxFrames[client->cTxHead] = NULL;
+        client->cTxHead                    = queueSlot(client, 1);
+        client->cTxCount--;
+    }
+    client->cTxHead      = 0;
+    client->cTxSent      = 0;
+    client->cTxBytes     = 0;
+    client->cTxHighWater = 0;
+    client->cTxOverflow  = false;
+    client->cTxDropped   = 0;
+    client->cTxCoalesced = 0;
+}
+
+/**
+ * write what the socket takes without waiting
+ * @param client WSclient_t *
+ * @param out const uint8_t * data buffer
+ * @param n size_t byte count
+ * @return bytes written
+ */
+size_t WebSockets::writeSome(WSclient_t * client, const uint8_t * out, size_t n) {
+    if(client->tcp == NULL || !client->tcp->connected()) {
+        return 0;
+    }
+
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
+    // the write waits for the acks when the data does not fit the send buffer
+    size_t room = client->tcp->availableForWrite();
+    if(n > room) {
+        n = room;
+    }
+#elif(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32_ETH)
+    // WiFiClient::write retries until the socket took all bytes, the socket is given only what fits its send buffer
+    int fd = client->tcp->fd();
+    if(fd < 0 || n == 0) {
+        return 0;
+    }
+    ssize_t sent = lwip_send(fd, out, n, MSG_DONTWAIT);
+    return sent > 0 ? (size_t)sent : 0;
+#else
+    if(n > WEBSOCKETS_TX_CHUNK_SIZE) {
+        n = WEBSOCKETS_TX_CHUNK_SIZE;
+    }
+#endif
+
+    if(n == 0) {
+        return 0;
+    }
+    return client->tcp->write(out, n);
+}
+#endif
+
 /**
  * callen when HTTP header is done
  * @param client WSclient_t *  ptr to the client struct
@@ -328,9 +833,41 @@ void WebSockets::headerDone(WSclient_t * client) {
  * @param client WSclient_t *  ptr to the client struct
  */
 void WebSockets::handleWebsocket(WSclient_t * client) {
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     if(client->cWsRXsize == 0) {
         handleWebsocketCb(client);
     }
+#else
+    // resume the frame in progress, only the available data is read
+    handleWebsocketCb(client);
+#endif
+}
+
+/**
+ * disconnect the client when the frame in progress was stalled
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::handleWebsocketTimeout(WSclient_t * client) {
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    if(client->status == WSC_CONNECTED && client->cWsRXsize > 0 && (millis() - client->cWsRXlast) > WEBSOCKETS_TCP_TIMEOUT) {
+        //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketTimeout] receive TIMEOUT!\n", client->num);
+        clientDisconnect(client, 1002);
+    }
+#endif
+}
+
+/**
+ * reset the RX state and free the payload of the frame in progress
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::clearWebsocketRX(WSclient_t * client) {
+    client->cWsRXsize = 0;
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    _pool.release(client->cWsRXpayload);
+    client->cWsRXpayload     = NULL;
+    client->cWsRXpayloadSize = 0;
+    client->cWsRXstreamed    = 0;
+#endif
 }
 
 /**
@@ -352,6 +889,26 @@ bool WebSockets::handleWebsocketWaitFor(WSclient_t * client, size_t size) {
         return true;
     }
 
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    // read what is available and return, the next call continues from cWsRXsize
+    int len = client->tcp->available();
+    if(len <= 0) {
+        return false;
+    }
+
+    size_t n = size - client->cWsRXsize;
+    if((size_t)len < n) {
+        n = len;
+    }
+
+    len = client->tcp->read(&client->cWsHeader[client->cWsRXsize], n);
+    if(len > 0) {
+        client->cWsRXsize += len;
+        client->cWsRXlast = millis();
+    }
+
+    return client->cWsRXsize >= size;
+#else
     //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketWaitFor] size: %d cWsRXsize: %d\n", client->num, size, client->cWsRXsize);
     readCb(client, &client->cWsHeader[client->cWsRXsize], (size - client->cWsRXsize), std::bind([](WebSockets * server, size_t size, WSclient_t * client, bool ok) {
         //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketWaitFor][readCb] size: %d ok: %d\n", client->num, size, ok);
@@ -367,6 +924,7 @@ bool WebSockets::handleWebsocketWaitFor(WSclient_t * client, size_t size) {
     },
                                                                                           this, size, std::placeholders::_1, std::placeholders::_2));
     return false;
+#endif
 }
 
 void WebSockets::handleWebsocketCb(WSclient_t * client) {
@@ -424,7 +982,14 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
     //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] fin: %u rsv1: %u rsv2: %u rsv3 %u  opCode: %u\n", client->num, header->fin, header->rsv1, header->rsv2, header->rsv3, header->opCode);
     //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] mask: %u payloadLen: %u\n", client->num, header->mask, header->payloadLen);
 
-    if(header->payloadLen > WEBSOCKETS_MAX_DATA_SIZE) {
+    // the data frames too big for one buffer may be streamed (non async only), the control frames never
+    bool stream = false;
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    // the compressed message needs the whole payload to inflate
+    stream = (header->payloadLen > WEBSOCKETS_MAX_DATA_SIZE && _streamChunkSize > 0 && header->opCode < WSop_close && !header->rsv1);
+#endif
+
+    if(header->payloadLen > WEBSOCKETS_MAX_DATA_SIZE && !stream) {
         //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] payload too big! (%u)\n", client->num, header->payloadLen);
         clientDisconnect(client, 1009);
         return;
@@ -440,8 +1005,80 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
     }
 
     if(header->payloadLen > 0) {
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+        // the header is decoded again on every resume, the payload buffer is kept in the client struct
+        // when streaming, the buffer holds one chunk and cWsRXstreamed counts the payload bytes delivered before it
+        size_t bufferSize = stream ? _streamChunkSize : header->payloadLen;
+
+        if(!client->cWsRXpayload) {
+            // if text data we need one more
+            client->cWsRXpayload     = _pool.alloc(bufferSize + 1);
+            client->cWsRXpayloadSize = 0;
+
+            if(!client->cWsRXpayload) {
+                //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] to less memory to handle payload %d!\n", client->num, header->payloadLen);
+                clientDisconnect(client, 1011);
+                return;
+            }
+        }
+
+        size_t remaining = header->payloadLen - client->cWsRXstreamed;
+
+        int len = client->tcp->available();
+        if(len > 0) {
+            size_t n = (remaining < bufferSize ? remaining : bufferSize) - client->cWsRXpayloadSize;
+            if((size_t)len < n) {
+                n = len;
+            }
+
+            len = client->tcp->read(client->cWsRXpayload + client->cWsRXpayloadSize, n);
+            if(len > 0) {
+                client->cWsRXpayloadSize += len;
+                client->cWsRXlast = millis();
+            }
+        }
+
+        if(stream) {
+            if(client->cWsRXpayloadSize < bufferSize && client->cWsRXpayloadSize < remaining) {
+                return;
+            }
+
+            // deliver the chunk as the message fragment
+            size_t chunkLen = client->cWsRXpayloadSize;
+            bool first      = (client->cWsRXstreamed == 0);
+            bool last       = (chunkLen == remaining);
+
+            payload = client->cWsRXpayload;
+            if(header->mask) {
+                maskPayload(payload, chunkLen, header->maskKey, client->cWsRXstreamed);
+            }
+            payload[chunkLen] = 0x00;
+
+            client->cWsRXstreamed += chunkLen;
+            client->cWsRXpayloadSize = 0;
+
+            //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] stream chunk %u of %u\n", client->num, client->cWsRXstreamed, header->payloadLen);
+
+            messageReceived(client, first ? header->opCode : WSop_continuation, payload, chunkLen, last && header->fin);
+
+            // the client may be disconnected by the callback, the RX state was cleared then
+            if(last && client->cWsRXpayload == payload) {
+                clearWebsocketRX(client);
+            }
+            return;
+        }
+
+        if(client->cWsRXpayloadSize < header->payloadLen) {
+            return;
+        }
+
+        payload                  = client->cWsRXpayload;
+        client->cWsRXpayload     = NULL;
+        client->cWsRXpayloadSize = 0;
+        handleWebsocketPayloadCb(client, true, payload);
+#else
         // if text data we need one more
-        payload = (uint8_t *)malloc(header->payloadLen + 1);
+        payload = _pool.alloc(header->payloadLen + 1);
 
         if(!payload) {
             //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] to less memory to handle payload %d!\n", client->num, header->payloadLen);
@@ -449,6 +1086,7 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
             return;
         }
         readCb(client, payload, header->payloadLen, std::bind(&WebSockets::handleWebsocketPayloadCb, this, std::placeholders::_1, std::placeholders::_2, payload));
+#endif
     } else {
         handleWebsocketPayloadCb(client, true, NULL);
     }
@@ -462,9 +1100,7 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
 
             if(header->mask) {
                 //decode XOR
-                for(size_t i = 0; i < header->payloadLen; i++) {
-                    payload[i] = (payload[i] ^ header->maskKey[i % 4]);
-                }
+                maskPayload(payload, header->payloadLen, header->maskKey);
             }
         }
 
@@ -474,6 +1110,12 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
                 // no break here!
             case WSop_binary:
             case WSop_continuation:
+#ifdef WEBSOCKETS_USE_DEFLATE
+                if(header->rsv1 && client->cDeflate) {
+                    handleDeflatePayload(client, payload);
+                    break;
+                }
+#endif
                 messageReceived(client, header->opCode, payload, header->payloadLen, header->fin);
                 break;
             case WSop_ping:
@@ -507,9 +1149,7 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
                 break;
         }
 
-        if(payload) {
-            free(payload);
-        }
+        _pool.release(payload);
 
         // reset input
         client->cWsRXsize = 0;
@@ -520,35 +1160,137 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
 
     } else {
         //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] missing data!\n", client->num);
-        free(payload);
+        _pool.release(payload);
         clientDisconnect(client, 1002);
     }
 }
 
+#ifdef WEBSOCKETS_USE_DEFLATE
+/**
+ * inflate the compressed message (RFC 7692) and pass it on,
+ * only the unfragmented messages are supported and the context is never kept (client_no_context_takeover)
+ * @param client WSclient_t *  ptr to the client struct
+ * @param payload uint8_t *    the unmasked payload of the frame
+ */
+void WebSockets::handleDeflatePayload(WSclient_t * client, uint8_t * payload) {
+    static const uint8_t tail[4] = { 0x00, 0x00, 0xff, 0xff };
+    WSMessageHeader_t * header   = &client->cWsHeaderDecode;
+
+    if(!header->fin || header->opCode == WSop_continuation) {
+        //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] fragmented compressed message not supported\n", client->num);
+        clientDisconnect(client, 1003);
+        return;
+    }
+
+    // the decoder tables are too big for the stack of ESP8266
+    void * mem = _pool.alloc(sizeof(MB_Inflate));
+    if(!mem) {
+        clientDisconnect(client, 1011);
+        return;
+    }
+    MB_Inflate * inflater = new(mem) MB_Inflate();
+
+    size_t size    = header->payloadLen * 4 + 64;
+    uint8_t * out  = NULL;
+    int len        = MB_INFLATE_OVERFLOW;
+    uint16_t code  = 0;
+
+    while(len == MB_INFLATE_OVERFLOW) {
+        if(size > WEBSOCKETS_MAX_DATA_SIZE) {
+            size = WEBSOCKETS_MAX_DATA_SIZE;
+        }
+
+        // if text data we need one more
+        out = _pool.alloc(size + 1);
+        if(!out) {
+            code = 1011;
+            break;
+        }
+
+        len = inflater->decompress(payload, header->payloadLen, out, size, tail, sizeof(tail));
+        if(len >= 0) {
+            break;
+        }
+
+        _pool.release(out);
+        out = NULL;
+
+        if(len == MB_INFLATE_OVERFLOW && size == WEBSOCKETS_MAX_DATA_SIZE) {
+            code = 1009;
+            break;
+        }
+        if(len == MB_INFLATE_ERROR) {
+            code = 1007;
+        }
+        size <<= 2;
+    }
+
+    inflater->~MB_Inflate();
+    _pool.release(mem);
+
+    if(!out) {
+        //DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] inflate failed (%d)\n", client->num, code);
+        clientDisconnect(client, code);
+        return;
+    }
+
+    out[len] = 0x00;
+    messageReceived(client, header->opCode, out, len, true);
+    _pool.release(out);
+}
+#endif
+
 /**
  * generate the key for Sec-WebSocket-Accept
  * @param clientKey String
  * @return String Accept Key
  */
 String WebSockets::acceptKey(String & clientKey) {
+    char key[WEBSOCKETS_ACCEPT_KEY_SIZE];
+    acceptKey(clientKey.c_str(), clientKey.length(), key);
+    return String(key);
+}
+
+/**
+ * generate the key for Sec-WebSocket-Accept without heap allocation
+ * @param clientKey const char *  the Sec-WebSocket-Key value
+ * @param len size_t  length of the key, at most WEBSOCKETS_MAX_KEY_SIZE bytes are used
+ * @param out char *  buffer of WEBSOCKETS_ACCEPT_KEY_SIZE bytes for the null terminated accept key
+ */
+void WebSockets::acceptKey(const char * clientKey, size_t len, char * out) {
+    static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
     uint8_t sha1HashBin[20] = { 0 };
+    char data[WEBSOCKETS_MAX_KEY_SIZE + sizeof(guid)];
+
+    if(len > WEBSOCKETS_MAX_KEY_SIZE) {
+        len = WEBSOCKETS_MAX_KEY_SIZE;
+    }
+
+    memcpy(data, clientKey, len);
+    memcpy(data + len, guid, sizeof(guid) - 1);
+    len += sizeof(guid) - 1;
+
 #ifdef ESP8266
-    sha1(clientKey + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", &sha1HashBin[0]);
+    sha1((const uint8_t *)data, len, &sha1HashBin[0]);
 #elif defined(ESP32)
-    String data = clientKey + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
-    esp_sha(SHA1, (unsigned char *)data.c_str(), data.length(), &sha1HashBin[0]);
+    esp_sha(SHA1, (unsigned char *)data, len, &sha1HashBin[0]);
 #else
-    clientKey += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
     SHA1_CTX ctx;
     SHA1Init(&ctx);
-    SHA1Update(&ctx, (const unsigned char *)clientKey.c_str(), clientKey.length());
+    SHA1Update(&ctx, (const unsigned char *)data, len);
     SHA1Final(&sha1HashBin[0], &ctx);
 #endif
 
-    String key = base64_encode(sha1HashBin, 20);
-    key.trim();
+    base64_encodestate _state;
+    base64_init_encodestate(&_state);
+    int n = base64_encode_block((const char *)&sha1HashBin[0], 20, out, &_state);
+    n += base64_encode_blockend((out + n), &_state);
 
-    return key;
+    // remove the line end added by the encoder
+    while(n > 0 && (out[n - 1] == '\n' || out[n - 1] == '\r')) {
+        n--;
+    }
+    out[n] = 0;
 }
 
 /**
@@ -58,6 +58,18 @@
 #define WEBSOCKETS_MAX_DATA_SIZE (15 * 1024)
 #define WEBSOCKETS_USE_BIG_MEM
 #define GET_FREE_HEAP ESP.getFreeHeap()
+// allocate the server client structs from PSRAM when the board has it
+#define WEBSOCKETS_USE_PSRAM
+// free blocks kept by each buffer pool size class
+#ifndef WEBSOCKETS_POOL_KEEP
+#define WEBSOCKETS_POOL_KEEP { 4, 2, 1 }
+#endif
+// bytes queued for each server client before the overflow policy applies
+#ifndef WEBSOCKETS_TX_QUEUE_BYTES
+#define WEBSOCKETS_TX_QUEUE_BYTES (8 * 1024)
+#endif
+// permessage-deflate (RFC 7692) for the server, the compressor keeps (2 << MB_DEFLATE_WINDOW_BITS) + 4 KB once used
+//#define WEBSOCKETS_USE_DEFLATE
 // moves all Header strings to Flash (~300 Byte)
 //#define WEBSOCKETS_SAVE_RAM
 
@@ -66,6 +78,12 @@
 #define WEBSOCKETS_MAX_DATA_SIZE (15 * 1024)
 #define WEBSOCKETS_USE_BIG_MEM
 #define GET_FREE_HEAP System.freeMemory()
+#ifndef WEBSOCKETS_POOL_KEEP
+#define WEBSOCKETS_POOL_KEEP { 4, 2, 1 }
+#endif
+#ifndef WEBSOCKETS_TX_QUEUE_BYTES
+#define WEBSOCKETS_TX_QUEUE_BYTES (8 * 1024)
+#endif
 
 #else
 
@@ -73,11 +91,26 @@
 #define WEBSOCKETS_MAX_DATA_SIZE (1024)
 // moves all Header strings to Flash
 #define WEBSOCKETS_SAVE_RAM
+#ifndef WEBSOCKETS_POOL_KEEP
+#define WEBSOCKETS_POOL_KEEP { 1, 0, 0 }
+#endif
+#ifndef WEBSOCKETS_TX_QUEUE_BYTES
+#define WEBSOCKETS_TX_QUEUE_BYTES (512)
+#endif
 
 #endif
 
 #define WEBSOCKETS_TCP_TIMEOUT (5000)
 
+#ifdef WEBSOCKETS_USE_DEFLATE
+#include "../deflate/MB_Deflate.h"
+#include "../deflate/MB_Inflate.h"
+// the smaller messages are sent uncompressed
+#ifndef WEBSOCKETS_DEFLATE_MIN_SIZE
+#define WEBSOCKETS_DEFLATE_MIN_SIZE (64)
+#endif
+#endif
+
 #define NETWORK_ESP8266_ASYNC (0)
 #define NETWORK_ESP8266 (1)
 #define NETWORK_W5100 (2)
@@ -88,6 +121,32 @@
 // max size of the WS Message Header
 #define WEBSOCKETS_MAX_HEADER_SIZE (14)
 
+// the Sec-WebSocket-Key is 24 bytes (base64 of 16 bytes), the accept key is 28 bytes + line end
+#define WEBSOCKETS_MAX_KEY_SIZE (32)
+#define WEBSOCKETS_ACCEPT_KEY_SIZE (32)
+
+// the frame buffer pool size classes, the larger buffers are taken from the heap directly
+#define WEBSOCKETS_POOL_CLASSES (3)
+#ifndef WEBSOCKETS_POOL_SIZES
+#define WEBSOCKETS_POOL_SIZES { 128, 512, 1536 }
+#endif
+
+#ifndef WEBSOCKETS_TX_QUEUE_SIZE
+// the frames queued for each server client
+#define WEBSOCKETS_TX_QUEUE_SIZE (8)
+#endif
+
+#ifndef WEBSOCKETS_TX_CHUNK_SIZE
+// the most bytes given to one tcp write when the network class can not tell the free send buffer
+#define WEBSOCKETS_TX_CHUNK_SIZE (1436)
+#endif
+
+#ifndef WEBSOCKETS_HTTP_LINE_SIZE
+// the server handshake header line buffer, the longer lines are only accepted for the headers the server does not read
+// (e.g. User-Agent, Cookie), the others are answered with 431
+#define WEBSOCKETS_HTTP_LINE_SIZE (128)
+#endif
+
 #if !defined(WEBSOCKETS_NETWORK_TYPE)
 // select Network type based
 #if defined(ESP8266) || defined(ESP31B)
@@ -241,6 +300,32 @@ typedef struct {
     uint8_t * maskKey;
 } WSMessageHeader_t;
 
+/**
+ * the encoded (unmasked) frame shared by several clients,
+ * header and payload are kept in one allocation and freed with the last reference
+ */
+typedef struct {
+    uint16_t refs;      ///< one per queue holding the frame and one for the creator, above the 255 clients
+    bool borrowed;      ///< data points into the caller payload (headerToPayload) and must be copied before queueing
+    uint32_t key;       ///< coalescing key of the message, 0 for none
+    size_t length;      ///< frame length (header + payload)
+    uint8_t * data;     ///< frame start, points into this allocation, the caller payload or the copy of it
+} WSsharedFrame_t;
+
+typedef enum {
+    WSqueue_dropOldest,    ///< drop the oldest queued messages that were not started
+    WSqueue_coalesce,      ///< replace the queued message of the same key, otherwise drop the oldest
+    WSqueue_disconnect     ///< disconnect the client
+} WSqueuePolicy_t;
+
+typedef struct {
+    uint8_t frames;         ///< frames in the queue
+    uint8_t highWater;      ///< most frames in the queue at the same time
+    size_t bytes;           ///< bytes in the queue not written yet
+    uint32_t dropped;       ///< messages dropped by the overflow policy
+    uint32_t coalesced;     ///< messages replaced by the newer message of the same key
+} WSqueueStats_t;
+
 typedef struct {
     uint8_t num;    ///< connection number
 
@@ -269,10 +354,31 @@ typedef struct {
     String cExtensions;    ///< client Sec-WebSocket-Extensions
     uint16_t cVersion;     ///< client Sec-WebSocket-Version
 
+#ifdef WEBSOCKETS_USE_DEFLATE
+    bool cDeflate = false;    ///< permessage-deflate was negotiated
+#endif
+
     uint8_t cWsRXsize;                                ///< State of the RX
     uint8_t cWsHeader[WEBSOCKETS_MAX_HEADER_SIZE];    ///< RX WS Message buffer
     WSMessageHeader_t cWsHeaderDecode;
 
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    uint8_t * cWsRXpayload  = NULL;    ///< RX payload of the frame in progress
+    size_t cWsRXpayloadSize = 0;       ///< RX payload bytes received
+    size_t cWsRXstreamed    = 0;       ///< RX payload bytes of the frame already delivered as chunks
+    unsigned long cWsRXlast = 0;       ///< millis when the last RX bytes of the frame in progress were received
+
+    WSsharedFrame_t * cTxFrames[WEBSOCKETS_TX_QUEUE_SIZE];    ///< TX queue (server), ring buffer
+    uint8_t cTxHead       = 0;
+    uint8_t cTxCount      = 0;
+    uint8_t cTxHighWater  = 0;
+    bool cTxOverflow      = false;    ///< the disconnect policy was triggered, the client is closed by the loop
+    size_t cTxSent        = 0;        ///< bytes of the head frame already written
+    size_t cTxBytes       = 0;        ///< length of all queued frames
+    uint32_t cTxDropped   = 0;
+    uint32_t cTxCoalesced = 0;
+#endif
+
     String base64Authorization;    ///< Base64 encoded Auth request
     String plainAuthorization;     ///< Base64 encoded Auth request
 
@@ -290,12 +396,68 @@ typedef struct {
 
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     String cHttpLine;    ///< HTTP header lines
+#else
+    char cHttpBuf[WEBSOCKETS_HTTP_LINE_SIZE];    ///< HTTP header line in progress (server)
+    uint16_t cHttpBufLen   = 0;
+    bool cHttpBufTruncated = false;    ///< the line in progress did not fit cHttpBuf
 #endif
 
 } WSclient_t;
 
+typedef struct {
+    size_t size;           ///< block size of the class, 0 for the oversized buffers
+    uint16_t inUse;        ///< blocks currently in use
+    uint16_t highWater;    ///< most blocks in use at the same time
+    uint16_t cached;       ///< free blocks kept for reuse
+    uint32_t hits;         ///< allocations served from the cached blocks
+    uint32_t misses;       ///< allocations served from the heap
+} WSbufferPoolStats_t;
+
+/**
+ * size classed pool for the frame buffers,
+ * the released blocks are kept on a free list (up to WEBSOCKETS_POOL_KEEP per class) instead of going back to the heap
+ */
+class WSbufferPool {
+  public:
+    WSbufferPool();
+    ~WSbufferPool();
+
+    uint8_t * alloc(size_t size);
+    void release(void * ptr);
+    void trim(void);
+
+    bool getStats(uint8_t sizeClass, WSbufferPoolStats_t * stats);
+
+  private:
+    typedef struct WSpoolBlock_s {
+        struct WSpoolBlock_s * next;
+    } WSpoolBlock_t;
+
+    WSpoolBlock_t * _free[WEBSOCKETS_POOL_CLASSES];
+    // the last entry counts the oversized buffers
+    WSbufferPoolStats_t _stats[WEBSOCKETS_POOL_CLASSES + 1];
+
+#if defined(ESP32)
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+    void lock(void);
+    void unlock(void);
+};
+
 class WebSockets {
   protected:
+    WSbufferPool _pool;
+    // the frames larger than WEBSOCKETS_MAX_DATA_SIZE are delivered in chunks of this size, 0 refuses them
+    size_t _streamChunkSize = 0;
+    // the coalescing key given to the next text or binary shared frame
+    uint32_t _messageKey = 0;
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    WSqueuePolicy_t _queuePolicy = WSqueue_dropOldest;
+    size_t _queueBytes           = WEBSOCKETS_TX_QUEUE_BYTES;
+#endif
+
 #ifdef __AVR__
     typedef void (*WSreadWaitCb)(WSclient_t * client, bool ok);
 #else
@@ -309,19 +471,40 @@ class WebSockets {
 
     virtual void messageReceived(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, bool fin) = 0;
 
-    uint8_t createHeader(uint8_t * buf, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin);
+    uint8_t createHeader(uint8_t * buf, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin, bool rsv1 = false);
+    static void maskPayload(uint8_t * data, size_t length, const uint8_t maskKey[4], size_t offset = 0);
     bool sendFrameHeader(WSclient_t * client, WSopcode_t opcode, size_t length = 0, bool fin = true);
     bool sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * payload = NULL, size_t length = 0, bool fin = true, bool headerToPayload = false);
 
+    WSsharedFrame_t * createSharedFrame(WSopcode_t opcode, uint8_t * payload, size_t length, bool fin = true, bool headerToPayload = false, bool rsv1 = false);
+    WSsharedFrame_t * retainSharedFrame(WSsharedFrame_t * frame);
+    void releaseSharedFrame(WSsharedFrame_t * frame);
+    bool sendSharedFrame(WSclient_t * client, WSsharedFrame_t * frame);
+    bool detachSharedFrame(WSsharedFrame_t * frame);
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    bool queueFrame(WSclient_t * client, WSsharedFrame_t * frame);
+    bool dropQueuedFrame(WSclient_t * client);
+    void flushQueue(WSclient_t * client);
+    void clearQueue(WSclient_t * client);
+    size_t writeSome(WSclient_t * client, const uint8_t * out, size_t n);
+#endif
+
     void headerDone(WSclient_t * client);
 
     void handleWebsocket(WSclient_t * client);
+    void handleWebsocketTimeout(WSclient_t * client);
+    void clearWebsocketRX(WSclient_t * client);
 
     bool handleWebsocketWaitFor(WSclient_t * client, size_t size);
     void handleWebsocketCb(WSclient_t * client);
     void handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t * payload);
+#ifdef WEBSOCKETS_USE_DEFLATE
+    void handleDeflatePayload(WSclient_t * client, uint8_t * payload);
+#endif
 
     String acceptKey(String & clientKey);
+    void acceptKey(const char * clientKey, size_t len, char * out);
     String base64_encode(uint8_t * data, size_t length);
 
     bool readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWaitCb cb);
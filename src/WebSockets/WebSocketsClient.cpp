@@ -447,6 +447,8 @@ void WebSocketsClient::clientDisconnect(WSclient_t * client) {
     client->cIsWebsocket = false;
     client->cSessionId   = "";
 
+    clearWebsocketRX(client);
+
     client->status = WSC_NOT_CONNECTED;
 
     //DEBUG_WEBSOCKETS("[WS-Client] client disconnected.\n");
@@ -505,6 +507,7 @@ void WebSocketsClient::handleClientData(void) {
                 break;
         }
     }
+    handleWebsocketTimeout(&_client);
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
     delay(0);
 #endif
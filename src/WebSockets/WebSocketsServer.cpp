@@ -25,7 +25,7 @@
 #include "WebSockets.h"
 #include "WebSocketsServer.h"
 
-WebSocketsServer::WebSocketsServer(uint16_t port, String origin, String protocol) {
+WebSocketsServer::WebSocketsServer(uint16_t port, String origin, String protocol, uint8_t clientMax) {
     _port     = port;
     _origin   = origin;
     _protocol = protocol;
@@ -49,7 +49,16 @@ WebSocketsServer::WebSocketsServer(uint16_t port, String origin, String protocol
     _mandatoryHttpHeaders     = NULL;
     _mandatoryHttpHeaderCount = 0;
 
-    memset(&_clients[0], 0x00, (sizeof(WSclient_t) * WEBSOCKETS_SERVER_CLIENT_MAX));
+    _clients     = NULL;
+    _active      = NULL;
+    _clientMax   = 0;
+    _activeCount = 0;
+
+#if defined(ESP32)
+    _lock = xSemaphoreCreateRecursiveMutex();
+#endif
+
+    setClientMax(clientMax);
 }
 
 WebSocketsServer::~WebSocketsServer() {
@@ -60,45 +69,19 @@ WebSocketsServer::~WebSocketsServer() {
         delete[] _mandatoryHttpHeaders;
 
     _mandatoryHttpHeaderCount = 0;
+
+    freeClients();
+
+#if defined(ESP32)
+    vSemaphoreDelete(_lock);
+#endif
 }
 
 /**
  * called to initialize the Websocket server
  */
 void WebSocketsServer::begin(void) {
-    WSclient_t * client;
-
-    // init client storage
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
-
-        client->num    = i;
-        client->status = WSC_NOT_CONNECTED;
-        client->tcp    = NULL;
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
-        client->isSSL = false;
-        client->ssl   = NULL;
-#endif
-        client->cUrl         = "";
-        client->cCode        = 0;
-        client->cKey         = "";
-        client->cProtocol    = "";
-        client->cVersion     = 0;
-        client->cIsUpgrade   = false;
-        client->cIsWebsocket = false;
-
-        client->base64Authorization = "";
-
-        client->cWsRXsize = 0;
-
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-        client->cHttpLine = "";
-#endif
-
-        client->pingInterval = _pingInterval;
-        client->pongTimeout  = _pongTimeout;
-        client->disconnectTimeoutCount = _disconnectTimeoutCount;
-    }
+    // the client structs are allocated and initialized in newClient
 
 #ifdef ESP8266
     randomSeed(RANDOM_REG32);
@@ -135,8 +118,10 @@ void WebSocketsServer::close(void) {
  */
 void WebSocketsServer::loop(void) {
     if(_runnning) {
+        lock();
         handleNewClients();
         handleClientData();
+        unlock();
     }
 }
 #endif
@@ -181,17 +166,10 @@ void WebSocketsServer::onValidateHttpHeader(
  * @return true if ok
  */
 bool WebSocketsServer::sendTXT(uint8_t num, uint8_t * payload, size_t length, bool headerToPayload) {
-    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
-        return false;
-    }
     if(length == 0) {
         length = strlen((const char *)payload);
     }
-    WSclient_t * client = &_clients[num];
-    if(clientIsConnected(client)) {
-        return sendFrame(client, WSop_text, payload, length, true, headerToPayload);
-    }
-    return false;
+    return sendMessage(num, WSop_text, payload, length, headerToPayload);
 }
 
 bool WebSocketsServer::sendTXT(uint8_t num, const uint8_t * payload, size_t length) {
@@ -218,24 +196,10 @@ bool WebSocketsServer::sendTXT(uint8_t num, String & payload) {
  * @return true if ok
  */
 bool WebSocketsServer::broadcastTXT(uint8_t * payload, size_t length, bool headerToPayload) {
-    WSclient_t * client;
-    bool ret = true;
     if(length == 0) {
         length = strlen((const char *)payload);
     }
-
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
-        if(clientIsConnected(client)) {
-            if(!sendFrame(client, WSop_text, payload, length, true, headerToPayload)) {
-                ret = false;
-            }
-        }
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
-        delay(0);
-#endif
-    }
-    return ret;
+    return broadcastFrame(WSop_text, payload, length, headerToPayload);
 }
 
 bool WebSocketsServer::broadcastTXT(const uint8_t * payload, size_t length) {
@@ -255,42 +219,85 @@ bool WebSocketsServer::broadcastTXT(String & payload) {
 }
 
 /**
- * send binary data to client
+ * send the text or binary message to the client
  * @param num uint8_t client id
+ * @param opcode WSopcode_t
  * @param payload uint8_t *
  * @param length size_t
  * @param headerToPayload bool  (see sendFrame for more details)
  * @return true if ok
  */
-bool WebSocketsServer::sendBIN(uint8_t num, uint8_t * payload, size_t length, bool headerToPayload) {
-    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
-        return false;
-    }
-    WSclient_t * client = &_clients[num];
-    if(clientIsConnected(client)) {
-        return sendFrame(client, WSop_binary, payload, length, true, headerToPayload);
+bool WebSocketsServer::sendMessage(uint8_t num, WSopcode_t opcode, uint8_t * payload, size_t length, bool headerToPayload) {
+    lock();
+    bool ret            = false;
+    WSclient_t * client = getClient(num);
+    if(client && clientIsConnected(client)) {
+        WSsharedFrame_t * frame = NULL;
+#ifdef WEBSOCKETS_USE_DEFLATE
+        if(client->cDeflate) {
+            frame = createDeflateFrame(opcode, payload + (headerToPayload ? WEBSOCKETS_MAX_HEADER_SIZE : 0), length);
+        }
+#endif
+        if(frame) {
+            ret = sendSharedFrame(client, frame);
+            releaseSharedFrame(frame);
+        } else {
+            ret = sendFrame(client, opcode, payload, length, true, headerToPayload);
+        }
     }
-    return false;
-}
-
-bool WebSocketsServer::sendBIN(uint8_t num, const uint8_t * payload, size_t length) {
-    return sendBIN(num, (uint8_t *)payload, length);
+    // the key only applies to this message
+    _messageKey = 0;
+    unlock();
+    return ret;
 }
 
 /**
- * send binary data to client all
+ * send the frame to all connected clients, the frame is encoded once and the same bytes are written to every client
+ * @param opcode WSopcode_t
  * @param payload uint8_t *
  * @param length size_t
  * @param headerToPayload bool  (see sendFrame for more details)
  * @return true if ok
  */
-bool WebSocketsServer::broadcastBIN(uint8_t * payload, size_t length, bool headerToPayload) {
+bool WebSocketsServer::broadcastFrame(WSopcode_t opcode, uint8_t * payload, size_t length, bool headerToPayload) {
     WSclient_t * client;
-    bool ret = true;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
-        if(clientIsConnected(client)) {
-            if(!sendFrame(client, WSop_binary, payload, length, true, headerToPayload)) {
+    bool ret                = true;
+    WSsharedFrame_t * frame = NULL;
+#ifdef WEBSOCKETS_USE_DEFLATE
+    WSsharedFrame_t * deflated = NULL;
+    bool deflateTried          = (opcode != WSop_text && opcode != WSop_binary);
+#endif
+
+    lock();
+    int num = -1;
+    while((client = nextActiveClient(num)) != NULL) {
+        bool sent = false;
+#ifdef WEBSOCKETS_USE_DEFLATE
+        if(client->cDeflate && clientIsConnected(client)) {
+            // compress once on the first client with permessage-deflate
+            if(!deflateTried) {
+                deflated     = createDeflateFrame(opcode, payload + (headerToPayload ? WEBSOCKETS_MAX_HEADER_SIZE : 0), length);
+                deflateTried = true;
+            }
+            if(deflated) {
+                if(!sendSharedFrame(client, deflated)) {
+                    ret = false;
+                }
+                sent = true;
+            }
+        }
+#endif
+        if(!sent && clientIsConnected(client)) {
+            // encode on the first connected client
+            if(!frame) {
+                frame = createSharedFrame(opcode, payload, length, true, headerToPayload);
+            }
+
+            if(frame) {
+                if(!sendSharedFrame(client, frame)) {
+                    ret = false;
+                }
+            } else if(!sendFrame(client, opcode, payload, length, true, headerToPayload)) {
                 ret = false;
             }
         }
@@ -298,9 +305,72 @@ bool WebSocketsServer::broadcastBIN(uint8_t * payload, size_t length, bool heade
         delay(0);
 #endif
     }
+
+    releaseSharedFrame(frame);
+#ifdef WEBSOCKETS_USE_DEFLATE
+    releaseSharedFrame(deflated);
+#endif
+    _messageKey = 0;
+    unlock();
     return ret;
 }
 
+#ifdef WEBSOCKETS_USE_DEFLATE
+/**
+ * compress the message for the clients with permessage-deflate
+ * @param opcode WSopcode_t
+ * @param payload uint8_t *
+ * @param length size_t
+ * @return the shared frame with RSV1 set or NULL when the message is too small, does not get smaller or out of memory
+ */
+WSsharedFrame_t * WebSocketsServer::createDeflateFrame(WSopcode_t opcode, uint8_t * payload, size_t length) {
+    if(!_deflate || length < WEBSOCKETS_DEFLATE_MIN_SIZE) {
+        return NULL;
+    }
+
+    _deflateBuf.clear();
+    if(!_deflater.compress(payload, length, _deflateBuf, mb_deflate_format_raw)) {
+        return NULL;
+    }
+
+    // the final block is followed by the empty byte so the receiver can append 00 00 ff ff (RFC 7692 7.2.3.3)
+    _deflateBuf.push_back(0x00);
+
+    if(_deflateBuf.size() >= length) {
+        return NULL;
+    }
+
+    return createSharedFrame(opcode, _deflateBuf.data(), _deflateBuf.size(), true, false, true);
+}
+#endif
+
+/**
+ * send binary data to client
+ * @param num uint8_t client id
+ * @param payload uint8_t *
+ * @param length size_t
+ * @param headerToPayload bool  (see sendFrame for more details)
+ * @return true if ok
+ */
+bool WebSocketsServer::sendBIN(uint8_t num, uint8_t * payload, size_t length, bool headerToPayload) {
+    return sendMessage(num, WSop_binary, payload, length, headerToPayload);
+}
+
+bool WebSocketsServer::sendBIN(uint8_t num, const uint8_t * payload, size_t length) {
+    return sendBIN(num, (uint8_t *)payload, length);
+}
+
+/**
+ * send binary data to client all
+ * @param payload uint8_t *
+ * @param length size_t
+ * @param headerToPayload bool  (see sendFrame for more details)
+ * @return true if ok
+ */
+bool WebSocketsServer::broadcastBIN(uint8_t * payload, size_t length, bool headerToPayload) {
+    return broadcastFrame(WSop_binary, payload, length, headerToPayload);
+}
+
 bool WebSocketsServer::broadcastBIN(const uint8_t * payload, size_t length) {
     return broadcastBIN((uint8_t *)payload, length);
 }
@@ -313,14 +383,14 @@ bool WebSocketsServer::broadcastBIN(const uint8_t * payload, size_t length) {
  * @return true if ping is send out
  */
 bool WebSocketsServer::sendPing(uint8_t num, uint8_t * payload, size_t length) {
-    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
-        return false;
-    }
-    WSclient_t * client = &_clients[num];
-    if(clientIsConnected(client)) {
-        return sendFrame(client, WSop_ping, payload, length);
+    lock();
+    bool ret            = false;
+    WSclient_t * client = getClient(num);
+    if(client && clientIsConnected(client)) {
+        ret = sendFrame(client, WSop_ping, payload, length);
     }
-    return false;
+    unlock();
+    return ret;
 }
 
 bool WebSocketsServer::sendPing(uint8_t num, String & payload) {
@@ -334,20 +404,7 @@ bool WebSocketsServer::sendPing(uint8_t num, String & payload) {
  * @return true if ping is send out
  */
 bool WebSocketsServer::broadcastPing(uint8_t * payload, size_t length) {
-    WSclient_t * client;
-    bool ret = true;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
-        if(clientIsConnected(client)) {
-            if(!sendFrame(client, WSop_ping, payload, length)) {
-                ret = false;
-            }
-        }
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266)
-        delay(0);
-#endif
-    }
-    return ret;
+    return broadcastFrame(WSop_ping, payload, length);
 }
 
 bool WebSocketsServer::broadcastPing(String & payload) {
@@ -359,12 +416,14 @@ bool WebSocketsServer::broadcastPing(String & payload) {
  */
 void WebSocketsServer::disconnect(void) {
     WSclient_t * client;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
+    lock();
+    int num = -1;
+    while((client = nextActiveClient(num)) != NULL) {
         if(clientIsConnected(client)) {
             WebSockets::clientDisconnect(client, 1000);
         }
     }
+    unlock();
 }
 
 /**
@@ -372,13 +431,12 @@ void WebSocketsServer::disconnect(void) {
  * @param num uint8_t client id
  */
 void WebSocketsServer::disconnect(uint8_t num) {
-    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
-        return;
-    }
-    WSclient_t * client = &_clients[num];
-    if(clientIsConnected(client)) {
+    lock();
+    WSclient_t * client = getClient(num);
+    if(client && clientIsConnected(client)) {
         WebSockets::clientDisconnect(client, 1000);
     }
+    unlock();
 }
 
 /*
@@ -412,17 +470,162 @@ void WebSocketsServer::setAuthorization(const char * auth) {
 int WebSocketsServer::connectedClients(bool ping) {
     WSclient_t * client;
     int count = 0;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
+    lock();
+    int num = -1;
+    while((client = nextActiveClient(num)) != NULL) {
         if(client->status == WSC_CONNECTED) {
-            if(ping != true || sendPing(i)) {
+            if(ping != true || sendPing(client->num)) {
                 count++;
             }
         }
     }
+    unlock();
     return count;
 }
 
+/**
+ * set the number of client slots, only possible while no client is connected
+ * @param clientMax uint8_t  the slot is only a pointer until its first client connects
+ * @return true if ok
+ */
+bool WebSocketsServer::setClientMax(uint8_t clientMax) {
+    if(_activeCount > 0 || clientMax == 0) {
+        return false;
+    }
+
+    freeClients();
+
+    _clients = (WSclient_t **)calloc(clientMax, sizeof(WSclient_t *));
+    _active  = (uint8_t *)malloc(clientMax);
+
+    if(!_clients || !_active) {
+        freeClients();
+        return false;
+    }
+
+    _clientMax = clientMax;
+    return true;
+}
+
+/**
+ * get the number of client slots
+ * @return uint8_t
+ */
+uint8_t WebSocketsServer::getClientMax(void) {
+    return _clientMax;
+}
+
+/**
+ * get the frame buffer pool statistics
+ * @param sizeClass uint8_t  0 - (WEBSOCKETS_POOL_CLASSES - 1) or WEBSOCKETS_POOL_CLASSES for the oversized buffers
+ * @param stats WSbufferPoolStats_t *
+ * @return false if the size class is out of range
+ */
+bool WebSocketsServer::getBufferPoolStats(uint8_t sizeClass, WSbufferPoolStats_t * stats) {
+    lock();
+    bool ret = _pool.getStats(sizeClass, stats);
+    unlock();
+    return ret;
+}
+
+/**
+ * deliver the frames larger than WEBSOCKETS_MAX_DATA_SIZE in chunks instead of refusing them (close code 1009),
+ * the chunks are the WStype_FRAGMENT_* events, only available without NETWORK_ESP8266_ASYNC
+ * @param size size_t  the chunk size, 0 to refuse the large frames (default)
+ */
+void WebSocketsServer::setStreamChunkSize(size_t size) {
+    _streamChunkSize = size;
+}
+
+#ifdef WEBSOCKETS_USE_DEFLATE
+/**
+ * offer permessage-deflate (RFC 7692) to the new clients, the compressed client messages are inflated,
+ * the context is never kept (server_no_context_takeover, client_no_context_takeover)
+ * @param enable bool
+ * @param windowBits uint8_t  the compressor window size in bits, 9 - MB_DEFLATE_WINDOW_BITS
+ */
+void WebSocketsServer::setDeflate(bool enable, uint8_t windowBits) {
+    _deflate = enable;
+    _deflater.setWindowBits(windowBits);
+    if(!enable) {
+        _deflater.release();
+        std::vector<uint8_t>().swap(_deflateBuf);
+    }
+}
+#endif
+
+/**
+ * give the cached frame buffers back to the heap
+ */
+void WebSocketsServer::trimBufferPool(void) {
+    lock();
+    _pool.trim();
+    unlock();
+}
+
+/**
+ * take the server lock, on ESP32 the loop and the send calls of the other tasks hold it while they use the clients,
+ * the send queues and the buffer pool, the lock is recursive and the event callbacks run with it held
+ * lock it to keep the calls together, e.g. setMessageKey and the send call of that key
+ */
+void WebSocketsServer::lock(void) {
+#if defined(ESP32)
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+#endif
+}
+
+/**
+ * give back the server lock taken by lock
+ */
+void WebSocketsServer::unlock(void) {
+#if defined(ESP32)
+    xSemaphoreGiveRecursive(_lock);
+#endif
+}
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+/**
+ * set the limit of the per client send queue, the messages the socket can not take at once are queued
+ * and written from the loop, the single message larger than the limit is still queued when the queue is empty
+ * @param maxBytes size_t  the queued bytes per client before the policy applies
+ * @param policy WSqueuePolicy_t  what happens to the message that does not fit
+ */
+void WebSocketsServer::setSendQueue(size_t maxBytes, WSqueuePolicy_t policy) {
+    _queueBytes  = maxBytes;
+    _queuePolicy = policy;
+}
+
+/**
+ * get the send queue depth and overflow counts of the client
+ * @param num uint8_t client id
+ * @param stats WSqueueStats_t *
+ * @return true if ok
+ */
+bool WebSocketsServer::getSendQueueStats(uint8_t num, WSqueueStats_t * stats) {
+    WSclient_t * client = getClient(num);
+    if(!client || !stats) {
+        return false;
+    }
+    lock();
+    stats->frames    = client->cTxCount;
+    stats->highWater = client->cTxHighWater;
+    stats->bytes     = client->cTxBytes - client->cTxSent;
+    stats->dropped   = client->cTxDropped;
+    stats->coalesced = client->cTxCoalesced;
+    unlock();
+    return true;
+}
+
+/**
+ * set the coalescing key of the next text or binary message (sendTXT, sendBIN or broadcast),
+ * with WSqueue_coalesce the queued message of the same key is replaced instead of sending both
+ * @param key uint32_t  0 for none
+ */
+void WebSocketsServer::setMessageKey(uint32_t key) {
+    _messageKey = key;
+}
+#endif
+
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
 /**
  * get an IP for a client
@@ -430,14 +633,14 @@ int WebSocketsServer::connectedClients(bool ping) {
  * @return IPAddress
  */
 IPAddress WebSocketsServer::remoteIP(uint8_t num) {
-    if(num < WEBSOCKETS_SERVER_CLIENT_MAX) {
-        WSclient_t * client = &_clients[num];
-        if(clientIsConnected(client)) {
-            return client->tcp->remoteIP();
-        }
+    IPAddress ip;
+    lock();
+    WSclient_t * client = getClient(num);
+    if(client && clientIsConnected(client)) {
+        ip = client->tcp->remoteIP();
     }
-
-    return IPAddress();
+    unlock();
+    return ip;
 }
 #endif
 
@@ -445,19 +648,176 @@ IPAddress WebSocketsServer::remoteIP(uint8_t num) {
 //#################################################################################
 //#################################################################################
 
+/**
+ * get the client struct
+ * @param num uint8_t client id
+ * @return the client or NULL if the slot was never used
+ */
+WSclient_t * WebSocketsServer::getClient(uint8_t num) {
+    if(num >= _clientMax) {
+        return NULL;
+    }
+    return _clients[num];
+}
+
+/**
+ * allocate and initialize the client struct of the slot
+ * @param num uint8_t client id
+ * @return the client or NULL when out of memory
+ */
+WSclient_t * WebSocketsServer::allocClient(uint8_t num) {
+    void * ptr;
+#if defined(BOARD_HAS_PSRAM) && defined(WEBSOCKETS_USE_PSRAM)
+    if(ESP.getPsramSize() > 0)
+        ptr = ps_malloc(sizeof(WSclient_t));
+    else
+        ptr = malloc(sizeof(WSclient_t));
+#else
+    ptr = malloc(sizeof(WSclient_t));
+#endif
+    if(!ptr) {
+        return NULL;
+    }
+
+    WSclient_t * client = new(ptr) WSclient_t();
+
+    client->num    = num;
+    client->status = WSC_NOT_CONNECTED;
+    client->tcp    = NULL;
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
+    client->isSSL = false;
+    client->ssl   = NULL;
+#endif
+    client->cCode        = 0;
+    client->cVersion     = 0;
+    client->cIsUpgrade   = false;
+    client->cIsWebsocket = false;
+    client->cWsRXsize    = 0;
+
+    client->pingInterval           = _pingInterval;
+    client->pongTimeout            = _pongTimeout;
+    client->disconnectTimeoutCount = _disconnectTimeoutCount;
+
+    _clients[num] = client;
+    return client;
+}
+
+/**
+ * free all client structs and the slot tables, the clients should be disconnected
+ */
+void WebSocketsServer::freeClients(void) {
+    for(uint8_t i = 0; _clients && i < _clientMax; i++) {
+        if(_clients[i]) {
+            clearWebsocketRX(_clients[i]);
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+            clearQueue(_clients[i]);
+#endif
+            _clients[i]->~WSclient_t();
+            free(_clients[i]);
+        }
+    }
+
+    free(_clients);
+    free(_active);
+    _clients     = NULL;
+    _active      = NULL;
+    _clientMax   = 0;
+    _activeCount = 0;
+}
+
+/**
+ * add the client to the active list
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSocketsServer::activateClient(WSclient_t * client) {
+    uint8_t k = 0;
+    while(k < _activeCount && _active[k] < client->num) {
+        k++;
+    }
+
+    if(k < _activeCount && _active[k] == client->num) {
+        return;
+    }
+
+    memmove(&_active[k + 1], &_active[k], _activeCount - k);
+    _active[k] = client->num;
+    _activeCount++;
+}
+
+/**
+ * remove the client from the active list
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSocketsServer::deactivateClient(WSclient_t * client) {
+    for(uint8_t k = 0; k < _activeCount; k++) {
+        if(_active[k] == client->num) {
+            memmove(&_active[k], &_active[k + 1], _activeCount - k - 1);
+            _activeCount--;
+            return;
+        }
+    }
+}
+
+/**
+ * get the next client of the active list in slot order
+ * the loops over the clients use this since the callbacks may connect or disconnect the other clients,
+ * the list is searched again on every call and no client is skipped or visited twice
+ * @param num int &  number of the last visited client, -1 to start, set to the returned client number
+ * @return the client or NULL at the end of the list
+ */
+WSclient_t * WebSocketsServer::nextActiveClient(int & num) {
+    for(uint8_t k = 0; k < _activeCount; k++) {
+        if(_active[k] > num) {
+            num = _active[k];
+            return _clients[num];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * free the String buffers which are only used while handling the http header
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSocketsServer::clearHandshake(WSclient_t * client) {
+    // assign NULL to release the buffer, assigning "" keeps it
+    client->cUrl                = (const char *)NULL;
+    client->cKey                = (const char *)NULL;
+    client->cProtocol           = (const char *)NULL;
+    client->cExtensions         = (const char *)NULL;
+    client->base64Authorization = (const char *)NULL;
+    client->cVersion            = 0;
+    client->cIsUpgrade          = false;
+    client->cIsWebsocket        = false;
+}
+
 /**
  * handle new client connection
  * @param client
  */
 bool WebSocketsServer::newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient) {
     WSclient_t * client;
+
+    if(_activeCount >= _clientMax) {
+        return false;
+    }
+
     // search free list entry for client
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
+    for(uint8_t i = 0; i < _clientMax; i++) {
+        client = _clients[i];
+
+        // the slot was never used
+        if(!client) {
+            client = allocClient(i);
+            if(!client) {
+                return false;
+            }
+        }
 
         // state is not connected or tcp connection is lost
         if(!clientIsConnected(client)) {
             client->tcp = TCPclient;
+            activateClient(client);
 
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
             client->isSSL = false;
@@ -466,6 +826,9 @@ bool WebSocketsServer::newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient) {
 #if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
             // set Timeout for readBytesUntil and readStringUntil
             client->tcp->setTimeout(WEBSOCKETS_TCP_TIMEOUT);
+            client->cHttpBufLen       = 0;
+            client->cHttpBufTruncated = false;
+            client->cWsRXlast         = millis();
 #endif
             client->status = WSC_HEADER;
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC) || (WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP32)
@@ -481,10 +844,11 @@ bool WebSocketsServer::newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient) {
             client->tcp->onDisconnect(std::bind([](WebSocketsServer * server, AsyncTCPbuffer * obj, WSclient_t * client) -> bool {
                 //DEBUG_WEBSOCKETS("[WS-Server][%d] Disconnect client\n", client->num);
 
-                AsyncTCPbuffer ** sl = &server->_clients[client->num].tcp;
+                AsyncTCPbuffer ** sl = &server->_clients[client->num]->tcp;
                 if(*sl == obj) {
                     client->status = WSC_NOT_CONNECTED;
                     *sl            = NULL;
+                    server->deactivateClient(client);
                 }
                 return true;
             },
@@ -572,14 +936,18 @@ void WebSocketsServer::clientDisconnect(WSclient_t * client) {
         client->tcp = NULL;
     }
 
-    client->cUrl         = "";
-    client->cKey         = "";
-    client->cProtocol    = "";
-    client->cVersion     = 0;
-    client->cIsUpgrade   = false;
-    client->cIsWebsocket = false;
+    deactivateClient(client);
+    clearHandshake(client);
 
-    client->cWsRXsize = 0;
+    clearWebsocketRX(client);
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    clearQueue(client);
+#endif
+
+#ifdef WEBSOCKETS_USE_DEFLATE
+    client->cDeflate = false;
+#endif
 
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     client->cHttpLine = "";
@@ -671,17 +1039,16 @@ void WebSocketsServer::handleNewClients(void) {
  */
 void WebSocketsServer::handleClientData(void) {
     WSclient_t * client;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
+    int num = -1;
+    while((client = nextActiveClient(num)) != NULL) {
         if(clientIsConnected(client)) {
             int len = client->tcp->available();
             if(len > 0) {
                 ////DEBUG_WEBSOCKETS("[WS-Server][%d][handleClientData] len: %d\n", client->num, len);
                 switch(client->status) {
-                    case WSC_HEADER: {
-                        String headerLine = client->tcp->readStringUntil('\n');
-                        handleHeader(client, &headerLine);
-                    } break;
+                    case WSC_HEADER:
+                        handleHeaderData(client);
+                        break;
                     case WSC_CONNECTED:
                         WebSockets::handleWebsocket(client);
                         break;
@@ -690,7 +1057,24 @@ void WebSocketsServer::handleClientData(void) {
                         break;
                 }
             }
-            
+
+            // the handshake must complete within the tcp timeout
+            if(client->status == WSC_HEADER && (millis() - client->cWsRXlast) > WEBSOCKETS_TCP_TIMEOUT) {
+                //DEBUG_WEBSOCKETS("[WS-Server][%d] handshake timeout\n", client->num);
+                clientDisconnect(client);
+                continue;
+            }
+
+            // the queue overflowed with the disconnect policy or a partly written frame could not be queued
+            if(client->cTxOverflow) {
+                //DEBUG_WEBSOCKETS("[WS-Server][%d] send queue overflow\n", client->num);
+                clientDisconnect(client);
+                continue;
+            }
+
+            flushQueue(client);
+
+            handleWebsocketTimeout(client);
             handleHBPing(client);
             handleHBTimeout(client);
         }
@@ -701,13 +1085,133 @@ void WebSocketsServer::handleClientData(void) {
 }
 #endif
 
+static const char WEBSOCKETS_HANDSHAKE_101[] PROGMEM =
+    "HTTP/1.1 101 Switching Protocols\r\n"
+    "Server: arduino-WebSocketsServer\r\n"
+    "Upgrade: websocket\r\n"
+    "Connection: Upgrade\r\n"
+    "Sec-WebSocket-Version: 13\r\n"
+    "Sec-WebSocket-Accept: ";
+static const char WEBSOCKETS_HANDSHAKE_ORIGIN[] PROGMEM   = "Access-Control-Allow-Origin: ";
+static const char WEBSOCKETS_HANDSHAKE_PROTOCOL[] PROGMEM = "Sec-WebSocket-Protocol: ";
+#ifdef WEBSOCKETS_USE_DEFLATE
+static const char WEBSOCKETS_HANDSHAKE_DEFLATE[] PROGMEM = "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; client_no_context_takeover";
+#endif
+
+/*
+ * case insensitive compare of the not null terminated header name
+ * @param name const char * ///< the header name
+ * @param len size_t ///< length of the header name
+ * @param match PGM_P ///< the expected header name
+ */
+static bool headerNameIs(const char * name, size_t len, PGM_P match) {
+    return len == strlen_P(match) && strncasecmp_P(name, match, len) == 0;
+}
+
+/*
+ * case insensitive search of the token in the null terminated header value
+ */
+static bool headerValueHas(const char * value, PGM_P token) {
+    size_t len = strlen_P(token);
+    for(; *value; value++) {
+        if(strncasecmp_P(value, token, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef WEBSOCKETS_USE_DEFLATE
+/*
+ * get the next ; separated item of the extension offer, trimmed
+ */
+static const char * nextExtensionItem(const char * p, const char * end, const char ** item, size_t * len) {
+    while(p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    const char * start = p;
+    while(p < end && *p != ';') {
+        p++;
+    }
+    const char * last = p;
+    while(last > start && (last[-1] == ' ' || last[-1] == '\t')) {
+        last--;
+    }
+    *item = start;
+    *len  = last - start;
+    return p < end ? p + 1 : p;
+}
+
+/*
+ * find the acceptable permessage-deflate offer in the Sec-WebSocket-Extensions value (RFC 7692 7.1)
+ * @param ext const char * ///< the extension offers
+ * @param windowBits uint8_t ///< the compressor window size in bits
+ * @param withBits bool * ///< set when the offer has server_max_window_bits, the response must include it
+ */
+static bool acceptDeflateOffer(const char * ext, uint8_t windowBits, bool * withBits) {
+    const char * p = ext;
+
+    while(*p) {
+        const char * end = strchr(p, ',');
+        if(!end) {
+            end = p + strlen(p);
+        }
+
+        const char * item;
+        size_t len;
+        const char * q = nextExtensionItem(p, end, &item, &len);
+        bool ok        = headerNameIs(item, len, PSTR("permessage-deflate"));
+
+        *withBits = false;
+
+        while(ok && q < end) {
+            q = nextExtensionItem(q, end, &item, &len);
+
+            const char * eq = (const char *)memchr(item, '=', len);
+            size_t nameLen  = eq ? (size_t)(eq - item) : len;
+            while(nameLen > 0 && item[nameLen - 1] == ' ') {
+                nameLen--;
+            }
+
+            if(len == 0 || headerNameIs(item, nameLen, PSTR("server_no_context_takeover")) || headerNameIs(item, nameLen, PSTR("client_no_context_takeover")) || headerNameIs(item, nameLen, PSTR("client_max_window_bits"))) {
+                // the context is never kept, the client window is not limited by the flat inflate buffer
+                continue;
+            }
+
+            if(headerNameIs(item, nameLen, PSTR("server_max_window_bits")) && eq) {
+                const char * v = eq + 1;
+                while(*v == ' ' || *v == '"') {
+                    v++;
+                }
+                int bits = atoi(v);
+                // the compressor window can not be made smaller than the configured one
+                ok        = (bits >= windowBits && bits <= 15);
+                *withBits = true;
+                continue;
+            }
+
+            // the unknown parameter, decline the offer
+            ok = false;
+        }
+
+        if(ok) {
+            return true;
+        }
+
+        p = *end ? end + 1 : end;
+    }
+
+    return false;
+}
+#endif
+
 /*
  * returns an indicator whether the given named header exists in the configured _mandatoryHttpHeaders collection
- * @param headerName String ///< the name of the header being checked
+ * @param headerName const char * ///< the name of the header being checked
  */
-bool WebSocketsServer::hasMandatoryHeader(String headerName) {
+bool WebSocketsServer::hasMandatoryHeader(const char * headerName) {
     for(size_t i = 0; i < _mandatoryHttpHeaderCount; i++) {
-        if(_mandatoryHttpHeaders[i].equalsIgnoreCase(headerName))
+        if(strcasecmp(_mandatoryHttpHeaders[i].c_str(), headerName) == 0)
             return true;
     }
     return false;
@@ -719,156 +1223,322 @@ bool WebSocketsServer::hasMandatoryHeader(String headerName) {
  * @param headerLine String ///< the header being read / processed
  */
 void WebSocketsServer::handleHeader(WSclient_t * client, String * headerLine) {
-    static const char * NEW_LINE = "\r\n";
+    if(handleHeaderLine(client, (char *)headerLine->c_str(), headerLine->length())) {
+        (*headerLine) = "";
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
+        client->tcp->readStringUntil('\n', &(client->cHttpLine), std::bind(&WebSocketsServer::handleHeader, this, client, &(client->cHttpLine)));
+#endif
+    }
+}
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+/**
+ * read the available http header bytes into the client line buffer
+ * and handle each complete line, never waits for more data
+ * @param client WSclient_t * ///< pointer to the client struct
+ */
+void WebSocketsServer::handleHeaderData(WSclient_t * client) {
+    while(client->status == WSC_HEADER && client->tcp && client->tcp->available() > 0) {
+        int c = client->tcp->read();
+        if(c < 0) {
+            break;
+        }
+
+        client->cWsRXlast = millis();
+
+        if(c != '\n') {
+            // the rest of too long line is dropped, handleHeaderLine decides whether the line was needed
+            if(client->cHttpBufLen < WEBSOCKETS_HTTP_LINE_SIZE - 1) {
+                client->cHttpBuf[client->cHttpBufLen++] = (char)c;
+            } else {
+                client->cHttpBufTruncated = true;
+            }
+            continue;
+        }
+
+        size_t len                = client->cHttpBufLen;
+        bool truncated            = client->cHttpBufTruncated;
+        client->cHttpBufLen       = 0;
+        client->cHttpBufTruncated = false;
+        handleHeaderLine(client, client->cHttpBuf, len, truncated);
+    }
+}
+#endif
+
+/**
+ * check whether the server reads the value of the header
+ * @param name const char * ///< the header name, not necessarily null terminated
+ * @param nameLen size_t ///< length of the name
+ * @return true when the value is used, its line must not be truncated
+ */
+bool WebSocketsServer::headerIsRead(const char * name, size_t nameLen) {
+    if(_httpHeaderValidationFunc || _mandatoryHttpHeaderCount > 0) {
+        return true;
+    }
+    return headerNameIs(name, nameLen, PSTR("Connection")) || headerNameIs(name, nameLen, PSTR("Upgrade"))
+        || headerNameIs(name, nameLen, PSTR("Sec-WebSocket-Version")) || headerNameIs(name, nameLen, PSTR("Sec-WebSocket-Key"))
+        || headerNameIs(name, nameLen, PSTR("Sec-WebSocket-Protocol")) || headerNameIs(name, nameLen, PSTR("Sec-WebSocket-Extensions"))
+        || headerNameIs(name, nameLen, PSTR("Authorization"));
+}
+
+/**
+ * handles a single http header line in place, the line is modified
+ * @param client WSclient_t * ///< pointer to the client struct
+ * @param line char * ///< the header line without \n, not necessarily null terminated
+ * @param len size_t ///< length of the line, the buffer must have space for the null terminator
+ * @param truncated bool ///< the rest of the line did not fit the buffer
+ * @return true when more header lines are expected, false at the end of the header
+ */
+bool WebSocketsServer::handleHeaderLine(WSclient_t * client, char * line, size_t len, bool truncated) {
+    if(truncated) {
+        // the request line or the header that is read can't be used in part, the other headers are skipped
+        const char * colon = (const char *)memchr(line, ':', len);
+        if(!colon || (len > 4 && memcmp(line, "GET ", 4) == 0) || headerIsRead(line, colon - line)) {
+            handleHeaderTooLarge(client);
+            return false;
+        }
+        return true;
+    }
+
+    // trim \r and spaces
+    while(len > 0 && isspace((uint8_t)line[len - 1])) {
+        len--;
+    }
+    while(len > 0 && isspace((uint8_t)*line)) {
+        line++;
+        len--;
+    }
+    line[len] = 0;
 
-    headerLine->trim();    // remove \r
+    if(len > 0) {
+        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] RX: %s\n", client->num, line);
 
-    if(headerLine->length() > 0) {
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] RX: %s\n", client->num, headerLine->c_str());
+        char * colon = (char *)memchr(line, ':', len);
 
         // websocket requests always start with GET see rfc6455
-        if(headerLine->startsWith("GET ")) {
+        if(len > 4 && memcmp(line, "GET ", 4) == 0) {
             // cut URL out
-            client->cUrl = headerLine->substring(4, headerLine->indexOf(' ', 4));
+            char * url = line + 4;
+            char * sp  = strchr(url, ' ');
+            if(sp) {
+                *sp = 0;
+            }
+            client->cUrl = url;
 
             //reset non-websocket http header validation state for this client
             client->cHttpHeadersValid      = true;
             client->cMandatoryHeadersCount = 0;
+#ifdef WEBSOCKETS_USE_DEFLATE
+            client->cDeflate = false;
+#endif
 
-        } else if(headerLine->indexOf(':') >= 0) {
-            String headerName  = headerLine->substring(0, headerLine->indexOf(':'));
-            String headerValue = headerLine->substring(headerLine->indexOf(':') + 1);
+        } else if(colon) {
+            char * name    = line;
+            size_t nameLen = colon - line;
+            char * value   = colon + 1;
 
             // remove space in the beginning (RFC2616)
-            if(headerValue[0] == ' ') {
-                headerValue.remove(0, 1);
+            while(*value == ' ' || *value == '\t') {
+                value++;
             }
 
-            if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Connection"))) {
-                headerValue.toLowerCase();
-                if(headerValue.indexOf(WEBSOCKETS_STRING("upgrade")) >= 0) {
+            if(headerNameIs(name, nameLen, PSTR("Connection"))) {
+                if(headerValueHas(value, PSTR("upgrade"))) {
                     client->cIsUpgrade = true;
                 }
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Upgrade"))) {
-                if(headerValue.equalsIgnoreCase(WEBSOCKETS_STRING("websocket"))) {
+            } else if(headerNameIs(name, nameLen, PSTR("Upgrade"))) {
+                if(strcasecmp_P(value, PSTR("websocket")) == 0) {
                     client->cIsWebsocket = true;
                 }
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Version"))) {
-                client->cVersion = headerValue.toInt();
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Key"))) {
-                client->cKey = headerValue;
-                client->cKey.trim();    // see rfc6455
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Protocol"))) {
-                client->cProtocol = headerValue;
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Sec-WebSocket-Extensions"))) {
-                client->cExtensions = headerValue;
-            } else if(headerName.equalsIgnoreCase(WEBSOCKETS_STRING("Authorization"))) {
-                client->base64Authorization = headerValue;
+            } else if(headerNameIs(name, nameLen, PSTR("Sec-WebSocket-Version"))) {
+                client->cVersion = atoi(value);
+            } else if(headerNameIs(name, nameLen, PSTR("Sec-WebSocket-Key"))) {
+                client->cKey = value;
+            } else if(headerNameIs(name, nameLen, PSTR("Sec-WebSocket-Protocol"))) {
+                client->cProtocol = value;
+            } else if(headerNameIs(name, nameLen, PSTR("Sec-WebSocket-Extensions"))) {
+                client->cExtensions = value;
+            } else if(headerNameIs(name, nameLen, PSTR("Authorization"))) {
+                // only kept when it will be checked
+                if(_base64Authorization.length() > 0) {
+                    client->base64Authorization = value;
+                }
             } else {
-                client->cHttpHeadersValid &= execHttpHeaderValidation(headerName, headerValue);
-                if(_mandatoryHttpHeaderCount > 0 && hasMandatoryHeader(headerName)) {
+                *colon = 0;
+                if(_httpHeaderValidationFunc) {
+                    client->cHttpHeadersValid &= execHttpHeaderValidation(String(name), String(value));
+                }
+                if(_mandatoryHttpHeaderCount > 0 && hasMandatoryHeader(name)) {
                     client->cMandatoryHeadersCount++;
                 }
             }
 
         } else {
-            //DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Header error (%s)\n", headerLine->c_str());
+            //DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Header error (%s)\n", line);
         }
 
-        (*headerLine) = "";
-#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
-        client->tcp->readStringUntil('\n', &(client->cHttpLine), std::bind(&WebSocketsServer::handleHeader, this, client, &(client->cHttpLine)));
-#endif
-    } else {
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] Header read fin.\n", client->num);
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cURL: %s\n", client->num, client->cUrl.c_str());
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cIsUpgrade: %d\n", client->num, client->cIsUpgrade);
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cIsWebsocket: %d\n", client->num, client->cIsWebsocket);
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cKey: %s\n", client->num, client->cKey.c_str());
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cProtocol: %s\n", client->num, client->cProtocol.c_str());
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cExtensions: %s\n", client->num, client->cExtensions.c_str());
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cVersion: %d\n", client->num, client->cVersion);
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - base64Authorization: %s\n", client->num, client->base64Authorization.c_str());
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cHttpHeadersValid: %d\n", client->num, client->cHttpHeadersValid);
-        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cMandatoryHeadersCount: %d\n", client->num, client->cMandatoryHeadersCount);
-
-        bool ok = (client->cIsUpgrade && client->cIsWebsocket);
+        return true;
+    }
 
-        if(ok) {
-            if(client->cUrl.length() == 0) {
-                ok = false;
-            }
-            if(client->cKey.length() == 0) {
-                ok = false;
-            }
-            if(client->cVersion != 13) {
-                ok = false;
-            }
-            if(!client->cHttpHeadersValid) {
-                ok = false;
-            }
-            if(client->cMandatoryHeadersCount != _mandatoryHttpHeaderCount) {
-                ok = false;
-            }
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] Header read fin.\n", client->num);
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cURL: %s\n", client->num, client->cUrl.c_str());
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cIsUpgrade: %d\n", client->num, client->cIsUpgrade);
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cIsWebsocket: %d\n", client->num, client->cIsWebsocket);
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cKey: %s\n", client->num, client->cKey.c_str());
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cProtocol: %s\n", client->num, client->cProtocol.c_str());
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cExtensions: %s\n", client->num, client->cExtensions.c_str());
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cVersion: %d\n", client->num, client->cVersion);
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - base64Authorization: %s\n", client->num, client->base64Authorization.c_str());
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cHttpHeadersValid: %d\n", client->num, client->cHttpHeadersValid);
+    //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - cMandatoryHeadersCount: %d\n", client->num, client->cMandatoryHeadersCount);
+
+    bool ok = (client->cIsUpgrade && client->cIsWebsocket);
+
+    if(ok) {
+        if(client->cUrl.length() == 0) {
+            ok = false;
+        }
+        if(client->cKey.length() == 0 || client->cKey.length() > WEBSOCKETS_MAX_KEY_SIZE) {
+            ok = false;
         }
+        if(client->cVersion != 13) {
+            ok = false;
+        }
+        if(!client->cHttpHeadersValid) {
+            ok = false;
+        }
+        if(client->cMandatoryHeadersCount != _mandatoryHttpHeaderCount) {
+            ok = false;
+        }
+    }
 
-        if(_base64Authorization.length() > 0) {
-            String auth = WEBSOCKETS_STRING("Basic ");
-            auth += _base64Authorization;
-            if(auth != client->base64Authorization) {
-                //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] HTTP Authorization failed!\n", client->num);
-                handleAuthorizationFailed(client);
-                return;
-            }
+    if(_base64Authorization.length() > 0) {
+        const char * auth = client->base64Authorization.c_str();
+        if(strncmp_P(auth, PSTR("Basic "), 6) != 0 || strcmp(auth + 6, _base64Authorization.c_str()) != 0) {
+            //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] HTTP Authorization failed!\n", client->num);
+            handleAuthorizationFailed(client);
+            return false;
         }
+    }
 
-        if(ok) {
-            //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] Websocket connection incoming.\n", client->num);
+    if(ok) {
+        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] Websocket connection incoming.\n", client->num);
+
+        // generate Sec-WebSocket-Accept key
+        char sKey[WEBSOCKETS_ACCEPT_KEY_SIZE];
+        acceptKey(client->cKey.c_str(), client->cKey.length(), sKey);
 
-            // generate Sec-WebSocket-Accept key
-            String sKey = acceptKey(client->cKey);
+        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - sKey: %s\n", client->num, sKey);
 
-            //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader]  - sKey: %s\n", client->num, sKey.c_str());
+        client->status = WSC_CONNECTED;
 
-            client->status = WSC_CONNECTED;
+        // build the response in one buffer and send it with a single write
+        size_t startLen    = strlen_P(WEBSOCKETS_HANDSHAKE_101);
+        size_t originLen   = strlen_P(WEBSOCKETS_HANDSHAKE_ORIGIN);
+        size_t protocolLen = strlen_P(WEBSOCKETS_HANDSHAKE_PROTOCOL);
+        size_t keyLen      = strlen(sKey);
 
-            String handshake = WEBSOCKETS_STRING(
-                "HTTP/1.1 101 Switching Protocols\r\n"
-                "Server: arduino-WebSocketsServer\r\n"
-                "Upgrade: websocket\r\n"
-                "Connection: Upgrade\r\n"
-                "Sec-WebSocket-Version: 13\r\n"
-                "Sec-WebSocket-Accept: ");
-            handshake += sKey + NEW_LINE;
+        size_t size = startLen + keyLen + 4;
+        if(_origin.length() > 0) {
+            size += originLen + _origin.length() + 2;
+        }
+        if(client->cProtocol.length() > 0) {
+            size += protocolLen + _protocol.length() + 2;
+        }
 
-            if(_origin.length() > 0) {
-                handshake += WEBSOCKETS_STRING("Access-Control-Allow-Origin: ");
-                handshake += _origin + NEW_LINE;
+#ifdef WEBSOCKETS_USE_DEFLATE
+        // the server_max_window_bits parameter
+        char deflateBits[32] = { 0 };
+        size_t deflateLen    = 0;
+        bool withBits        = false;
+
+        client->cDeflate = _deflate && acceptDeflateOffer(client->cExtensions.c_str(), _deflater.windowBits(), &withBits);
+        if(client->cDeflate) {
+            if(withBits) {
+                snprintf(deflateBits, sizeof(deflateBits), "; server_max_window_bits=%u", _deflater.windowBits());
             }
+            deflateLen = strlen_P(WEBSOCKETS_HANDSHAKE_DEFLATE);
+            size += deflateLen + strlen(deflateBits) + 2;
+        }
+#endif
 
-            if(client->cProtocol.length() > 0) {
-                handshake += WEBSOCKETS_STRING("Sec-WebSocket-Protocol: ");
-                handshake += _protocol + NEW_LINE;
+        uint8_t stackBuf[256];
+        uint8_t * handshake = stackBuf;
+        if(size > sizeof(stackBuf)) {
+            handshake = (uint8_t *)malloc(size);
+            if(!handshake) {
+                //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] no memory for handshake\n", client->num);
+                clientDisconnect(client);
+                return false;
             }
+        }
 
-            // header end
-            handshake += NEW_LINE;
+        uint8_t * p = handshake;
+        memcpy_P(p, WEBSOCKETS_HANDSHAKE_101, startLen);
+        p += startLen;
+        memcpy(p, sKey, keyLen);
+        p += keyLen;
+        *p++ = '\r';
+        *p++ = '\n';
+
+        if(_origin.length() > 0) {
+            memcpy_P(p, WEBSOCKETS_HANDSHAKE_ORIGIN, originLen);
+            p += originLen;
+            memcpy(p, _origin.c_str(), _origin.length());
+            p += _origin.length();
+            *p++ = '\r';
+            *p++ = '\n';
+        }
 
-            //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] handshake %s", client->num, (uint8_t *)handshake.c_str());
+        if(client->cProtocol.length() > 0) {
+            memcpy_P(p, WEBSOCKETS_HANDSHAKE_PROTOCOL, protocolLen);
+            p += protocolLen;
+            memcpy(p, _protocol.c_str(), _protocol.length());
+            p += _protocol.length();
+            *p++ = '\r';
+            *p++ = '\n';
+        }
 
-            write(client, (uint8_t *)handshake.c_str(), handshake.length());
+#ifdef WEBSOCKETS_USE_DEFLATE
+        if(client->cDeflate) {
+            memcpy_P(p, WEBSOCKETS_HANDSHAKE_DEFLATE, deflateLen);
+            p += deflateLen;
+            memcpy(p, deflateBits, strlen(deflateBits));
+            p += strlen(deflateBits);
+            *p++ = '\r';
+            *p++ = '\n';
+        }
+#endif
 
-            headerDone(client);
+        // header end
+        *p++ = '\r';
+        *p++ = '\n';
 
-            // send ping
-            WebSockets::sendFrame(client, WSop_ping);
+        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] handshake %.*s", client->num, (int)size, handshake);
 
-            runCbEvent(client->num, WStype_CONNECTED, (uint8_t *)client->cUrl.c_str(), client->cUrl.length());
+        write(client, handshake, size);
 
-        } else {
-            handleNonWebsocketConnection(client);
+        if(handshake != stackBuf) {
+            free(handshake);
         }
+
+        headerDone(client);
+
+        // send ping
+        WebSockets::sendFrame(client, WSop_ping);
+
+        runCbEvent(client->num, WStype_CONNECTED, (uint8_t *)client->cUrl.c_str(), client->cUrl.length());
+
+        // the handshake data is no longer used
+        if(client->status == WSC_CONNECTED) {
+            clearHandshake(client);
+        }
+
+    } else {
+        handleNonWebsocketConnection(client);
     }
+
+    return false;
 }
 
 /**
@@ -899,9 +1569,11 @@ void WebSocketsServer::enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeo
     _disconnectTimeoutCount = disconnectTimeoutCount;
     
     WSclient_t * client;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
-        WebSockets::enableHeartbeat(client, pingInterval, pongTimeout, disconnectTimeoutCount);
+    for(uint8_t i = 0; i < _clientMax; i++) {
+        client = _clients[i];
+        if(client) {
+            WebSockets::enableHeartbeat(client, pingInterval, pongTimeout, disconnectTimeoutCount);
+        }
     }
 }
 
@@ -912,8 +1584,10 @@ void WebSocketsServer::disableHeartbeat() {
     _pingInterval = 0;
     
     WSclient_t * client;
-    for(uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
-        client = &_clients[i];
-        client->pingInterval = 0;
+    for(uint8_t i = 0; i < _clientMax; i++) {
+        client = _clients[i];
+        if(client) {
+            client->pingInterval = 0;
+        }
     }
 }
\ No newline at end of file
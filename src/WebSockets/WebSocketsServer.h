@@ -41,7 +41,7 @@ class WebSocketsServer : protected WebSockets {
     typedef std::function<bool(String headerName, String headerValue)> WebSocketServerHttpHeaderValFunc;
 #endif
 
-    WebSocketsServer(uint16_t port, String origin = "", String protocol = "arduino");
+    WebSocketsServer(uint16_t port, String origin = "", String protocol = "arduino", uint8_t clientMax = WEBSOCKETS_SERVER_CLIENT_MAX);
     virtual ~WebSocketsServer(void);
 
     void begin(void);
@@ -91,6 +91,26 @@ class WebSocketsServer : protected WebSockets {
     void setAuthorization(const char * auth);
 
     int connectedClients(bool ping = false);
+
+    bool setClientMax(uint8_t clientMax);
+    uint8_t getClientMax(void);
+
+    bool getBufferPoolStats(uint8_t sizeClass, WSbufferPoolStats_t * stats);
+    void setStreamChunkSize(size_t size);
+    void trimBufferPool(void);
+
+    void lock(void);
+    void unlock(void);
+
+#ifdef WEBSOCKETS_USE_DEFLATE
+    void setDeflate(bool enable, uint8_t windowBits = MB_DEFLATE_WINDOW_BITS);
+#endif
+
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    void setSendQueue(size_t maxBytes, WSqueuePolicy_t policy = WSqueue_dropOldest);
+    bool getSendQueueStats(uint8_t num, WSqueueStats_t * stats);
+    void setMessageKey(uint32_t key);
+#endif
     
     void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount);
     void disableHeartbeat();
@@ -109,19 +129,42 @@ class WebSocketsServer : protected WebSockets {
 
     WEBSOCKETS_NETWORK_SERVER_CLASS * _server;
 
-    WSclient_t _clients[WEBSOCKETS_SERVER_CLIENT_MAX];
+    WSclient_t ** _clients;    ///< client slots, the client struct is allocated when the slot is first used
+    uint8_t _clientMax;        ///< number of client slots
+    uint8_t * _active;         ///< numbers of the clients in use (tcp assigned), in slot order
+    uint8_t _activeCount;
 
     WebSocketServerEvent _cbEvent;
     WebSocketServerHttpHeaderValFunc _httpHeaderValidationFunc;
 
     bool _runnning;
+
+#if defined(ESP32)
+    SemaphoreHandle_t _lock;    ///< the loop task and the sending tasks share the clients, their queues and the pool
+#endif
     
     uint32_t _pingInterval;
     uint32_t _pongTimeout;
     uint8_t _disconnectTimeoutCount;
 
+#ifdef WEBSOCKETS_USE_DEFLATE
+    bool _deflate = false;
+    MB_Deflate _deflater;
+    std::vector<uint8_t> _deflateBuf;    ///< the compressed message, the capacity is kept for the next one
+
+    WSsharedFrame_t * createDeflateFrame(WSopcode_t opcode, uint8_t * payload, size_t length);
+#endif
+
     bool newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient);
 
+    WSclient_t * getClient(uint8_t num);
+    WSclient_t * allocClient(uint8_t num);
+    void freeClients(void);
+    void activateClient(WSclient_t * client);
+    void deactivateClient(WSclient_t * client);
+    WSclient_t * nextActiveClient(int & num);
+    void clearHandshake(WSclient_t * client);
+
     void messageReceived(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, bool fin);
 
     void clientDisconnect(WSclient_t * client);
@@ -133,6 +176,11 @@ class WebSocketsServer : protected WebSockets {
 #endif
 
     void handleHeader(WSclient_t * client, String * headerLine);
+    bool handleHeaderLine(WSclient_t * client, char * line, size_t len, bool truncated = false);
+    bool headerIsRead(const char * name, size_t nameLen);
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    void handleHeaderData(WSclient_t * client);
+#endif
     
     void handleHBPing(WSclient_t * client);    // send ping in specified intervals
 
@@ -155,6 +203,24 @@ class WebSocketsServer : protected WebSockets {
         clientDisconnect(client);
     }
 
+    /**
+         * called if a handshake line that the server reads is longer than WEBSOCKETS_HTTP_LINE_SIZE
+         * Note: can be override
+         * @param client WSclient_t *  ptr to the client struct
+         */
+    virtual void handleHeaderTooLarge(WSclient_t * client) {
+        //DEBUG_WEBSOCKETS("[WS-Server][%d][handleHeader] header line too long.\n", client->num);
+        client->tcp->write(
+            "HTTP/1.1 431 Request Header Fields Too Large\r\n"
+            "Server: arduino-WebSocket-Server\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Length: 35\r\n"
+            "Connection: close\r\n"
+            "\r\n"
+            "The request header line is too long");
+        clientDisconnect(client);
+    }
+
     /**
          * called if a non Authorization connection is coming in.
          * Note: can be override
@@ -194,6 +260,8 @@ class WebSocketsServer : protected WebSockets {
          * socket negotiation is considered invalid and the upgrade to websockets request is denied / rejected
          * This mechanism can be used to enable custom authentication schemes e.g. test the value
          * of a session cookie to determine if a user is logged on / authenticated
+         * Only called when the validation function was set (onValidateHttpHeader), the header lines longer than
+         * WEBSOCKETS_HTTP_LINE_SIZE are then rejected with 431
          */
     virtual bool execHttpHeaderValidation(String headerName, String headerValue) {
         if(_httpHeaderValidationFunc) {
@@ -205,11 +273,14 @@ class WebSocketsServer : protected WebSockets {
     }
 
   private:
+    bool sendMessage(uint8_t num, WSopcode_t opcode, uint8_t * payload, size_t length, bool headerToPayload);
+    bool broadcastFrame(WSopcode_t opcode, uint8_t * payload, size_t length, bool headerToPayload = false);
+
     /*
          * returns an indicator whether the given named header exists in the configured _mandatoryHttpHeaders collection
-         * @param headerName String ///< the name of the header being checked
+         * @param headerName const char * ///< the name of the header being checked
          */
-    bool hasMandatoryHeader(String headerName);
+    bool hasMandatoryHeader(const char * headerName);
 };
 
 #endif /* WEBSOCKETSSERVER_H_ */
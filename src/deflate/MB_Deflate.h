@@ -0,0 +1,318 @@
+/**
+ * The MB_Deflate, compact DEFLATE (RFC 1951) compressor class v1.0.0
+ *
+ * The greedy LZ77 matcher with the hash chain over the small sliding window,
+ * the output is the single fixed Huffman block in raw or gzip (RFC 1952) format.
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2022 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MB_DEFLATE_H
+#define MB_DEFLATE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// The sliding window size in bits (9 - 15), the working memory is (2 << bits) + (4 << MB_DEFLATE_HASH_BITS) bytes
+#ifndef MB_DEFLATE_WINDOW_BITS
+#define MB_DEFLATE_WINDOW_BITS 12
+#endif
+
+#ifndef MB_DEFLATE_HASH_BITS
+#define MB_DEFLATE_HASH_BITS 10
+#endif
+
+#ifndef MB_DEFLATE_MAX_CHAIN
+#define MB_DEFLATE_MAX_CHAIN 16
+#endif
+
+#define MB_DEFLATE_MIN_MATCH 3
+#define MB_DEFLATE_MAX_MATCH 258
+#define MB_DEFLATE_NO_POS 0xffffffff
+
+typedef enum
+{
+    mb_deflate_format_raw,
+    mb_deflate_format_gzip
+} mb_deflate_format;
+
+class MB_Deflate
+{
+public:
+    MB_Deflate(){};
+    ~MB_Deflate() { release(); };
+
+    /**
+     * Set the sliding window size.
+     * @param bits The window size in bits, 9 to MB_DEFLATE_WINDOW_BITS.
+     */
+    void setWindowBits(uint8_t bits)
+    {
+        if (bits < 9)
+            bits = 9;
+        if (bits > MB_DEFLATE_WINDOW_BITS)
+            bits = MB_DEFLATE_WINDOW_BITS;
+        if (bits != _windowBits)
+        {
+            release();
+            _windowBits = bits;
+        }
+    }
+
+    uint8_t windowBits() const { return _windowBits; }
+
+    /**
+     * Free the working memory, it is otherwise kept for the next compress call until the object is destroyed.
+     */
+    void release()
+    {
+        free(_head);
+        free(_prev);
+        _head = nullptr;
+        _prev = nullptr;
+    }
+
+    /**
+     * Compress the data.
+     * @param in The input data.
+     * @param len The length of input data.
+     * @param out The vector to append the compressed data.
+     * @param format The output format, mb_deflate_format_raw or mb_deflate_format_gzip.
+     * @return The boolean value indicates the success of operation (false when out of memory).
+     */
+    bool compress(const uint8_t *in, size_t len, std::vector<uint8_t> &out, mb_deflate_format format = mb_deflate_format_gzip)
+    {
+        const size_t wsize = 1 << _windowBits;
+        const size_t hsize = 1 << MB_DEFLATE_HASH_BITS;
+
+        if (!_head)
+            _head = (uint32_t *)malloc(hsize * sizeof(uint32_t));
+        if (!_prev)
+            _prev = (uint16_t *)malloc(wsize * sizeof(uint16_t));
+
+        if (!_head || !_prev)
+        {
+            release();
+            return false;
+        }
+
+        uint32_t *head = _head;
+        uint16_t *prev = _prev;
+
+        memset(head, 0xff, hsize * sizeof(uint32_t));
+
+        _out = &out;
+        _bits = 0;
+        _bitCount = 0;
+
+        out.reserve(out.size() + (len >> 1) + 32);
+
+        if (format == mb_deflate_format_gzip)
+        {
+            static const uint8_t gzHeader[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+            out.insert(out.end(), gzHeader, gzHeader + sizeof(gzHeader));
+        }
+
+        // BFINAL = 1, BTYPE = 01 (fixed Huffman)
+        putBits(1, 1);
+        putBits(1, 2);
+
+        size_t i = 0;
+        while (i < len)
+        {
+            size_t bestLen = 0, bestDist = 0;
+
+            if (i + MB_DEFLATE_MIN_MATCH <= len)
+            {
+                uint32_t h = hash(in + i);
+                uint32_t cand = head[h];
+
+                prev[i & (wsize - 1)] = (cand != MB_DEFLATE_NO_POS && i - cand < wsize) ? i - cand : 0;
+                head[h] = i;
+
+                size_t maxLen = len - i < MB_DEFLATE_MAX_MATCH ? len - i : MB_DEFLATE_MAX_MATCH;
+                int chain = MB_DEFLATE_MAX_CHAIN;
+
+                while (cand != MB_DEFLATE_NO_POS && chain-- > 0)
+                {
+                    size_t dist = i - cand;
+                    if (dist == 0 || dist >= wsize)
+                        break;
+
+                    if (in[cand + bestLen] == in[i + bestLen])
+                    {
+                        size_t l = 0;
+                        while (l < maxLen && in[cand + l] == in[i + l])
+                            l++;
+
+                        if (l > bestLen)
+                        {
+                            bestLen = l;
+                            bestDist = dist;
+                            if (l == maxLen)
+                                break;
+                        }
+                    }
+
+                    uint16_t d = prev[cand & (wsize - 1)];
+                    if (d == 0)
+                        break;
+                    cand -= d;
+                }
+            }
+
+            if (bestLen >= MB_DEFLATE_MIN_MATCH)
+            {
+                putMatch(bestLen, bestDist);
+
+                // index the skipped positions
+                for (size_t k = i + 1; k < i + bestLen && k + MB_DEFLATE_MIN_MATCH <= len; k++)
+                {
+                    uint32_t h = hash(in + k);
+                    uint32_t cand = head[h];
+                    prev[k & (wsize - 1)] = (cand != MB_DEFLATE_NO_POS && k - cand < wsize) ? k - cand : 0;
+                    head[h] = k;
+                }
+
+                i += bestLen;
+            }
+            else
+            {
+                putSymbol(in[i]);
+                i++;
+            }
+        }
+
+        // end of block
+        putSymbol(256);
+
+        if (_bitCount > 0)
+            out.push_back(_bits & 0xff);
+        _bits = 0;
+        _bitCount = 0;
+
+        if (format == mb_deflate_format_gzip)
+        {
+            uint32_t c = crc32(in, len);
+            for (int k = 0; k < 4; k++)
+                out.push_back((c >> (k * 8)) & 0xff);
+            for (int k = 0; k < 4; k++)
+                out.push_back((len >> (k * 8)) & 0xff);
+        }
+
+        _out = nullptr;
+
+        return true;
+    }
+
+    static uint32_t crc32(const uint8_t *data, size_t len, uint32_t crc = 0)
+    {
+        static const uint32_t table[16] = {
+            0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+            0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+
+        crc = ~crc;
+        for (size_t i = 0; i < len; i++)
+        {
+            crc ^= data[i];
+            crc = (crc >> 4) ^ table[crc & 0x0f];
+            crc = (crc >> 4) ^ table[crc & 0x0f];
+        }
+        return ~crc;
+    }
+
+private:
+    std::vector<uint8_t> *_out = nullptr;
+    uint32_t *_head = nullptr;
+    uint16_t *_prev = nullptr;
+    uint8_t _windowBits = MB_DEFLATE_WINDOW_BITS;
+    uint32_t _bits = 0;
+    uint8_t _bitCount = 0;
+
+    static uint32_t hash(const uint8_t *p)
+    {
+        uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+        return (uint32_t)(v * 2654435761UL) >> (32 - MB_DEFLATE_HASH_BITS);
+    }
+
+    void putBits(uint32_t value, uint8_t count)
+    {
+        _bits |= value << _bitCount;
+        _bitCount += count;
+        while (_bitCount >= 8)
+        {
+            _out->push_back(_bits & 0xff);
+            _bits >>= 8;
+            _bitCount -= 8;
+        }
+    }
+
+    // Huffman codes are packed starting with the most significant bit of the code
+    void putCode(uint32_t code, uint8_t count)
+    {
+        uint32_t rev = 0;
+        for (uint8_t k = 0; k < count; k++)
+        {
+            rev = (rev << 1) | (code & 1);
+            code >>= 1;
+        }
+        putBits(rev, count);
+    }
+
+    void putSymbol(uint16_t sym)
+    {
+        if (sym < 144)
+            putCode(0x30 + sym, 8);
+        else if (sym < 256)
+            putCode(0x190 + sym - 144, 9);
+        else if (sym < 280)
+            putCode(sym - 256, 7);
+        else
+            putCode(0xc0 + sym - 280, 8);
+    }
+
+    void putMatch(size_t length, size_t dist)
+    {
+        static const uint16_t lenBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t lenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const uint16_t distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const uint8_t distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        int k = 28;
+        while (lenBase[k] > length)
+            k--;
+        putSymbol(257 + k);
+        if (lenExtra[k])
+            putBits(length - lenBase[k], lenExtra[k]);
+
+        k = 29;
+        while (distBase[k] > dist)
+            k--;
+        putCode(k, 5);
+        if (distExtra[k])
+            putBits(dist - distBase[k], distExtra[k]);
+    }
+};
+
+#endif
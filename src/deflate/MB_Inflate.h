@@ -0,0 +1,384 @@
+/**
+ * The MB_Inflate, compact DEFLATE (RFC 1951) decompressor class v1.0.0
+ *
+ * The raw DEFLATE decoder for the stored, fixed and dynamic Huffman blocks,
+ * the whole output is kept in the caller buffer which is also the sliding window.
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2022 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MB_INFLATE_H
+#define MB_INFLATE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MB_INFLATE_MAX_BITS 15
+
+// the decompress results
+#define MB_INFLATE_ERROR -1
+#define MB_INFLATE_OVERFLOW -2
+
+class MB_Inflate
+{
+public:
+    MB_Inflate(){};
+    ~MB_Inflate(){};
+
+    /**
+     * Decompress the raw DEFLATE data.
+     * @param in The input data.
+     * @param len The length of input data.
+     * @param out The output buffer.
+     * @param outSize The size of output buffer.
+     * @param tail The bytes to append to the input or nullptr, e.g. the 00 00 ff ff removed by the RFC 7692 sender.
+     * @param tailLen The length of tail.
+     * @return The length of output, MB_INFLATE_ERROR for the invalid data or MB_INFLATE_OVERFLOW when the output buffer is too small.
+     *
+     * @note The data ends at the final block or at the end of input after any complete block.
+     */
+    int decompress(const uint8_t *in, size_t len, uint8_t *out, size_t outSize, const uint8_t *tail = nullptr, size_t tailLen = 0)
+    {
+        _in = in;
+        _inLen = len;
+        _tail = tail;
+        _tailLen = tailLen;
+        _pos = 0;
+        _bits = 0;
+        _bitCount = 0;
+        _out = out;
+        _outSize = outSize;
+        _outLen = 0;
+
+        uint32_t final = 0;
+
+        do
+        {
+            uint32_t type = 0;
+
+            if (!getBits(1, final) || !getBits(2, type))
+                return MB_INFLATE_ERROR;
+
+            int ret = MB_INFLATE_ERROR;
+
+            if (type == 0)
+                ret = stored();
+            else if (type == 1)
+            {
+                buildFixed();
+                ret = codes();
+            }
+            else if (type == 2)
+                ret = dynamic();
+
+            if (ret < 0)
+                return ret;
+
+        } while (!final && _pos < _inLen + _tailLen);
+
+        return _outLen;
+    }
+
+private:
+    typedef struct
+    {
+        uint16_t counts[MB_INFLATE_MAX_BITS + 1];
+        uint16_t symbols[288];
+    } mb_inflate_tree_t;
+
+    mb_inflate_tree_t _lit;
+    mb_inflate_tree_t _dist;
+
+    const uint8_t *_in = nullptr;
+    size_t _inLen = 0;
+    const uint8_t *_tail = nullptr;
+    size_t _tailLen = 0;
+    size_t _pos = 0;
+    uint32_t _bits = 0;
+    uint8_t _bitCount = 0;
+    uint8_t *_out = nullptr;
+    size_t _outSize = 0;
+    size_t _outLen = 0;
+
+    int getByte()
+    {
+        if (_pos < _inLen)
+            return _in[_pos++];
+        if (_pos - _inLen < _tailLen)
+            return _tail[_pos++ - _inLen];
+        return -1;
+    }
+
+    bool getBits(uint8_t count, uint32_t &value)
+    {
+        while (_bitCount < count)
+        {
+            int b = getByte();
+            if (b < 0)
+                return false;
+            _bits |= (uint32_t)b << _bitCount;
+            _bitCount += 8;
+        }
+        value = _bits & ((1UL << count) - 1);
+        _bits >>= count;
+        _bitCount -= count;
+        return true;
+    }
+
+    bool build(mb_inflate_tree_t &tree, const uint8_t *lengths, size_t num)
+    {
+        uint16_t offs[MB_INFLATE_MAX_BITS + 1];
+
+        memset(tree.counts, 0, sizeof(tree.counts));
+        for (size_t i = 0; i < num; i++)
+            tree.counts[lengths[i]]++;
+        tree.counts[0] = 0;
+
+        // the over-subscribed code set is invalid
+        int left = 1;
+        for (int i = 1; i <= MB_INFLATE_MAX_BITS; i++)
+        {
+            left <<= 1;
+            left -= tree.counts[i];
+            if (left < 0)
+                return false;
+        }
+
+        offs[1] = 0;
+        for (int i = 1; i < MB_INFLATE_MAX_BITS; i++)
+            offs[i + 1] = offs[i] + tree.counts[i];
+
+        for (size_t i = 0; i < num; i++)
+        {
+            if (lengths[i])
+                tree.symbols[offs[lengths[i]]++] = i;
+        }
+        return true;
+    }
+
+    void buildFixed()
+    {
+        uint8_t lengths[288];
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        memset(lengths + 280, 8, 8);
+        build(_lit, lengths, 288);
+        memset(lengths, 5, 30);
+        build(_dist, lengths, 30);
+    }
+
+    // Huffman codes are packed starting with the most significant bit of the code
+    int decodeSymbol(const mb_inflate_tree_t &tree)
+    {
+        int code = 0, first = 0, index = 0;
+        uint32_t bit = 0;
+
+        for (int len = 1; len <= MB_INFLATE_MAX_BITS; len++)
+        {
+            if (!getBits(1, bit))
+                return -1;
+            code |= bit;
+            int count = tree.counts[len];
+            if (code - count < first)
+                return tree.symbols[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    int stored()
+    {
+        // skip to the byte boundary
+        _bits = 0;
+        _bitCount = 0;
+
+        int b[4];
+        for (int i = 0; i < 4; i++)
+        {
+            b[i] = getByte();
+            if (b[i] < 0)
+                return MB_INFLATE_ERROR;
+        }
+
+        size_t len = b[0] | (b[1] << 8);
+        if ((b[2] | (b[3] << 8)) != (int)(~len & 0xffff))
+            return MB_INFLATE_ERROR;
+
+        if (_outLen + len > _outSize)
+            return MB_INFLATE_OVERFLOW;
+
+        while (len--)
+        {
+            int c = getByte();
+            if (c < 0)
+                return MB_INFLATE_ERROR;
+            _out[_outLen++] = c;
+        }
+        return 0;
+    }
+
+    int dynamic()
+    {
+        static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+        uint8_t lengths[320];
+        uint32_t nlen = 0, ndist = 0, ncode = 0, v = 0;
+
+        if (!getBits(5, nlen) || !getBits(5, ndist) || !getBits(4, ncode))
+            return MB_INFLATE_ERROR;
+
+        nlen += 257;
+        ndist += 1;
+        ncode += 4;
+
+        if (nlen > 286 || ndist > 30)
+            return MB_INFLATE_ERROR;
+
+        memset(lengths, 0, 19);
+        for (uint32_t i = 0; i < ncode; i++)
+        {
+            if (!getBits(3, v))
+                return MB_INFLATE_ERROR;
+            lengths[order[i]] = v;
+        }
+
+        // the code length codes are kept in the literal tree until the code lengths were read
+        if (!build(_lit, lengths, 19))
+            return MB_INFLATE_ERROR;
+
+        uint32_t index = 0;
+        while (index < nlen + ndist)
+        {
+            int sym = decodeSymbol(_lit);
+            if (sym < 0)
+                return MB_INFLATE_ERROR;
+
+            if (sym < 16)
+            {
+                lengths[index++] = sym;
+                continue;
+            }
+
+            uint8_t len = 0;
+            uint32_t repeat = 0;
+
+            if (sym == 16)
+            {
+                if (index == 0 || !getBits(2, repeat))
+                    return MB_INFLATE_ERROR;
+                len = lengths[index - 1];
+                repeat += 3;
+            }
+            else if (sym == 17)
+            {
+                if (!getBits(3, repeat))
+                    return MB_INFLATE_ERROR;
+                repeat += 3;
+            }
+            else
+            {
+                if (!getBits(7, repeat))
+                    return MB_INFLATE_ERROR;
+                repeat += 11;
+            }
+
+            if (index + repeat > nlen + ndist)
+                return MB_INFLATE_ERROR;
+
+            while (repeat--)
+                lengths[index++] = len;
+        }
+
+        // the end of block code is required
+        if (lengths[256] == 0)
+            return MB_INFLATE_ERROR;
+
+        if (!build(_lit, lengths, nlen) || !build(_dist, lengths + nlen, ndist))
+            return MB_INFLATE_ERROR;
+
+        return codes();
+    }
+
+    int codes()
+    {
+        static const uint16_t lenBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t lenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const uint16_t distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const uint8_t distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        for (;;)
+        {
+            int sym = decodeSymbol(_lit);
+            if (sym < 0)
+                return MB_INFLATE_ERROR;
+
+            if (sym < 256)
+            {
+                if (_outLen == _outSize)
+                    return MB_INFLATE_OVERFLOW;
+                _out[_outLen++] = sym;
+                continue;
+            }
+
+            // end of block
+            if (sym == 256)
+                return 0;
+
+            sym -= 257;
+            if (sym >= 29)
+                return MB_INFLATE_ERROR;
+
+            uint32_t extra = 0;
+            if (!getBits(lenExtra[sym], extra))
+                return MB_INFLATE_ERROR;
+            size_t len = lenBase[sym] + extra;
+
+            int dsym = decodeSymbol(_dist);
+            if (dsym < 0 || dsym >= 30)
+                return MB_INFLATE_ERROR;
+
+            if (!getBits(distExtra[dsym], extra))
+                return MB_INFLATE_ERROR;
+            size_t dist = distBase[dsym] + extra;
+
+            if (dist > _outLen)
+                return MB_INFLATE_ERROR;
+
+            if (_outLen + len > _outSize)
+                return MB_INFLATE_OVERFLOW;
+
+            // the byte wise copy since the source may overlap the destination
+            uint8_t *p = _out + _outLen;
+            const uint8_t *s = p - dist;
+            _outLen += len;
+            while (len--)
+                *p++ = *s++;
+        }
+    }
+};
+
+#endif
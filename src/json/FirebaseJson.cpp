@@ -44,6 +44,8 @@
 FirebaseJsonBase::FirebaseJsonBase()
 {
     MB_JSON_InitHooks(&MB_JSON_hooks);
+    MB_JSON_ResetArrayCursor(&arrCursor);
+    MB_JSON_InitArena(&arena, MB_JSON_ARENA_BLOCK_SIZE);
 }
 
 FirebaseJsonBase::~FirebaseJsonBase()
@@ -57,6 +59,7 @@ FirebaseJsonBase &FirebaseJsonBase::mClear()
     if (root != NULL)
         MB_JSON_Delete(root);
     root = NULL;
+    MB_JSON_FreeArena(&arena);
     buf.clear();
     errorPos = -1;
     return *this;
@@ -67,6 +70,7 @@ void FirebaseJsonBase::mCopy(FirebaseJsonBase &other)
     this->root = MB_JSON_Duplicate(other.root, true);
     this->doubleDigits = other.doubleDigits;
     this->floatDigits = other.floatDigits;
+    this->arenaMode = other.arenaMode;
     this->httpCode = other.httpCode;
     this->serData = other.serData;
     this->root_type = other.root_type;
@@ -104,7 +108,16 @@ bool FirebaseJsonBase::setRaw(const char *raw)
 MB_JSON *FirebaseJsonBase::parse(const char *raw)
 {
     const char *s = NULL;
-    MB_JSON *e = MB_JSON_ParseWithOpts(raw, &s, 1);
+    MB_JSON *e = NULL;
+
+    if (arenaMode)
+    {
+        // the previous tree was deleted before parsing
+        MB_JSON_FreeArena(&arena);
+        e = MB_JSON_ParseWithArena(raw, strlen(raw) + 1, &s, 1, &arena);
+    }
+    else
+        e = MB_JSON_ParseWithOpts(raw, &s, 1);
     errorPos = (s - raw != (int)strlen(raw)) ? s - raw : -1;
     return e;
 }
@@ -149,7 +162,7 @@ MB_JSON *FirebaseJsonBase::getElement(MB_JSON *parent, const char *key, struct s
         r.status = key_status_mistype;
     else if (isArray(parent) && isArrKey)
     {
-        e = MB_JSON_GetArrayItem(parent, index);
+        e = getArrayItem(parent, index);
         if (e == NULL)
             r.status = key_status_out_of_range;
     }
@@ -259,6 +272,17 @@ bool FirebaseJsonBase::isObject(MB_JSON *e)
 {
     return MB_JSON_IsObject(e);
 }
+
+MB_JSON *FirebaseJsonBase::getArrayItem(MB_JSON *array, int index)
+{
+    return MB_JSON_GetArrayItemCursor(array, index, &arrCursor);
+}
+
+int FirebaseJsonBase::getArraySize(MB_JSON *array)
+{
+    return MB_JSON_GetArraySizeCursor(array, &arrCursor);
+}
+
 MB_JSON *FirebaseJsonBase::addArray(MB_JSON *parent, MB_JSON *e, size_t size)
 {
     for (size_t i = 0; i < size - 1; i++)
@@ -276,14 +300,14 @@ void FirebaseJsonBase::appendArray(MB_VECTOR<MB_String> &keys, struct search_res
     if (r.foundIndex > -1)
     {
         if (isArray(parent))
-            parent = MB_JSON_GetArrayItem(parent, getArrIndex(keys[r.foundIndex].c_str()));
+            parent = getArrayItem(parent, getArrIndex(keys[r.foundIndex].c_str()));
         else
             parent = MB_JSON_GetObjectItemCaseSensitive(parent, keys[r.foundIndex].c_str());
     }
 
     if (isArray(parent))
     {
-        int arrSize = MB_JSON_GetArraySize(parent);
+        int arrSize = getArraySize(parent);
 
         if (r.stopIndex < (int)keys.size() - 1)
         {
@@ -321,7 +345,7 @@ void FirebaseJsonBase::replaceItem(MB_VECTOR<MB_String> &keys, struct search_res
     {
         if (r.status == key_status_not_existed && !isArrayKey(keys[r.stopIndex].c_str()))
         {
-            MB_JSON *curItem = isArray(parent) ? MB_JSON_GetArrayItem(parent, getArrIndex(keys[r.foundIndex].c_str())) : MB_JSON_GetObjectItem(parent, keys[r.foundIndex].c_str());
+            MB_JSON *curItem = isArray(parent) ? getArrayItem(parent, getArrIndex(keys[r.foundIndex].c_str())) : MB_JSON_GetObjectItem(parent, keys[r.foundIndex].c_str());
             if (isObject(curItem))
             {
                 mAdd(keys, &curItem, r.foundIndex + 1, value);
@@ -675,6 +699,13 @@ void FirebaseJsonBase::mSetDoubleDigits(uint8_t digits)
     doubleDigits = digits;
 }
 
+void FirebaseJsonBase::mSetArenaMode(bool enable, size_t blockSize)
+{
+    // the blocks in use are kept until the tree was cleared
+    arenaMode = enable;
+    arena.block_size = blockSize > 0 ? blockSize : MB_JSON_ARENA_BLOCK_SIZE;
+}
+
 int FirebaseJsonBase::mResponseCode()
 {
     return httpCode;
@@ -705,22 +736,13 @@ bool FirebaseJsonBase::mGet(MB_JSON *parent, FirebaseJsonData *result, const cha
     {
         MB_JSON *data = NULL;
         if (isArray(_parent))
-            data = MB_JSON_GetArrayItem(_parent, getArrIndex(keys[r.stopIndex].c_str()));
+            data = getArrayItem(_parent, getArrIndex(keys[r.stopIndex].c_str()));
         else
             data = MB_JSON_GetObjectItemCaseSensitive(_parent, keys[r.stopIndex].c_str());
 
         if (data != NULL)
         {
-            if (result != NULL)
-            {
-                result->clear();
-                char *p = prettify ? MB_JSON_Print(data) : MB_JSON_PrintUnformatted(data);
-                result->stringValue = p;
-                MB_JSON_free(p);
-                result->type_num = data->type;
-                result->success = true;
-                mSetElementType(result);
-            }
+            mGetResult(data, result, prettify);
             ret = true;
         }
     }
@@ -729,6 +751,51 @@ bool FirebaseJsonBase::mGet(MB_JSON *parent, FirebaseJsonData *result, const cha
     return ret;
 }
 
+bool FirebaseJsonBase::mGet(MB_JSON *parent, FirebaseJsonData *result, const FirebaseJsonPath &path, bool prettify)
+{
+    prepareRoot();
+
+    if (!path.valid() || path.size() == 0 || (path.isIndex(0) && root_type == Root_Type_JSON))
+        return false;
+
+    MB_JSON *data = mFind(parent == NULL ? root : parent, path);
+    if (data == NULL)
+        return false;
+
+    mGetResult(data, result, prettify);
+    return true;
+}
+
+MB_JSON *FirebaseJsonBase::mFind(MB_JSON *parent, const FirebaseJsonPath &path, MB_JSON **itemParent)
+{
+    MB_JSON *e = parent;
+    for (size_t i = 0; i < path.size() && e != NULL; i++)
+    {
+        if (itemParent)
+            *itemParent = e;
+
+        if (path.isIndex(i))
+            e = isArray(e) ? getArrayItem(e, path.index(i)) : NULL;
+        else
+            e = isObject(e) ? MB_JSON_GetObjectItemCaseSensitive(e, path.key(i)) : NULL;
+    }
+    return e;
+}
+
+void FirebaseJsonBase::mGetResult(MB_JSON *data, FirebaseJsonData *result, bool prettify)
+{
+    if (result == NULL)
+        return;
+
+    result->clear();
+    char *p = prettify ? MB_JSON_Print(data) : MB_JSON_PrintUnformatted(data);
+    result->stringValue = p;
+    MB_JSON_free(p);
+    result->type_num = data->type;
+    result->success = true;
+    mSetElementType(result);
+}
+
 void FirebaseJsonBase::mSetResInt(FirebaseJsonData *data, const char *value)
 {
     if (strlen(value) > 0)
@@ -880,6 +947,41 @@ void FirebaseJsonBase::mSet(const char *path, MB_JSON *value)
     clearList(keys);
 }
 
+void FirebaseJsonBase::mSet(const FirebaseJsonPath &path, MB_JSON *value)
+{
+    prepareRoot();
+
+    if (value == NULL)
+        value = MB_JSON_CreateNull();
+
+    if (!path.valid() || path.size() == 0)
+    {
+        MB_JSON_Delete(value);
+        return;
+    }
+
+    if ((path.isIndex(0) && root_type == Root_Type_JSON) || (!path.isIndex(0) && root_type == Root_Type_JSONArray))
+    {
+        MB_JSON_Delete(value);
+        return;
+    }
+
+    // the existing item is replaced in place, the missing nodes are created as the string path does
+    MB_JSON *parent = NULL;
+    MB_JSON *item = mFind(root, path, &parent);
+
+    if (item != NULL)
+    {
+        size_t last = path.size() - 1;
+        if (path.isIndex(last) ? MB_JSON_ReplaceItemInArray(parent, path.index(last), value) : MB_JSON_ReplaceItemInObjectCaseSensitive(parent, path.key(last), value))
+            return;
+    }
+
+    MB_String s;
+    path.toString(s);
+    mSet(s.c_str(), value);
+}
+
 #if defined(__AVR__)
 unsigned long long FirebaseJsonBase::strtoull_alt(const char *s)
 {
@@ -956,6 +1058,11 @@ FirebaseJsonArray::FirebaseJsonArray(FirebaseJsonArray &other)
         mCopy(other);
 }
 
+void FirebaseJsonArray::set(const FirebaseJsonPath &path, FirebaseJson &value)
+{
+    pathSetHandler(path, MB_JSON_Duplicate(value.root, true));
+}
+
 FirebaseJsonArray &FirebaseJsonArray::nAdd(MB_JSON *value)
 {
     if (root_type != Root_Type_JSONArray)
@@ -982,7 +1089,7 @@ bool FirebaseJsonArray::mGetIdx(FirebaseJsonData *result, int index, bool pretti
 
     MB_JSON *data = NULL;
     if (isArray(root))
-        data = MB_JSON_GetArrayItem(root, index);
+        data = getArrayItem(root, index);
 
     if (data != NULL)
     {
@@ -1006,7 +1113,7 @@ bool FirebaseJsonArray::mSetIdx(int index, MB_JSON *value)
 
     prepareRoot();
 
-    int size = MB_JSON_GetArraySize(root);
+    int size = getArraySize(root);
     if (index < size)
         return MB_JSON_ReplaceItemInArray(root, index, value);
     else
@@ -1023,11 +1130,11 @@ bool FirebaseJsonArray::mSetIdx(int index, MB_JSON *value)
 
 bool FirebaseJsonArray::mRemoveIdx(int index)
 {
-    int size = MB_JSON_GetArraySize(root);
+    int size = getArraySize(root);
     if (index < size)
     {
         MB_JSON_DeleteItemFromArray(root, index);
-        return size != MB_JSON_GetArraySize(root);
+        return size != getArraySize(root);
     }
     return false;
 }
@@ -267,6 +267,170 @@ namespace fb_js
     };
 };
 
+#if !defined(FIREBASEJSON_PATH_MAX_SEGMENTS)
+#define FIREBASEJSON_PATH_MAX_SEGMENTS 8
+#endif
+
+// the stack buffer of toString to Stream, File and Serial, the JSON is written out in pieces of this size
+#if !defined(FIREBASEJSON_WRITE_BUFFER_SIZE)
+#define FIREBASEJSON_WRITE_BUFFER_SIZE 128
+#endif
+
+#if !defined(FIREBASEJSON_PATH_MAX_LENGTH)
+#define FIREBASEJSON_PATH_MAX_LENGTH 64
+#endif
+
+/**
+ * The relative path which is parsed once and used with get and set of FirebaseJson and FirebaseJsonArray
+ * without tokenizing the path string in every call e.g. FirebaseJsonPath path("[3]/value").
+ *
+ * The keys are kept in the fixed size buffer, the path is limited to FIREBASEJSON_PATH_MAX_SEGMENTS keys
+ * and FIREBASEJSON_PATH_MAX_LENGTH characters.
+ */
+class FirebaseJsonPath
+{
+public:
+    FirebaseJsonPath(){};
+    FirebaseJsonPath(const char *path) { compile(path); };
+
+    /**
+     * Parse the relative path.
+     *
+     * @param path The relative path e.g. /myRoot/[2]/Sensor1.
+     * @return boolean status of the operation, false if the path is too long or has too many keys.
+     */
+    bool compile(const char *path)
+    {
+        _count = 0;
+        _valid = false;
+
+        if (!path || strlen(path) >= FIREBASEJSON_PATH_MAX_LENGTH)
+            return false;
+
+        size_t len = 0;
+        const char *p = path, *end = path + strlen(path);
+
+        while (p <= end)
+        {
+            const char *q = p;
+            while (q < end && *q != '/')
+                q++;
+
+            // the same as the string path, the keys are trimmed and the empty keys are skipped
+            const char *s = p, *e = q;
+            while (s < e && *s == ' ')
+                s++;
+            while (e > s && *(e - 1) == ' ')
+                e--;
+
+            if (e > s)
+            {
+                if (_count == FIREBASEJSON_PATH_MAX_SEGMENTS)
+                    return false;
+
+                segment_t &seg = _segments[_count++];
+                seg.offset = len;
+                seg.len = e - s;
+                seg.index = -1;
+                if (seg.len > 1 && *s == '[' && *(e - 1) == ']')
+                {
+                    seg.index = atoi(s + 1);
+                    if (seg.index < 0)
+                        seg.index = 0;
+                }
+
+                memcpy(_buf + len, s, seg.len);
+                len += seg.len;
+                _buf[len++] = '\0';
+            }
+            p = q + 1;
+        }
+
+        _valid = true;
+        return true;
+    }
+
+    bool valid() const { return _valid; }
+
+    // Get the number of keys.
+    size_t size() const { return _count; }
+
+    // Check whether the key at position is the array index.
+    bool isIndex(size_t i) const { return _segments[i].index > -1; }
+
+    // Get the array index of the key at position.
+    int index(size_t i) const { return _segments[i].index; }
+
+    // Get the key at position, the array key is in the form of [index].
+    const char *key(size_t i) const { return _buf + _segments[i].offset; }
+
+    /**
+     * Change the array index of the key at position e.g. to iterate the array with path("[0]/value").
+     *
+     * @param i The position of array key.
+     * @param index The new array index.
+     * @return boolean status of the operation.
+     */
+    bool setIndex(size_t i, int index)
+    {
+        if (i >= _count || _segments[i].index < 0 || index < 0)
+            return false;
+
+        char num[12];
+        int n = snprintf(num, sizeof(num), "[%d]", index);
+
+        // rebuild the key text when its length changed
+        if (n != _segments[i].len)
+        {
+            char buf[FIREBASEJSON_PATH_MAX_LENGTH];
+            size_t len = 0;
+            for (size_t k = 0; k < _count; k++)
+            {
+                size_t kl = k == i ? (size_t)n : _segments[k].len;
+                if (len + kl + 1 > sizeof(buf))
+                    return false;
+                memcpy(buf + len, k == i ? num : key(k), kl);
+                buf[len + kl] = '\0';
+                _segments[k].offset = len;
+                len += kl + 1;
+            }
+            memcpy(_buf, buf, len);
+            _segments[i].len = n;
+        }
+        else
+            memcpy(_buf + _segments[i].offset, num, n);
+
+        _segments[i].index = index;
+        return true;
+    }
+
+    // Get the path string.
+    void toString(MB_String &out) const
+    {
+        out.clear();
+        for (size_t i = 0; i < _count; i++)
+        {
+            if (i > 0)
+                out += '/';
+            out += key(i);
+        }
+    }
+
+private:
+    struct segment_t
+    {
+        uint8_t offset = 0;
+        uint8_t len = 0;
+        // the array index or -1 for the object key
+        int index = -1;
+    };
+
+    segment_t _segments[FIREBASEJSON_PATH_MAX_SEGMENTS];
+    char _buf[FIREBASEJSON_PATH_MAX_LENGTH];
+    uint8_t _count = 0;
+    bool _valid = false;
+};
+
 class FirebaseJsonData
 {
     friend class FirebaseJsonBase;
@@ -298,7 +462,7 @@ public:
     template <typename T>
     bool getArray(T source, FirebaseJsonArray &jsonArray)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = mGetArray(getStr(source, addr), jsonArray);
         delAddr(addr);
         return ret;
@@ -325,7 +489,7 @@ public:
     template <typename T>
     bool getJSON(T source, FirebaseJson &json)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = mGetJSON(getStr(source, addr), json);
         delAddr(addr);
         return ret;
@@ -468,20 +632,20 @@ private:
     void *newP(size_t len);
 
     template <typename T>
-    auto getStr(const T &val, uint32_t &addr) -> typename MB_ENABLE_IF<is_std_string<T>::value || is_arduino_string<T>::value || is_mb_string<T>::value || MB_IS_SAME<T, StringSumHelper>::value, const char *>::type
+    auto getStr(const T &val, uintptr_t &addr) -> typename MB_ENABLE_IF<is_std_string<T>::value || is_arduino_string<T>::value || is_mb_string<T>::value || MB_IS_SAME<T, StringSumHelper>::value, const char *>::type
     {
         addr = 0;
         return val.c_str();
     }
 
     template <typename T>
-    auto getStr(T val, uint32_t &addr) -> typename MB_ENABLE_IF<is_arduino_flash_string_helper<T>::value, const char *>::type
+    auto getStr(T val, uintptr_t &addr) -> typename MB_ENABLE_IF<is_arduino_flash_string_helper<T>::value, const char *>::type
     {
         return getStr(reinterpret_cast<PGM_P>(val), addr);
     }
 
     template <typename T>
-    auto getStr(T val, uint32_t &addr) -> typename MB_ENABLE_IF<is_const_chars<T>::value, const char *>::type
+    auto getStr(T val, uintptr_t &addr) -> typename MB_ENABLE_IF<is_const_chars<T>::value, const char *>::type
     {
         int len = strlen_P((PGM_P)val) + 1;
         char *out = (char *)newP(len);
@@ -492,7 +656,7 @@ private:
         return (const char *)out;
     }
 
-    void delAddr(uint32_t addr)
+    void delAddr(uintptr_t addr)
     {
         if (addr > 0)
         {
@@ -575,6 +739,8 @@ private:
     void clearList(MB_VECTOR<MB_String> &keys);
     bool isArray(MB_JSON *e);
     bool isObject(MB_JSON *e);
+    MB_JSON *getArrayItem(MB_JSON *array, int index);
+    int getArraySize(MB_JSON *array);
     MB_JSON *addArray(MB_JSON *parent, MB_JSON *e, size_t size);
     void appendArray(MB_VECTOR<MB_String> &keys, struct search_result_t &r, MB_JSON *parent, MB_JSON *value);
     void replaceItem(MB_VECTOR<MB_String> &keys, struct search_result_t &r, MB_JSON *parent, MB_JSON *value);
@@ -597,12 +763,17 @@ private:
     size_t mGetSerializedBufferLength(bool prettify);
     void mSetFloatDigits(uint8_t digits);
     void mSetDoubleDigits(uint8_t digits);
+    void mSetArenaMode(bool enable, size_t blockSize);
     int mResponseCode();
     bool mGet(MB_JSON *parent, FirebaseJsonData *result, const char *path, bool prettify = false);
+    bool mGet(MB_JSON *parent, FirebaseJsonData *result, const FirebaseJsonPath &path, bool prettify = false);
+    MB_JSON *mFind(MB_JSON *parent, const FirebaseJsonPath &path, MB_JSON **itemParent = NULL);
+    void mGetResult(MB_JSON *data, FirebaseJsonData *result, bool prettify);
     void mSetResInt(FirebaseJsonData *data, const char *value);
     void mSetResFloat(FirebaseJsonData *data, const char *value);
     void mSetElementType(FirebaseJsonData *result);
     void mSet(const char *path, MB_JSON *value);
+    void mSet(const FirebaseJsonPath &path, MB_JSON *value);
     void mCopy(FirebaseJsonBase &other);
 #if defined(__AVR__)
     unsigned long long strtoull_alt(const char *s);
@@ -652,10 +823,15 @@ protected:
     struct iterator_data_t iterator_data;
     MB_JSON *root = NULL;
     MB_JSON_Hooks *hooks = NULL;
+    // the last array item accessed, for the sequential access by index
+    MB_JSON_ArrayCursor arrCursor;
+    // the blocks of parsed tree in arena mode
+    MB_JSON_Arena arena;
+    bool arenaMode = false;
     MB_String buf;
 
     template <typename T>
-    auto getStr(T val, uint32_t &addr) -> typename MB_ENABLE_IF<is_bool<T>::value || is_num_int<T>::value || MB_IS_SAME<T, float>::value || MB_IS_SAME<T, double>::value || MB_IS_SAME<T, long double>::value, const char *>::type
+    auto getStr(T val, uintptr_t &addr) -> typename MB_ENABLE_IF<is_bool<T>::value || is_num_int<T>::value || MB_IS_SAME<T, float>::value || MB_IS_SAME<T, double>::value || MB_IS_SAME<T, long double>::value, const char *>::type
     {
         MB_String t;
 
@@ -676,20 +852,20 @@ protected:
     }
 
     template <typename T>
-    auto getStr(const T &val, uint32_t &addr) -> typename MB_ENABLE_IF<is_std_string<T>::value || is_arduino_string<T>::value || is_mb_string<T>::value || MB_IS_SAME<T, StringSumHelper>::value, const char *>::type
+    auto getStr(const T &val, uintptr_t &addr) -> typename MB_ENABLE_IF<is_std_string<T>::value || is_arduino_string<T>::value || is_mb_string<T>::value || MB_IS_SAME<T, StringSumHelper>::value, const char *>::type
     {
         addr = 0;
         return val.c_str();
     }
 
     template <typename T>
-    auto getStr(T val, uint32_t &addr) -> typename MB_ENABLE_IF<is_arduino_flash_string_helper<T>::value, const char *>::type
+    auto getStr(T val, uintptr_t &addr) -> typename MB_ENABLE_IF<is_arduino_flash_string_helper<T>::value, const char *>::type
     {
         return getStr(reinterpret_cast<PGM_P>(val), addr);
     }
 
     template <typename T>
-    auto getStr(T val, uint32_t &addr) -> typename MB_ENABLE_IF<is_const_chars<T>::value, const char *>::type
+    auto getStr(T val, uintptr_t &addr) -> typename MB_ENABLE_IF<is_const_chars<T>::value, const char *>::type
     {
         int len = strlen_P((PGM_P)val) + 1;
         char *out = (char *)newP(len);
@@ -700,6 +876,31 @@ protected:
         return (const char *)out;
     }
 
+    template <typename T>
+    auto toJSON(T val) -> typename MB_ENABLE_IF<is_bool<T>::value, MB_JSON *>::type { return MB_JSON_CreateBool(val); }
+
+    template <typename T>
+    auto toJSON(T val) -> typename MB_ENABLE_IF<is_num_int<T>::value, MB_JSON *>::type { return MB_JSON_CreateRaw(num2Str(val, -1)); }
+
+    template <typename T>
+    auto toJSON(T val) -> typename MB_ENABLE_IF<MB_IS_SAME<T, float>::value, MB_JSON *>::type { return MB_JSON_CreateRaw(num2Str(val, floatDigits)); }
+
+    template <typename T>
+    auto toJSON(T val) -> typename MB_ENABLE_IF<MB_IS_SAME<T, double>::value || MB_IS_SAME<T, long double>::value, MB_JSON *>::type { return MB_JSON_CreateRaw(num2Str(val, doubleDigits)); }
+
+    template <typename T>
+    auto toJSON(const T &val) -> typename MB_ENABLE_IF<is_string<T>::value, MB_JSON *>::type
+    {
+        uintptr_t addr = 0;
+        MB_JSON *e = MB_JSON_CreateString(getStr(val, addr));
+        if (addr > 0)
+        {
+            char *s = addrTo<char *>(addr);
+            delP(&s);
+        }
+        return e;
+    }
+
     template <typename T>
     bool toStringPtrHandler(T *ptr, bool prettify)
     {
@@ -738,14 +939,7 @@ protected:
     template <typename T>
     auto toStringHandler(T &out, bool prettify) -> typename MB_ENABLE_IF<MB_IS_SAME<T, MB_SERIAL_CLASS>::value, bool>::type
     {
-        char *p = prettify ? MB_JSON_Print(root) : MB_JSON_PrintUnformatted(root);
-        if (p)
-        {
-            out.print(p);
-            MB_JSON_free(p);
-            return true;
-        }
-        return false;
+        return writeStream(out, prettify);
     }
 
     template <typename T>
@@ -765,22 +959,20 @@ protected:
 #endif
 
     template <typename T>
-    bool writeStream(T &out, bool prettify)
+    static size_t writeOut(void *context, const char *data, size_t len)
     {
-        bool ret = false;
+        return static_cast<T *>(context)->write((const uint8_t *)data, len);
+    }
 
+    template <typename T>
+    bool writeStream(T &out, bool prettify)
+    {
         if (!root)
             return false;
 
-        char *p = prettify ? MB_JSON_Print(root) : MB_JSON_PrintUnformatted(root);
-        if (p)
-        {
-            ret = out.write((const uint8_t *)p, strlen(p)) == strlen(p);
-            MB_JSON_free(p);
-            return ret;
-        }
-
-        return ret;
+        // the tree is printed straight to out, no copy of the whole JSON string
+        char b[FIREBASEJSON_WRITE_BUFFER_SIZE];
+        return MB_JSON_PrintToWriter(root, b, sizeof(b), prettify, writeOut<T>, &out);
     }
 
     void idle()
@@ -1690,14 +1882,18 @@ protected:
     void ltrim(MB_String &str, const MB_String &chars = " ")
     {
         size_t pos = str.find_first_not_of(chars);
-        if (pos != MB_String::npos)
+        if (pos == MB_String::npos)
+            str.clear();
+        else
             str.erase(0, pos);
     }
 
     void rtrim(MB_String &str, const MB_String &chars = " ")
     {
         size_t pos = str.find_last_not_of(chars);
-        if (pos != MB_String::npos)
+        if (pos == MB_String::npos)
+            str.clear();
+        else
             str.erase(pos + 1);
     }
 
@@ -1782,7 +1978,7 @@ public:
     template <typename T>
     bool setJsonArrayData(T data)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = setRaw(getStr(data, addr));
         delAddr(addr);
         return ret;
@@ -1882,6 +2078,16 @@ public:
     template <typename T>
     bool get(FirebaseJsonData &result, T index_or_path, bool prettify = false) { return dataGetHandler(index_or_path, result, prettify); }
 
+    /**
+     * Get the array value at the parsed path from the FirebaseJsonArray object.
+     *
+     * @param result The reference of FirebaseJsonData object that holds data at the specified path.
+     * @param path The FirebaseJsonPath object of the relative path.
+     * @param prettify The text indentation and new line serialization option.
+     * @return boolean status of the operation.
+     */
+    bool get(FirebaseJsonData &result, const FirebaseJsonPath &path, bool prettify = false) { return mGet(root, &result, path, prettify); }
+
     /**
      * Check whether key or path to the child element existed in FirebaseJsonArray or not.
      *
@@ -1891,7 +2097,7 @@ public:
     template <typename T>
     bool isMember(T path)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = mGet(root, NULL, getStr(path, addr));
         delAddr(addr);
         return ret;
@@ -1938,7 +2144,7 @@ public:
      * Get the length of the array in FirebaseJsonArray object.
      * @return length of the array.
      */
-    size_t size() { return MB_JSON_GetArraySize(root); }
+    size_t size() { return getArraySize(root); }
 
     /**
      * Get the FirebaseJsonArray object serialized string.
@@ -2005,6 +2211,21 @@ public:
     template <typename T>
     void set(T index_or_path, FirebaseJsonArray &value) { return dataSetHandler(index_or_path, value); }
 
+    /**
+     * Set value to FirebaseJsonArray object at the parsed path.
+     *
+     * @param path The FirebaseJsonPath object of the relative path.
+     * @param value The value to set.
+     */
+    template <typename T>
+    void set(const FirebaseJsonPath &path, T value) { pathSetHandler(path, toJSON(value)); }
+
+    void set(const FirebaseJsonPath &path) { pathSetHandler(path, MB_JSON_CreateNull()); }
+
+    void set(const FirebaseJsonPath &path, FirebaseJson &value);
+
+    void set(const FirebaseJsonPath &path, FirebaseJsonArray &value) { pathSetHandler(path, MB_JSON_Duplicate(value.root, true)); }
+
     /**
      * Remove the array value at the specified index or path from the FirebaseJsonArray object.
      *
@@ -2034,6 +2255,16 @@ public:
      */
     void setDoubleDigits(uint8_t digits) { mSetDoubleDigits(digits); }
 
+    /**
+     * Set the arena allocation of the parsed JSON Array object.
+     * @param enable The option to allocate the parsed JSON Array object from the arena blocks.
+     * @param blockSize The size of arena block in bytes.
+     *
+     * @note The parsed JSON Array object is released at once when it was cleared or replaced by the next parsing,
+     * the elements removed from it keep their memory until then.
+     */
+    void setArenaMode(bool enable, size_t blockSize = MB_JSON_ARENA_BLOCK_SIZE) { mSetArenaMode(enable, blockSize); }
+
     /**
      * Get http response code of reading JSON data from WiFi/Ethernet Client.
      * @return the response code of reading JSON data from WiFi/Ethernet Client
@@ -2042,6 +2273,16 @@ public:
 
 private:
     FirebaseJsonArray &nAdd(MB_JSON *value);
+
+    void pathSetHandler(const FirebaseJsonPath &path, MB_JSON *value)
+    {
+        if (root_type != Root_Type_JSONArray)
+            mClear();
+
+        root_type = Root_Type_JSONArray;
+        mSet(path, value);
+    }
+
     bool mSetIdx(int index, MB_JSON *value);
     bool mGetIdx(FirebaseJsonData *result, int index, bool prettify);
     bool mRemoveIdx(int index);
@@ -2049,7 +2290,7 @@ private:
     template <typename T>
     auto dataGetHandler(T arg, FirebaseJsonData &result, bool prettify) -> typename MB_ENABLE_IF<is_string<T>::value, bool>::type
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = mGet(root, &result, getStr(arg, addr), prettify);
         delAddr(addr);
         return ret;
@@ -2064,7 +2305,7 @@ private:
     template <typename T>
     auto dataRemoveHandler(T arg) -> typename MB_ENABLE_IF<is_string<T>::value, bool>::type
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = mRemove(getStr(arg, addr));
         delAddr(addr);
         return ret;
@@ -2132,7 +2373,7 @@ private:
 
         root_type = Root_Type_JSONArray;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         nAdd(MB_JSON_CreateString(getStr(arg, addr)));
         delAddr(addr);
         return *this;
@@ -2147,7 +2388,7 @@ private:
 
         root_type = Root_Type_JSONArray;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         mSet(getStr(arg1, addr), MB_JSON_CreateNull());
         delAddr(addr);
     }
@@ -2167,7 +2408,7 @@ private:
 
         root_type = Root_Type_JSONArray;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         mSet(getStr(arg1, addr), MB_JSON_CreateBool(arg2));
         delAddr(addr);
     }
@@ -2186,7 +2427,7 @@ private:
 
         root_type = Root_Type_JSONArray;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         mSet(getStr(arg1, addr), MB_JSON_CreateRaw(num2Str(arg2, -1)));
         delAddr(addr);
     }
@@ -2205,7 +2446,7 @@ private:
 
         root_type = Root_Type_JSONArray;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         mSet(getStr(arg1, addr), MB_JSON_CreateRaw(num2Str(arg2, floatDigits)));
         delAddr(addr);
     }
@@ -2224,7 +2465,7 @@ private:
 
         root_type = Root_Type_JSONArray;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         mSet(getStr(arg1, addr), MB_JSON_CreateRaw(num2Str(arg2, doubleDigits)));
         delAddr(addr);
     }
@@ -2243,8 +2484,8 @@ private:
 
         root_type = Root_Type_JSONArray;
 
-        uint32_t addr1 = 0;
-        uint32_t addr2 = 0;
+        uintptr_t addr1 = 0;
+        uintptr_t addr2 = 0;
         mSet(getStr(arg1, addr1), MB_JSON_CreateString(getStr(arg2, addr2)));
         delAddr(addr1);
         delAddr(addr2);
@@ -2253,7 +2494,7 @@ private:
     template <typename T1, typename T2>
     auto dataSetHandler(T1 arg1, T2 arg2) -> typename MB_ENABLE_IF<(is_num_int<T1>::value || is_num_float<T1>::value || is_bool<T1>::value) && is_string<T2>::value>::type
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         mSetIdx(arg1, MB_JSON_CreateString(getStr(arg2, addr)));
         delAddr(addr);
     }
@@ -2267,7 +2508,7 @@ private:
         root_type = Root_Type_JSONArray;
 
         MB_JSON *e = MB_JSON_Duplicate(arg2.root, true);
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         mSet(getStr(arg1, addr), e);
         delAddr(addr);
     }
@@ -2288,7 +2529,7 @@ private:
         root_type = Root_Type_JSONArray;
 
         MB_JSON *e = MB_JSON_Duplicate(arg2.root, true);
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         mSet(getStr(arg1, addr), e);
         delAddr(addr);
     }
@@ -2300,7 +2541,7 @@ private:
         mSetIdx(arg1, e);
     }
 
-    void delAddr(uint32_t addr)
+    void delAddr(uintptr_t addr)
     {
         if (addr > 0)
         {
@@ -2353,7 +2594,7 @@ public:
     template <typename T>
     bool setJsonData(T data)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = setRaw(getStr(data, addr));
         delAddr(addr);
         return ret;
@@ -2403,7 +2644,7 @@ public:
     template <typename T>
     FirebaseJson &add(T key)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         nAdd(getStr(key, addr), NULL);
         delAddr(addr);
         return *this;
@@ -2419,7 +2660,7 @@ public:
     template <typename T1, typename T2>
     FirebaseJson &add(T1 key, T2 value)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_add);
         delAddr(addr);
         return *this;
@@ -2428,7 +2669,7 @@ public:
     template <typename T>
     FirebaseJson &add(T key, FirebaseJson &value)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_add);
         delAddr(addr);
         return *this;
@@ -2437,7 +2678,7 @@ public:
     template <typename T>
     FirebaseJson &add(T key, FirebaseJsonArray &value)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_add);
         delAddr(addr);
         return *this;
@@ -2498,12 +2739,26 @@ public:
     template <typename T>
     bool get(FirebaseJsonData &result, T path, bool prettify = false)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = mGet(root, &result, getStr(path, addr), prettify);
         delAddr(addr);
         return ret;
     }
 
+    /**
+     * Get the value from the parsed path in FirebaseJson object.
+     *
+     * @param result The reference of FirebaseJsonData object that holds data at the specified path.
+     * @param path The FirebaseJsonPath object of the relative path.
+     * @param prettify The text indentation and new line serialization option.
+     * @return boolean status of the operation.
+     *
+     * @note The FirebaseJsonPath is parsed once, use it for the same path that accessed repeatedly.
+     */
+    bool get(FirebaseJsonData &result, const FirebaseJsonPath &path, bool prettify = false) { return mGet(root, &result, path, prettify); }
+
+    bool isMember(const FirebaseJsonPath &path) { return mGet(root, NULL, path); }
+
     /**
      * Check whether key or path to the child element existed in FirebaseJson object or not.
      *
@@ -2513,7 +2768,7 @@ public:
     template <typename T>
     bool isMember(T path)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = mGet(root, NULL, getStr(path, addr));
         delAddr(addr);
         return ret;
@@ -2568,7 +2823,7 @@ public:
     template <typename T>
     void set(T key)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         mSet(getStr(key, addr), NULL);
         delAddr(addr);
     }
@@ -2589,7 +2844,7 @@ public:
     template <typename T1, typename T2>
     FirebaseJson &set(T1 key, T2 value)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_set);
         delAddr(addr);
         return *this;
@@ -2598,7 +2853,7 @@ public:
     template <typename T>
     FirebaseJson &set(T key, FirebaseJson &value)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_set);
         delAddr(addr);
         return *this;
@@ -2607,12 +2862,27 @@ public:
     template <typename T>
     FirebaseJson &set(T key, FirebaseJsonArray &value)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         dataHandler(getStr(key, addr), value, fb_json_func_type_set);
         delAddr(addr);
         return *this;
     }
 
+    /**
+     * Set value to FirebaseJson object at the parsed path.
+     *
+     * @param path The FirebaseJsonPath object of the relative path.
+     * @param value The value to set.
+     */
+    template <typename T>
+    FirebaseJson &set(const FirebaseJsonPath &path, T value) { return pathSetHandler(path, toJSON(value)); }
+
+    FirebaseJson &set(const FirebaseJsonPath &path) { return pathSetHandler(path, MB_JSON_CreateNull()); }
+
+    FirebaseJson &set(const FirebaseJsonPath &path, FirebaseJson &value) { return pathSetHandler(path, MB_JSON_Duplicate(value.root, true)); }
+
+    FirebaseJson &set(const FirebaseJsonPath &path, FirebaseJsonArray &value) { return pathSetHandler(path, MB_JSON_Duplicate(value.root, true)); }
+
     /**
      * Remove the specified node and its content.
      *
@@ -2622,7 +2892,7 @@ public:
     template <typename T>
     bool remove(T path)
     {
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         bool ret = mRemove(getStr(path, addr));
         delAddr(addr);
         return ret;
@@ -2659,6 +2929,16 @@ public:
      */
     void setDoubleDigits(uint8_t digits) { mSetDoubleDigits(digits); }
 
+    /**
+     * Set the arena allocation of the parsed JSON object.
+     * @param enable The option to allocate the parsed JSON object from the arena blocks.
+     * @param blockSize The size of arena block in bytes.
+     *
+     * @note The parsed JSON object is released at once when it was cleared or replaced by the next parsing,
+     * the elements removed from it keep their memory until then.
+     */
+    void setArenaMode(bool enable, size_t blockSize = MB_JSON_ARENA_BLOCK_SIZE) { mSetArenaMode(enable, blockSize); }
+
     /**
      * Get http response code of reading JSON data from WiFi/Ethernet Client.
      * @return the response code of reading JSON data from WiFi/Ethernet Client
@@ -2668,6 +2948,16 @@ public:
 private:
     FirebaseJson &nAdd(const char *key, MB_JSON *value);
 
+    FirebaseJson &pathSetHandler(const FirebaseJsonPath &path, MB_JSON *value)
+    {
+        if (root_type != Root_Type_JSON)
+            mClear();
+
+        root_type = Root_Type_JSON;
+        mSet(path, value);
+        return *this;
+    }
+
     template <typename T1, typename T2>
     auto dataHandler(T1 arg1, T2 arg2, fb_json_func_type_t type) -> typename MB_ENABLE_IF<is_string<T1>::value && is_bool<T2>::value, FirebaseJson &>::type
     {
@@ -2676,7 +2966,7 @@ private:
 
         root_type = Root_Type_JSON;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         if (type == fb_json_func_type_add)
             nAdd(getStr(arg1, addr), MB_JSON_CreateBool(arg2));
         else if (type == fb_json_func_type_set)
@@ -2693,7 +2983,7 @@ private:
 
         root_type = Root_Type_JSON;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         if (type == fb_json_func_type_add)
             nAdd(getStr(arg1, addr), MB_JSON_CreateRaw(num2Str(arg2, -1)));
         else if (type == fb_json_func_type_set)
@@ -2710,7 +3000,7 @@ private:
 
         root_type = Root_Type_JSON;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         if (type == fb_json_func_type_add)
             nAdd(getStr(arg1, addr), MB_JSON_CreateRaw(num2Str(arg2, floatDigits)));
         else if (type == fb_json_func_type_set)
@@ -2727,7 +3017,7 @@ private:
 
         root_type = Root_Type_JSON;
 
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         if (type == fb_json_func_type_add)
             nAdd(getStr(arg1, addr), MB_JSON_CreateRaw(num2Str(arg2, doubleDigits)));
         else if (type == fb_json_func_type_set)
@@ -2744,8 +3034,8 @@ private:
 
         root_type = Root_Type_JSON;
 
-        uint32_t addr1 = 0;
-        uint32_t addr2 = 0;
+        uintptr_t addr1 = 0;
+        uintptr_t addr2 = 0;
         if (type == fb_json_func_type_add)
             nAdd(getStr(arg1, addr1), MB_JSON_CreateString(getStr(arg2, addr2)));
         else if (type == fb_json_func_type_set)
@@ -2764,7 +3054,7 @@ private:
         root_type = Root_Type_JSON;
 
         MB_JSON *e = MB_JSON_Duplicate(json.root, true);
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         if (type == fb_json_func_type_add)
             nAdd(getStr(arg, addr), e);
         else if (type == fb_json_func_type_set)
@@ -2782,7 +3072,7 @@ private:
         root_type = Root_Type_JSON;
 
         MB_JSON *e = MB_JSON_Duplicate(arr.root, true);
-        uint32_t addr = 0;
+        uintptr_t addr = 0;
         if (type == fb_json_func_type_add)
             nAdd(getStr(arg, addr), e);
         else if (type == fb_json_func_type_set)
@@ -2791,7 +3081,7 @@ private:
         return *this;
     }
 
-    void delAddr(uint32_t addr)
+    void delAddr(uintptr_t addr)
     {
         if (addr > 0)
         {
@@ -175,6 +175,8 @@ typedef struct MB_JSON_internal_hooks
     void *(MB_JSON_CDECL *allocate)(size_t size);
     void(MB_JSON_CDECL *deallocate)(void *pointer);
     void *(MB_JSON_CDECL *reallocate)(void *pointer, size_t size);
+    /* the arena of the tree being parsed or NULL */
+    MB_JSON_Arena *arena;
 } MB_JSON_internal_hooks;
 
 #if defined(_MSC_VER)
@@ -200,7 +202,7 @@ static void *MB_JSON_CDECL internal_realloc(void *pointer, size_t size)
 /* strlen of character literals resolved at compile time */
 #define MB_JSON_static_strlen(string_literal) (sizeof(string_literal) - sizeof(""))
 
-static MB_JSON_internal_hooks MB_JSON_global_hooks = {MB_JSON_internal_malloc, MB_JSON_internal_free, MB_JSON_internal_realloc};
+static MB_JSON_internal_hooks MB_JSON_global_hooks = {MB_JSON_internal_malloc, MB_JSON_internal_free, MB_JSON_internal_realloc, NULL};
 
 static unsigned char *MB_JSON_strdup(const unsigned char *string, const MB_JSON_internal_hooks *const hooks)
 {
@@ -255,13 +257,119 @@ MB_JSON_InitHooks(MB_JSON_Hooks *hooks)
     }
 }
 
+/* The arena block header, the block memory follows */
+typedef struct MB_JSON_ArenaBlock
+{
+    struct MB_JSON_ArenaBlock *next;
+    size_t size;
+    size_t used;
+} MB_JSON_ArenaBlock;
+
+/* keep the double of item aligned */
+#define MB_JSON_arena_align(size) (((size) + 7) & ~(size_t)7)
+#define MB_JSON_arena_header_size MB_JSON_arena_align(sizeof(MB_JSON_ArenaBlock))
+
+/* the MB_JSON arena bits, the memory of the item, valuestring and string which is freed with the arena */
+#define MB_JSON_arena_item 1
+#define MB_JSON_arena_value 2
+#define MB_JSON_arena_name 4
+
+static void *MB_JSON_arena_allocate(MB_JSON_Arena *arena, size_t size)
+{
+    MB_JSON_ArenaBlock *block = arena->blocks;
+    size_t block_size = arena->block_size;
+    MB_JSON_bool large = false;
+    void *pointer = NULL;
+
+    size = MB_JSON_arena_align(size);
+
+    if ((block == NULL) || (block->size - block->used < size))
+    {
+        /* the next block is double for the less blocks */
+        if (block != NULL)
+        {
+            block_size = block->size * 2;
+            if (block_size > MB_JSON_ARENA_MAX_BLOCK_SIZE)
+            {
+                block_size = MB_JSON_ARENA_MAX_BLOCK_SIZE > arena->block_size ? MB_JSON_ARENA_MAX_BLOCK_SIZE : arena->block_size;
+            }
+        }
+
+        if (size > block_size)
+        {
+            block_size = size;
+            large = true;
+        }
+
+        block = (MB_JSON_ArenaBlock *)MB_JSON_global_hooks.allocate(MB_JSON_arena_header_size + block_size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+
+        block->size = block_size;
+        block->used = 0;
+
+        if (arena->blocks == NULL)
+        {
+            block->next = NULL;
+            arena->blocks = block;
+        }
+        else if (large)
+        {
+            /* the large string has its own block, the current block is still used for the rest */
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        }
+        else
+        {
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+    }
+
+    pointer = (unsigned char *)block + MB_JSON_arena_header_size + block->used;
+    block->used += size;
+
+    return pointer;
+}
+
+/* allocate from the arena of the parsed tree or with the hooks */
+static void *MB_JSON_allocate(const MB_JSON_internal_hooks *const hooks, size_t size)
+{
+    if (hooks->arena != NULL)
+    {
+        return MB_JSON_arena_allocate(hooks->arena, size);
+    }
+
+    return hooks->allocate(size);
+}
+
+/* Counts the changes of item chains and allocations, the array cursor of older revision is stale.
+ * The trees can be changed from more than one task (ESP32), the counter is updated atomically where the tasks run
+ * on more than one core, ESP8266 has no tasks and no atomic instructions. */
+static size_t MB_JSON_revision = 0;
+
+#if defined(__GNUC__) && !defined(ESP8266)
+#define MB_JSON_next_revision() __atomic_add_fetch(&MB_JSON_revision, 1, __ATOMIC_RELAXED)
+#define MB_JSON_current_revision() __atomic_load_n(&MB_JSON_revision, __ATOMIC_RELAXED)
+#else
+#define MB_JSON_next_revision() (++MB_JSON_revision)
+#define MB_JSON_current_revision() (MB_JSON_revision)
+#endif
+
 /* Internal constructor. */
 static MB_JSON *MB_JSON_New_Item(const MB_JSON_internal_hooks *const hooks)
 {
-    MB_JSON *node = (MB_JSON *)hooks->allocate(sizeof(MB_JSON));
+    MB_JSON *node = (MB_JSON *)MB_JSON_allocate(hooks, sizeof(MB_JSON));
+    MB_JSON_next_revision();
     if (node)
     {
         memset(node, '\0', sizeof(MB_JSON));
+        if (hooks->arena != NULL)
+        {
+            node->arena = MB_JSON_arena_item;
+        }
     }
 
     return node;
@@ -272,6 +380,7 @@ MB_JSON_PUBLIC(void)
 MB_JSON_Delete(MB_JSON *item)
 {
     MB_JSON *next = NULL;
+    MB_JSON_next_revision();
     while (item != NULL)
     {
         next = item->next;
@@ -279,15 +388,18 @@ MB_JSON_Delete(MB_JSON *item)
         {
             MB_JSON_Delete(item->child);
         }
-        if (!(item->type & MB_JSON_IsReference) && (item->valuestring != NULL))
+        if (!(item->type & MB_JSON_IsReference) && !(item->arena & MB_JSON_arena_value) && (item->valuestring != NULL))
         {
             MB_JSON_global_hooks.deallocate(item->valuestring);
         }
-        if (!(item->type & MB_JSON_StringIsConst) && (item->string != NULL))
+        if (!(item->type & MB_JSON_StringIsConst) && !(item->arena & MB_JSON_arena_name) && (item->string != NULL))
         {
             MB_JSON_global_hooks.deallocate(item->string);
         }
-        MB_JSON_global_hooks.deallocate(item);
+        if (!(item->arena & MB_JSON_arena_item))
+        {
+            MB_JSON_global_hooks.deallocate(item);
+        }
         item = next;
     }
 }
@@ -436,11 +548,12 @@ MB_JSON_SetValuestring(MB_JSON *object, const char *valuestring)
     {
         return NULL;
     }
-    if (object->valuestring != NULL)
+    if ((object->valuestring != NULL) && !(object->arena & MB_JSON_arena_value))
     {
-        MB_JSON_free(object->valuestring);
+        MB_JSON_global_hooks.deallocate(object->valuestring);
     }
     object->valuestring = copy;
+    object->arena &= ~MB_JSON_arena_value;
 
     return copy;
 }
@@ -454,6 +567,9 @@ typedef struct
     MB_JSON_bool noalloc;
     MB_JSON_bool format; /* is this print a formatted print */
     MB_JSON_internal_hooks hooks;
+    /* the buffer is written out to writer instead of reallocated when it is full */
+    MB_JSON_Writer writer;
+    void *writer_context;
 } MB_JSON_printbuffer;
 
 typedef struct
@@ -463,6 +579,21 @@ typedef struct
     MB_JSON_bool format;
 } MB_JSON_buffer_len_data_t;
 
+/* write out the printed content of MB_JSON_printbuffer and start over from the buffer beginning */
+static MB_JSON_bool MB_JSON_flush(MB_JSON_printbuffer *const p)
+{
+    size_t length = p->offset;
+
+    p->offset = 0;
+    if ((length > 0) && (p->writer(p->writer_context, (const char *)p->buffer, length) != length))
+    {
+        return false;
+    }
+    p->buffer[0] = '\0';
+
+    return true;
+}
+
 /* realloc MB_JSON_printbuffer if necessary to have at least "needed" bytes more */
 static unsigned char *MB_JSON_ensure(MB_JSON_printbuffer *const p, size_t needed)
 {
@@ -492,6 +623,16 @@ static unsigned char *MB_JSON_ensure(MB_JSON_printbuffer *const p, size_t needed
         return p->buffer + p->offset;
     }
 
+    if (p->writer != NULL)
+    {
+        needed -= p->offset;
+        if (!MB_JSON_flush(p) || (needed > p->length))
+        {
+            return NULL;
+        }
+        return p->buffer;
+    }
+
     if (p->noalloc)
     {
         return NULL;
@@ -833,7 +974,7 @@ static MB_JSON_bool MB_JSON_parse_string(MB_JSON *const item, MB_JSON_parse_buff
 
         /* This is at most how much we need for the output */
         allocation_length = (size_t)(input_end - MB_JSON_buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char *)input_buffer->hooks.allocate(allocation_length + sizeof(""));
+        output = (unsigned char *)MB_JSON_allocate(&input_buffer->hooks, allocation_length + sizeof(""));
         if (output == NULL)
         {
             goto fail; /* allocation failure */
@@ -902,6 +1043,10 @@ static MB_JSON_bool MB_JSON_parse_string(MB_JSON *const item, MB_JSON_parse_buff
 
     item->type = MB_JSON_String;
     item->valuestring = (char *)output;
+    if (input_buffer->hooks.arena != NULL)
+    {
+        item->arena |= MB_JSON_arena_value;
+    }
 
     input_buffer->offset = (size_t)(input_end - input_buffer->content);
     input_buffer->offset++;
@@ -909,7 +1054,7 @@ static MB_JSON_bool MB_JSON_parse_string(MB_JSON *const item, MB_JSON_parse_buff
     return true;
 
 fail:
-    if (output != NULL)
+    if ((output != NULL) && (input_buffer->hooks.arena == NULL))
     {
         input_buffer->hooks.deallocate(output);
     }
@@ -968,6 +1113,99 @@ static MB_JSON_bool MB_JSON_get_string_buffer_length_ptr(const unsigned char *co
 }
 
 /* Render the cstring provided to an escaped version that can be printed. */
+/* Copy the text to the writer buffer in pieces, for the text that is longer than the buffer. */
+static MB_JSON_bool MB_JSON_print_pieces(const unsigned char *input, size_t length, MB_JSON_printbuffer *const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    size_t piece = 0;
+
+    while (length > 0)
+    {
+        piece = output_buffer->length / 2;
+        if (piece > length)
+        {
+            piece = length;
+        }
+
+        output_pointer = MB_JSON_ensure(output_buffer, piece);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        memcpy(output_pointer, input, piece);
+        output_pointer[piece] = '\0';
+        output_buffer->offset += piece;
+        input += piece;
+        length -= piece;
+    }
+
+    return true;
+}
+
+/* Print the string with escaping one character at a time, for the string that is longer than the writer buffer. */
+static MB_JSON_bool MB_JSON_print_string_pieces(const unsigned char *input_pointer, MB_JSON_printbuffer *const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
+
+    if (!MB_JSON_print_pieces((const unsigned char *)"\"", 1, output_buffer))
+    {
+        return false;
+    }
+
+    for (; *input_pointer != '\0'; input_pointer++)
+    {
+        output_pointer = MB_JSON_ensure(output_buffer, 6);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+
+        length = 2;
+        output_pointer[0] = '\\';
+        switch (*input_pointer)
+        {
+        case '\\':
+        case '\"':
+            output_pointer[1] = *input_pointer;
+            break;
+        case '\b':
+            output_pointer[1] = 'b';
+            break;
+        case '\f':
+            output_pointer[1] = 'f';
+            break;
+        case '\n':
+            output_pointer[1] = 'n';
+            break;
+        case '\r':
+            output_pointer[1] = 'r';
+            break;
+        case '\t':
+            output_pointer[1] = 't';
+            break;
+        default:
+            if (*input_pointer > 31)
+            {
+                /* normal character, copy */
+                output_pointer[0] = *input_pointer;
+                length = 1;
+            }
+            else
+            {
+                /* escape and print as unicode codepoint */
+                sprintf((char *)output_pointer + 1, "u%04x", *input_pointer);
+                length = 6;
+            }
+            break;
+        }
+        output_pointer[length] = '\0';
+        output_buffer->offset += length;
+    }
+
+    return MB_JSON_print_pieces((const unsigned char *)"\"", 1, output_buffer);
+}
+
 static MB_JSON_bool MB_JSON_print_string_ptr(const unsigned char *const input, MB_JSON_printbuffer *const output_buffer)
 {
     const unsigned char *input_pointer = NULL;
@@ -1021,6 +1259,11 @@ static MB_JSON_bool MB_JSON_print_string_ptr(const unsigned char *const input, M
     }
     output_length = (size_t)(input_pointer - input) + escape_characters;
 
+    if ((output_buffer->writer != NULL) && (output_length + sizeof("\"\"") >= output_buffer->length))
+    {
+        return MB_JSON_print_string_pieces(input, output_buffer);
+    }
+
     output = MB_JSON_ensure(output_buffer, output_length + sizeof("\"\""));
     if (output == NULL)
     {
@@ -1171,10 +1414,9 @@ MB_JSON_ParseWithOpts(const char *value, const char **return_parse_end, MB_JSON_
 }
 
 /* Parse an object - create a new root, and populate. */
-MB_JSON_PUBLIC(MB_JSON *)
-MB_JSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, MB_JSON_bool require_null_terminated)
+static MB_JSON *MB_JSON_parse_with_hooks(const char *value, size_t buffer_length, const char **return_parse_end, MB_JSON_bool require_null_terminated, const MB_JSON_internal_hooks *const hooks)
 {
-    MB_JSON_parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
+    MB_JSON_parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0, 0}};
     MB_JSON *item = NULL;
 
     /* reset error position */
@@ -1189,9 +1431,9 @@ MB_JSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char
     buffer.content = (const unsigned char *)value;
     buffer.length = buffer_length;
     buffer.offset = 0;
-    buffer.hooks = MB_JSON_global_hooks;
+    buffer.hooks = *hooks;
 
-    item = MB_JSON_New_Item(&MB_JSON_global_hooks);
+    item = MB_JSON_New_Item(hooks);
     if (item == NULL) /* memory fail */
     {
         goto fail;
@@ -1251,6 +1493,52 @@ fail:
     return NULL;
 }
 
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, MB_JSON_bool require_null_terminated)
+{
+    return MB_JSON_parse_with_hooks(value, buffer_length, return_parse_end, require_null_terminated, &MB_JSON_global_hooks);
+}
+
+MB_JSON_PUBLIC(void)
+MB_JSON_InitArena(MB_JSON_Arena *arena, size_t block_size)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    arena->blocks = NULL;
+    arena->block_size = block_size > 0 ? block_size : MB_JSON_ARENA_BLOCK_SIZE;
+}
+
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_ParseWithArena(const char *value, size_t buffer_length, const char **return_parse_end, MB_JSON_bool require_null_terminated, MB_JSON_Arena *arena)
+{
+    /* the arena is passed with the hooks of this parse only */
+    MB_JSON_internal_hooks hooks = MB_JSON_global_hooks;
+    hooks.arena = arena;
+
+    return MB_JSON_parse_with_hooks(value, buffer_length, return_parse_end, require_null_terminated, &hooks);
+}
+
+MB_JSON_PUBLIC(void)
+MB_JSON_FreeArena(MB_JSON_Arena *arena)
+{
+    MB_JSON_ArenaBlock *block = NULL;
+
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    while (arena->blocks != NULL)
+    {
+        block = arena->blocks;
+        arena->blocks = block->next;
+        MB_JSON_global_hooks.deallocate(block);
+    }
+}
+
 /* Default options for MB_JSON_Parse */
 MB_JSON_PUBLIC(MB_JSON *)
 MB_JSON_Parse(const char *value)
@@ -1358,7 +1646,7 @@ MB_JSON_PrintUnformatted(const MB_JSON *item)
 MB_JSON_PUBLIC(char *)
 MB_JSON_PrintBuffered(const MB_JSON *item, int prebuffer, MB_JSON_bool fmt)
 {
-    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}};
+    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0, 0}, 0, 0};
 
     if (prebuffer < 0)
     {
@@ -1389,7 +1677,7 @@ MB_JSON_PrintBuffered(const MB_JSON *item, int prebuffer, MB_JSON_bool fmt)
 MB_JSON_PUBLIC(MB_JSON_bool)
 MB_JSON_PrintPreallocated(MB_JSON *item, char *buffer, const int length, const MB_JSON_bool format)
 {
-    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}};
+    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0, 0}, 0, 0};
 
     if ((length < 0) || (buffer == NULL))
     {
@@ -1406,6 +1694,34 @@ MB_JSON_PrintPreallocated(MB_JSON *item, char *buffer, const int length, const M
     return MB_JSON_print_value(item, &p);
 }
 
+MB_JSON_PUBLIC(MB_JSON_bool)
+MB_JSON_PrintToWriter(const MB_JSON *item, char *buffer, const int length, const MB_JSON_bool format, MB_JSON_Writer writer, void *context)
+{
+    MB_JSON_printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0, 0}, 0, 0};
+
+    if ((item == NULL) || (buffer == NULL) || (length < MB_JSON_WRITER_MIN_BUFFER_SIZE) || (writer == NULL))
+    {
+        return false;
+    }
+
+    p.buffer = (unsigned char *)buffer;
+    p.length = (size_t)length;
+    p.offset = 0;
+    p.noalloc = true;
+    p.format = format;
+    p.hooks = MB_JSON_global_hooks;
+    p.writer = writer;
+    p.writer_context = context;
+
+    if (!MB_JSON_print_value(item, &p))
+    {
+        return false;
+    }
+    MB_JSON_update_offset(&p);
+
+    return MB_JSON_flush(&p);
+}
+
 /* Parser core - when encountering text, process appropriately. */
 static MB_JSON_bool MB_JSON_parse_value(MB_JSON *const item, MB_JSON_parse_buffer *const input_buffer)
 {
@@ -1555,6 +1871,11 @@ static MB_JSON_bool MB_JSON_print_value(const MB_JSON *const item, MB_JSON_print
         }
 
         raw_length = strlen(item->valuestring) + sizeof("");
+        if ((output_buffer->writer != NULL) && (raw_length >= output_buffer->length))
+        {
+            return MB_JSON_print_pieces((const unsigned char *)item->valuestring, raw_length - 1, output_buffer);
+        }
+
         output = MB_JSON_ensure(output_buffer, raw_length);
         if (output == NULL)
         {
@@ -1927,6 +2248,10 @@ static MB_JSON_bool MB_JSON_parse_object(MB_JSON *const item, MB_JSON_parse_buff
         /* swap valuestring and string, because we parsed the name */
         current_item->string = current_item->valuestring;
         current_item->valuestring = NULL;
+        if (current_item->arena & MB_JSON_arena_value)
+        {
+            current_item->arena = (unsigned char)((current_item->arena & ~MB_JSON_arena_value) | MB_JSON_arena_name);
+        }
 
         if (MB_JSON_cannot_access_at_index(input_buffer, 0) || (MB_JSON_buffer_at_offset(input_buffer)[0] != ':'))
         {
@@ -2201,6 +2526,111 @@ MB_JSON_GetArrayItem(const MB_JSON *array, int index)
     return MB_JSON_get_array_item(array, (size_t)index);
 }
 
+MB_JSON_PUBLIC(void)
+MB_JSON_ResetArrayCursor(MB_JSON_ArrayCursor *cursor)
+{
+    if (cursor == NULL)
+    {
+        return;
+    }
+
+    cursor->array = NULL;
+    cursor->item = NULL;
+    cursor->index = -1;
+    cursor->size = -1;
+    cursor->revision = 0;
+}
+
+/* reset the cursor that was used with other array or before the chains were changed */
+static void MB_JSON_check_array_cursor(const MB_JSON *array, MB_JSON_ArrayCursor *cursor)
+{
+    size_t revision = MB_JSON_current_revision();
+    if ((cursor->array != array) || (cursor->revision != revision))
+    {
+        MB_JSON_ResetArrayCursor(cursor);
+        cursor->array = array;
+        cursor->revision = revision;
+    }
+}
+
+MB_JSON_PUBLIC(int)
+MB_JSON_GetArraySizeCursor(const MB_JSON *array, MB_JSON_ArrayCursor *cursor)
+{
+    if ((cursor == NULL) || (array == NULL))
+    {
+        return MB_JSON_GetArraySize(array);
+    }
+
+    MB_JSON_check_array_cursor(array, cursor);
+
+    if (cursor->size < 0)
+    {
+        cursor->size = MB_JSON_GetArraySize(array);
+    }
+
+    return cursor->size;
+}
+
+MB_JSON_PUBLIC(MB_JSON *)
+MB_JSON_GetArrayItemCursor(const MB_JSON *array, int index, MB_JSON_ArrayCursor *cursor)
+{
+    MB_JSON *current_child = NULL;
+    int position = 0;
+    int distance = index;
+
+    if ((cursor == NULL) || (array == NULL) || (index < 0))
+    {
+        return MB_JSON_GetArrayItem(array, index);
+    }
+
+    MB_JSON_check_array_cursor(array, cursor);
+
+    if ((cursor->size > -1) && (index >= cursor->size))
+    {
+        return NULL;
+    }
+
+    /* start from the nearest of the head, the cursor item and the tail (head->prev) */
+    current_child = array->child;
+
+    if ((cursor->item != NULL) && (abs(index - cursor->index) < distance))
+    {
+        current_child = cursor->item;
+        position = cursor->index;
+        distance = abs(index - cursor->index);
+    }
+
+    if ((cursor->size > 0) && (cursor->size - 1 - index < distance) && (array->child->prev != NULL))
+    {
+        current_child = array->child->prev;
+        position = cursor->size - 1;
+    }
+
+    while ((current_child != NULL) && (position > index))
+    {
+        position--;
+        current_child = current_child->prev;
+    }
+
+    while ((current_child != NULL) && (position < index))
+    {
+        position++;
+        current_child = current_child->next;
+    }
+
+    if (current_child == NULL)
+    {
+        /* passed the last item, the size is known now */
+        cursor->size = position;
+        return NULL;
+    }
+
+    cursor->item = current_child;
+    cursor->index = index;
+
+    return current_child;
+}
+
 static MB_JSON *MB_JSON_get_object_item(const MB_JSON *const object, const char *const name, const MB_JSON_bool case_sensitive)
 {
     MB_JSON *current_element = NULL;
@@ -2277,6 +2707,8 @@ static MB_JSON *MB_JSON_create_reference(const MB_JSON *item, const MB_JSON_inte
     memcpy(reference, item, sizeof(MB_JSON));
     reference->string = NULL;
     reference->type |= MB_JSON_IsReference;
+    /* the reference is from the hooks, its valuestring is not freed */
+    reference->arena = 0;
     reference->next = reference->prev = NULL;
     return reference;
 }
@@ -2290,6 +2722,8 @@ static MB_JSON_bool MB_JSON_add_item_to_array(MB_JSON *array, MB_JSON *item)
         return false;
     }
 
+    MB_JSON_next_revision();
+
     child = array->child;
     /*
      * To find the last item in array quickly, we use prev in array
@@ -2362,13 +2796,14 @@ static MB_JSON_bool MB_JSON_add_item_to_object(MB_JSON *const object, const char
         new_type = item->type & ~MB_JSON_StringIsConst;
     }
 
-    if (!(item->type & MB_JSON_StringIsConst) && (item->string != NULL))
+    if (!(item->type & MB_JSON_StringIsConst) && !(item->arena & MB_JSON_arena_name) && (item->string != NULL))
     {
         hooks->deallocate(item->string);
     }
 
     item->string = new_key;
     item->type = new_type;
+    item->arena &= ~MB_JSON_arena_name;
 
     return MB_JSON_add_item_to_array(object, item);
 }
@@ -2533,6 +2968,8 @@ MB_JSON_DetachItemViaPointer(MB_JSON *parent, MB_JSON *const item)
         return NULL;
     }
 
+    MB_JSON_next_revision();
+
     if (item != parent->child)
     {
         /* not the first element */
@@ -2624,6 +3061,8 @@ MB_JSON_InsertItemInArray(MB_JSON *array, int which, MB_JSON *newitem)
         return MB_JSON_add_item_to_array(array, newitem);
     }
 
+    MB_JSON_next_revision();
+
     newitem->next = after_inserted;
     newitem->prev = after_inserted->prev;
     after_inserted->prev = newitem;
@@ -2651,6 +3090,8 @@ MB_JSON_ReplaceItemViaPointer(MB_JSON *const parent, MB_JSON *const item, MB_JSO
         return true;
     }
 
+    MB_JSON_next_revision();
+
     replacement->next = item->next;
     replacement->prev = item->prev;
 
@@ -2707,12 +3148,13 @@ static MB_JSON_bool MB_JSON_replace_item_in_object(MB_JSON *object, const char *
     }
 
     /* replace the name in the replacement */
-    if (!(replacement->type & MB_JSON_StringIsConst) && (replacement->string != NULL))
+    if (!(replacement->type & MB_JSON_StringIsConst) && !(replacement->arena & MB_JSON_arena_name) && (replacement->string != NULL))
     {
         MB_JSON_free(replacement->string);
     }
     replacement->string = (char *)MB_JSON_strdup((const unsigned char *)string, &MB_JSON_global_hooks);
     replacement->type &= ~MB_JSON_StringIsConst;
+    replacement->arena &= ~MB_JSON_arena_name;
 
     return MB_JSON_ReplaceItemViaPointer(object, MB_JSON_get_object_item(object, string, case_sensitive), replacement);
 }
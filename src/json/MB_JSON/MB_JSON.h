@@ -128,6 +128,9 @@ typedef struct MB_JSON
 
     /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
     char *string;
+
+    /* internal, the item, valuestring and string that were taken from the arena and are not freed by MB_JSON_Delete */
+    unsigned char arena;
 } MB_JSON;
 
 typedef struct MB_JSON_Hooks
@@ -138,8 +141,49 @@ typedef struct MB_JSON_Hooks
       void *(MB_JSON_CDECL *realloc_fn)(void *ptr, size_t sz);
 } MB_JSON_Hooks;
 
+/* The position of the last item accessed in an array, owned by the caller and passed to the Cursor functions.
+ * The sequential or nearby access then continues from this item instead of walking from the first item.
+ * The cursor is stale and rebuilt by itself after any item was added, removed or freed. */
+typedef struct MB_JSON_ArrayCursor
+{
+    const struct MB_JSON *array;
+    struct MB_JSON *item;
+    int index;
+    /* the array size or -1 if not counted yet */
+    int size;
+    size_t revision;
+} MB_JSON_ArrayCursor;
+
+#ifndef MB_JSON_ARENA_BLOCK_SIZE
+#define MB_JSON_ARENA_BLOCK_SIZE 512
+#endif
+
+/* the limit of block size doubling */
+#ifndef MB_JSON_ARENA_MAX_BLOCK_SIZE
+#define MB_JSON_ARENA_MAX_BLOCK_SIZE 4096
+#endif
+
+/* The arena that the items and strings of a parsed tree are taken from, the first block is block_size bytes and
+ * the next blocks are double up to MB_JSON_ARENA_MAX_BLOCK_SIZE.
+ * The whole tree memory is released at once by MB_JSON_FreeArena, MB_JSON_Delete only frees the memory of the tree that was not from arena.
+ * Each tree has its own arena, the items record what was taken from it. */
+struct MB_JSON_ArenaBlock;
+typedef struct MB_JSON_Arena
+{
+    struct MB_JSON_ArenaBlock *blocks;
+    size_t block_size;
+} MB_JSON_Arena;
+
 typedef int MB_JSON_bool;
 
+/* The output function of MB_JSON_PrintToWriter, returns the number of bytes written. */
+typedef size_t (*MB_JSON_Writer)(void *context, const char *data, size_t length);
+
+/* the smallest buffer of MB_JSON_PrintToWriter, the number and the escaped character are not split */
+#ifndef MB_JSON_WRITER_MIN_BUFFER_SIZE
+#define MB_JSON_WRITER_MIN_BUFFER_SIZE 32
+#endif
+
 /* Limits how deeply nested arrays/objects can be before MB_JSON rejects to parse them.
  * This is to prevent stack overflows. */
 #ifndef MB_JSON_NESTING_LIMIT
@@ -164,6 +208,12 @@ MB_JSON_PUBLIC(MB_JSON *) MB_JSON_ParseWithLength(const char *value, size_t buff
 MB_JSON_PUBLIC(MB_JSON *) MB_JSON_ParseWithOpts(const char *value, const char **return_parse_end, MB_JSON_bool require_null_terminated);
 MB_JSON_PUBLIC(MB_JSON *) MB_JSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, MB_JSON_bool require_null_terminated);
 
+/* Parse with the items and strings allocated from arena (block_size of 0 is MB_JSON_ARENA_BLOCK_SIZE).
+ * The tree should be deleted before MB_JSON_FreeArena, the arenas of different trees can be used from different tasks. */
+MB_JSON_PUBLIC(void) MB_JSON_InitArena(MB_JSON_Arena *arena, size_t block_size);
+MB_JSON_PUBLIC(MB_JSON *) MB_JSON_ParseWithArena(const char *value, size_t buffer_length, const char **return_parse_end, MB_JSON_bool require_null_terminated, MB_JSON_Arena *arena);
+MB_JSON_PUBLIC(void) MB_JSON_FreeArena(MB_JSON_Arena *arena);
+
 /* Render a MB_JSON entity to text for transfer/storage. */
 MB_JSON_PUBLIC(char *) MB_JSON_Print(const MB_JSON *item);
 /* Render a MB_JSON entity to text for transfer/storage without any formatting. */
@@ -173,6 +223,10 @@ MB_JSON_PUBLIC(char *) MB_JSON_PrintBuffered(const MB_JSON *item, int prebuffer,
 /* Render a MB_JSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
 /* NOTE: MB_JSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
 MB_JSON_PUBLIC(MB_JSON_bool) MB_JSON_PrintPreallocated(MB_JSON *item, char *buffer, const int length, const MB_JSON_bool format);
+/* Render a MB_JSON entity to writer through the buffer, the buffer is written out whenever it is full, the long string is written in pieces.
+ * No memory is allocated, the buffer should be at least MB_JSON_WRITER_MIN_BUFFER_SIZE bytes and larger than the nesting depth for the formatted print.
+ * Returns 1 on success and 0 on failure or when writer did not take all bytes. */
+MB_JSON_PUBLIC(MB_JSON_bool) MB_JSON_PrintToWriter(const MB_JSON *item, char *buffer, const int length, const MB_JSON_bool format, MB_JSON_Writer writer, void *context);
 /* Delete a MB_JSON entity and all subentities. */
 MB_JSON_PUBLIC(void) MB_JSON_Delete(MB_JSON *item);
 
@@ -180,6 +234,10 @@ MB_JSON_PUBLIC(void) MB_JSON_Delete(MB_JSON *item);
 MB_JSON_PUBLIC(int) MB_JSON_GetArraySize(const MB_JSON *array);
 /* Retrieve item number "index" from array "array". Returns NULL if unsuccessful. */
 MB_JSON_PUBLIC(MB_JSON *) MB_JSON_GetArrayItem(const MB_JSON *array, int index);
+/* Same as GetArraySize/GetArrayItem but start from the item of cursor, the head or the tail whichever is nearest. cursor can be NULL. */
+MB_JSON_PUBLIC(void) MB_JSON_ResetArrayCursor(MB_JSON_ArrayCursor *cursor);
+MB_JSON_PUBLIC(int) MB_JSON_GetArraySizeCursor(const MB_JSON *array, MB_JSON_ArrayCursor *cursor);
+MB_JSON_PUBLIC(MB_JSON *) MB_JSON_GetArrayItemCursor(const MB_JSON *array, int index, MB_JSON_ArrayCursor *cursor);
 /* Get item "string" from object. Case insensitive. */
 MB_JSON_PUBLIC(MB_JSON *) MB_JSON_GetObjectItem(const MB_JSON * const object, const char * const string);
 MB_JSON_PUBLIC(MB_JSON *) MB_JSON_GetObjectItemCaseSensitive(const MB_JSON * const object, const char * const string);
@@ -0,0 +1,539 @@
+/**
+ * The MB_JSONReader, streaming (SAX style) JSON reader class v1.0.0
+ *
+ * The JSON text is fed in chunks of any size or read from Stream in buffered chunks,
+ * the visitor is called for each object, array, key and value as they were read.
+ * The memory used is the fixed token buffer and the nesting stack, no tree is built.
+ *
+ * The value types are the MB_JSON types, MB_JSON_False, MB_JSON_True, MB_JSON_NULL, MB_JSON_Number and MB_JSON_String.
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2022 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MB_JSON_READER_H
+#define MB_JSON_READER_H
+
+#include <Arduino.h>
+#include "MB_JSON/MB_JSON.h"
+
+// the longest key or number text and the piece size of the longer string value
+#ifndef MB_JSON_READER_TOKEN_SIZE
+#define MB_JSON_READER_TOKEN_SIZE 256
+#endif
+
+#ifndef MB_JSON_READER_MAX_DEPTH
+#define MB_JSON_READER_MAX_DEPTH 32
+#endif
+
+// the chunk size of Stream reading
+#ifndef MB_JSON_READER_BUFFER_SIZE
+#define MB_JSON_READER_BUFFER_SIZE 128
+#endif
+
+#define MB_JSON_READER_ERROR_SYNTAX -1
+#define MB_JSON_READER_ERROR_TOKEN_SIZE -2
+#define MB_JSON_READER_ERROR_DEPTH -3
+#define MB_JSON_READER_ERROR_STOPPED -4
+#define MB_JSON_READER_ERROR_INCOMPLETE -5
+
+typedef struct mb_json_reader_value_t
+{
+    int type = MB_JSON_NULL;
+    // the string or the text of number and literal, null terminated
+    const char *str = nullptr;
+    size_t len = 0;
+    double number = 0;
+    // the string is continued in the next value call, the long string is passed in pieces
+    bool more = false;
+} mb_json_reader_value_t;
+
+class MB_JSONVisitor
+{
+public:
+    virtual ~MB_JSONVisitor(){};
+
+    // the visitor returns false to stop reading
+    virtual bool startObject() { return true; }
+    virtual bool endObject() { return true; }
+    virtual bool startArray() { return true; }
+    virtual bool endArray() { return true; }
+
+    /**
+     * The object member key.
+     * @param key The unescaped key, valid until this function returns.
+     * @param len The length of key.
+     */
+    virtual bool key(const char * /* key */, size_t /* len */) { return true; }
+
+    /**
+     * The scalar value, the object and array are reported by start and end functions.
+     * @param value The value, its string is valid until this function returns.
+     *
+     * @note The string value longer than MB_JSON_READER_TOKEN_SIZE - 1 is passed in pieces, value.more is true
+     * for all pieces except the last one. The piece may end in the middle of the UTF-8 character.
+     */
+    virtual bool value(const mb_json_reader_value_t & /* value */) { return true; }
+};
+
+class MB_JSONReader
+{
+public:
+    MB_JSONReader(MB_JSONVisitor &visitor) : _visitor(visitor) {}
+    ~MB_JSONReader(){};
+
+    void reset()
+    {
+        _state = state_value;
+        _depth = 0;
+        _len = 0;
+        _error = 0;
+        _pos = 0;
+        _surrogate = 0;
+    }
+
+    /**
+     * Read the next chunk of JSON text.
+     * @param data The data.
+     * @param len The length of data.
+     * @return The boolean value indicates no error, see error().
+     */
+    bool parse(const char *data, size_t len)
+    {
+        size_t i = 0;
+
+        while (i < len && _error == 0)
+        {
+            if (step(data[i]))
+            {
+                i++;
+                _pos++;
+            }
+        }
+
+        return _error == 0;
+    }
+
+    /**
+     * End the JSON text.
+     * @return The boolean value indicates the complete JSON text was read.
+     */
+    bool end()
+    {
+        // the number or literal at the top level ends with the text
+        if (_error == 0 && (_state == state_number || _state == state_literal))
+            step(' ');
+
+        if (_error == 0 && _state != state_done)
+            _error = MB_JSON_READER_ERROR_INCOMPLETE;
+
+        return _error == 0;
+    }
+
+    /**
+     * Read the JSON text from stream until no data available.
+     * @param stream The Stream or File object.
+     * @return The boolean value indicates the complete JSON text was read.
+     */
+    bool read(Stream &stream)
+    {
+        char buf[MB_JSON_READER_BUFFER_SIZE];
+
+        reset();
+
+        while (stream.available() > 0)
+        {
+            size_t n = stream.available();
+            if (n > sizeof(buf))
+                n = sizeof(buf);
+
+            n = stream.readBytes(buf, n);
+            if (n == 0)
+                break;
+
+            if (!parse(buf, n))
+                return false;
+        }
+
+        return end();
+    }
+
+    // the error code or 0 for no error
+    int error() const { return _error; }
+
+    // the number of bytes read
+    size_t position() const { return _pos; }
+
+    // the nesting level of the current object or array
+    size_t depth() const { return _depth; }
+
+private:
+    typedef enum
+    {
+        state_value,
+        state_value_or_end,
+        state_key,
+        state_key_or_end,
+        state_colon,
+        state_after_value,
+        state_string,
+        state_escape,
+        state_unicode,
+        state_number,
+        state_literal,
+        state_done
+    } mb_json_reader_state;
+
+    MB_JSONVisitor &_visitor;
+    uint8_t _state = state_value;
+    uint8_t _stack[MB_JSON_READER_MAX_DEPTH];
+    size_t _depth = 0;
+    char _token[MB_JSON_READER_TOKEN_SIZE];
+    size_t _len = 0;
+    bool _isKey = false;
+    uint8_t _hexCount = 0;
+    uint32_t _codepoint = 0;
+    uint32_t _surrogate = 0;
+    int _error = 0;
+    size_t _pos = 0;
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    bool fail(int code)
+    {
+        _error = code;
+        return false;
+    }
+
+    // the visitor result
+    bool visit(bool ret)
+    {
+        if (!ret)
+            _error = MB_JSON_READER_ERROR_STOPPED;
+        return ret;
+    }
+
+    bool append(char c)
+    {
+        // keep the space for null terminator
+        if (_len + 1 >= sizeof(_token))
+        {
+            // the string value is passed in pieces, the key and number should fit the buffer
+            if (_state != state_string || _isKey || !emitPiece())
+                return _error == 0 ? fail(MB_JSON_READER_ERROR_TOKEN_SIZE) : false;
+        }
+        _token[_len++] = c;
+        return true;
+    }
+
+    // pass the full token buffer as the string piece and continue the string from the empty buffer
+    bool emitPiece()
+    {
+        mb_json_reader_value_t v;
+        _token[_len] = 0;
+        v.type = MB_JSON_String;
+        v.str = _token;
+        v.len = _len;
+        v.more = true;
+        _len = 0;
+        return visit(_visitor.value(v));
+    }
+
+    bool appendUTF8(uint32_t cp)
+    {
+        if (cp < 0x80)
+            return append(cp);
+        if (cp < 0x800)
+            return append(0xc0 | (cp >> 6)) && append(0x80 | (cp & 0x3f));
+        if (cp < 0x10000)
+            return append(0xe0 | (cp >> 12)) && append(0x80 | ((cp >> 6) & 0x3f)) && append(0x80 | (cp & 0x3f));
+        return append(0xf0 | (cp >> 18)) && append(0x80 | ((cp >> 12) & 0x3f)) && append(0x80 | ((cp >> 6) & 0x3f)) && append(0x80 | (cp & 0x3f));
+    }
+
+    void afterValue() { _state = _depth == 0 ? state_done : state_after_value; }
+
+    bool push(char c)
+    {
+        if (_depth == MB_JSON_READER_MAX_DEPTH)
+            return fail(MB_JSON_READER_ERROR_DEPTH);
+
+        _stack[_depth++] = c;
+
+        if (c == '{')
+        {
+            _state = state_key_or_end;
+            return visit(_visitor.startObject());
+        }
+
+        _state = state_value_or_end;
+        return visit(_visitor.startArray());
+    }
+
+    bool pop(char c)
+    {
+        if (_depth == 0 || _stack[_depth - 1] != c)
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+
+        _depth--;
+        afterValue();
+        return visit(c == '{' ? _visitor.endObject() : _visitor.endArray());
+    }
+
+    bool emit(int type)
+    {
+        mb_json_reader_value_t v;
+        _token[_len] = 0;
+        v.type = type;
+        v.str = _token;
+        v.len = _len;
+        afterValue();
+
+        if (type == MB_JSON_Number)
+        {
+            char *end = nullptr;
+            v.number = strtod(_token, &end);
+            if (end != _token + _len)
+                return fail(MB_JSON_READER_ERROR_SYNTAX);
+        }
+
+        return visit(_visitor.value(v));
+    }
+
+    bool endLiteral()
+    {
+        _token[_len] = 0;
+        if (strcmp(_token, "true") == 0)
+            return emit(MB_JSON_True);
+        if (strcmp(_token, "false") == 0)
+            return emit(MB_JSON_False);
+        if (strcmp(_token, "null") == 0)
+            return emit(MB_JSON_NULL);
+        return fail(MB_JSON_READER_ERROR_SYNTAX);
+    }
+
+    bool endString()
+    {
+        if (_surrogate)
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+
+        if (!_isKey)
+            return emit(MB_JSON_String);
+
+        _token[_len] = 0;
+        _state = state_colon;
+        return visit(_visitor.key(_token, _len));
+    }
+
+    bool beginToken(uint8_t state, char c)
+    {
+        _state = state;
+        _len = 0;
+        return append(c);
+    }
+
+    bool hex(char c)
+    {
+        int d = -1;
+        if (c >= '0' && c <= '9')
+            d = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            d = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            d = c - 'A' + 10;
+
+        if (d < 0)
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+
+        _codepoint = (_codepoint << 4) | d;
+        if (++_hexCount < 4)
+            return true;
+
+        _state = state_string;
+
+        if (_codepoint >= 0xd800 && _codepoint <= 0xdbff)
+        {
+            // the low surrogate escape should follow
+            if (_surrogate)
+                return fail(MB_JSON_READER_ERROR_SYNTAX);
+            _surrogate = _codepoint;
+            return true;
+        }
+
+        if (_codepoint >= 0xdc00 && _codepoint <= 0xdfff)
+        {
+            if (!_surrogate)
+                return fail(MB_JSON_READER_ERROR_SYNTAX);
+            uint32_t cp = 0x10000 + ((_surrogate - 0xd800) << 10) + (_codepoint - 0xdc00);
+            _surrogate = 0;
+            return appendUTF8(cp);
+        }
+
+        if (_surrogate)
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+
+        return appendUTF8(_codepoint);
+    }
+
+    // process the character, returns false on error or when the character should be processed again in the new state
+    bool step(char c)
+    {
+        switch (_state)
+        {
+        case state_value_or_end:
+            if (isSpace(c))
+                return true;
+            if (c == ']')
+                return pop('[');
+            _state = state_value;
+            return false;
+
+        case state_value:
+            if (isSpace(c))
+                return true;
+            if (c == '{' || c == '[')
+                return push(c);
+            if (c == '"')
+            {
+                _isKey = false;
+                _len = 0;
+                _state = state_string;
+                return true;
+            }
+            if (c == '-' || (c >= '0' && c <= '9'))
+                return beginToken(state_number, c);
+            if (c >= 'a' && c <= 'z')
+                return beginToken(state_literal, c);
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+
+        case state_key_or_end:
+            if (isSpace(c))
+                return true;
+            if (c == '}')
+                return pop('{');
+            _state = state_key;
+            return false;
+
+        case state_key:
+            if (isSpace(c))
+                return true;
+            if (c == '"')
+            {
+                _isKey = true;
+                _len = 0;
+                _state = state_string;
+                return true;
+            }
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+
+        case state_colon:
+            if (isSpace(c))
+                return true;
+            if (c == ':')
+            {
+                _state = state_value;
+                return true;
+            }
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+
+        case state_after_value:
+            if (isSpace(c))
+                return true;
+            if (c == ',')
+            {
+                _state = _stack[_depth - 1] == '{' ? state_key : state_value;
+                return true;
+            }
+            if (c == '}')
+                return pop('{');
+            if (c == ']')
+                return pop('[');
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+
+        case state_string:
+            if (c == '\\')
+            {
+                _state = state_escape;
+                return true;
+            }
+            if (_surrogate || (uint8_t)c < 0x20)
+                return fail(MB_JSON_READER_ERROR_SYNTAX);
+            if (c == '"')
+                return endString();
+            return append(c);
+
+        case state_escape:
+            _state = state_string;
+            if (c == 'u')
+            {
+                _state = state_unicode;
+                _hexCount = 0;
+                _codepoint = 0;
+                return true;
+            }
+            if (_surrogate)
+                return fail(MB_JSON_READER_ERROR_SYNTAX);
+            switch (c)
+            {
+            case '"':
+            case '\\':
+            case '/':
+                return append(c);
+            case 'b':
+                return append('\b');
+            case 'f':
+                return append('\f');
+            case 'n':
+                return append('\n');
+            case 'r':
+                return append('\r');
+            case 't':
+                return append('\t');
+            default:
+                return fail(MB_JSON_READER_ERROR_SYNTAX);
+            }
+
+        case state_unicode:
+            return hex(c);
+
+        case state_number:
+            if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')
+                return append(c);
+            emit(MB_JSON_Number);
+            return false;
+
+        case state_literal:
+            if (c >= 'a' && c <= 'z')
+                return append(c);
+            endLiteral();
+            return false;
+
+        case state_done:
+            if (isSpace(c))
+                return true;
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+
+        default:
+            return fail(MB_JSON_READER_ERROR_SYNTAX);
+        }
+    }
+};
+
+#endif
@@ -142,7 +142,7 @@ namespace mb_string
     {
 
     public:
-        mb_string_ptr_t(uint32_t addr = 0, mb_string_sub_type type = mb_string_sub_type_cstring, int precision = -1, const StringSumHelper *s = nullptr)
+        mb_string_ptr_t(uintptr_t addr = 0, mb_string_sub_type type = mb_string_sub_type_cstring, int precision = -1, const StringSumHelper *s = nullptr)
         {
             _addr = addr;
             _type = type;
@@ -151,13 +151,13 @@ namespace mb_string
         }
         int precision() { return _precision; }
         mb_string_sub_type type() { return _type; }
-        uint32_t address() { return _addr; }
+        uintptr_t address() { return _addr; }
         const StringSumHelper *stringsumhelper() { return _ssh; }
 
     private:
         mb_string_sub_type _type = mb_string_sub_type_none;
         int _precision = -1;
-        uint32_t _addr = 0;
+        uintptr_t _addr = 0;
         const StringSumHelper *_ssh = nullptr;
 
     } MB_StringPtr;
@@ -384,17 +384,17 @@ namespace mb_string
     };
 
     template <typename T>
-    uint32_t toAddr(T &v) { return reinterpret_cast<uint32_t>(&v); }
+    uintptr_t toAddr(T &v) { return reinterpret_cast<uintptr_t>(&v); }
 
 #if defined(__AVR__)
     template <typename T>
-    T addrTo(int address)
+    T addrTo(uintptr_t address)
     {
         return reinterpret_cast<T>(address);
     }
 #else
     template <typename T>
-    auto addrTo(int address) -> typename MB_ENABLE_IF<!MB_IS_SAME<T, nullptr_t>::value, T>::type
+    auto addrTo(uintptr_t address) -> typename MB_ENABLE_IF<!MB_IS_SAME<T, nullptr_t>::value, T>::type
     {
         return reinterpret_cast<T>(address);
     }
@@ -1345,20 +1345,9 @@ public:
         if (length() == 0 || pos >= length())
             return -1;
 
-        int size = strcspn(buf + pos, cstr);
-        if (size == 0)
-        {
-            while (size == 0 && pos < length())
-            {
-                size = strcspn(buf + pos, cstr);
-                pos++;
-            }
-
-            if (pos > 0)
-                pos--;
-        }
+        pos += strspn(buf + pos, cstr);
 
-        return pos;
+        return pos < length() ? pos : npos;
     }
 
     size_t find_first_not_of(const MB_String &str, size_t pos = 0) const
@@ -1393,19 +1382,11 @@ public:
         if (pos >= length())
             pos = length() - 1;
 
-        int p = length() - 1;
-        int size = strcspn(buf + p, cstr);
-        if (size == 0)
-        {
-            while (size == 0 && p > 0)
-            {
-                size = strcspn(buf + p, cstr);
-                p--;
-            }
-            p++;
-        }
+        int p = pos;
+        while (p >= 0 && strchr(cstr, buf[p]))
+            p--;
 
-        return p;
+        return p >= 0 ? (size_t)p : npos;
     }
 
     size_t find_last_not_of(const MB_String &str, size_t pos = npos) const
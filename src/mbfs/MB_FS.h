@@ -1,5 +1,5 @@
 /**
- * The MB_FS, filesystems wrapper class v1.0.9
+ * The MB_FS, filesystems wrapper class v1.0.10
  *
  * This wrapper class is for SD and Flash filesystems interface which supports SdFat (//https://github.com/greiman/SdFat)
  *
@@ -49,6 +49,12 @@ using namespace mb_string;
 #define MB_FS_ERROR_FLASH_STORAGE_IS_NOT_READY -302
 #define MB_FS_ERROR_SD_STORAGE_IS_NOT_READY -303
 #define MB_FS_ERROR_FILE_STILL_OPENED -304
+#define MB_FS_ERROR_FILE_POOL_FULL -305
+
+// The number of files that can be opened at the same time with openHandle.
+#if !defined(MBFS_FILE_POOL_SIZE)
+#define MBFS_FILE_POOL_SIZE 4
+#endif
 
 typedef enum
 {
@@ -750,6 +756,136 @@ public:
     }
 #endif
 
+    // Open file in the file pool for read or write with file name, mb_fs_mem_storage_type and mb_fs_open_mode.
+    // The pool files are independent of the file opened with open and of each other.
+    // return the file handle or negative value for error
+    int openHandle(const MB_String &filename, mbfs_file_type type, mb_fs_open_mode mode)
+    {
+#if defined(MBFS_USE_FILE_STORAGE)
+
+        if (!checkStorageReady(type))
+        {
+            if (type == mbfs_flash)
+                return MB_FS_ERROR_FLASH_STORAGE_IS_NOT_READY;
+            else if (type == mbfs_sd)
+                return MB_FS_ERROR_SD_STORAGE_IS_NOT_READY;
+            else
+                return MB_FS_ERROR_FILE_IO_ERROR;
+        }
+
+        if (mode != mb_fs_open_mode_read && mode != mb_fs_open_mode_write && mode != mb_fs_open_mode_append)
+            return MB_FS_ERROR_FILE_IO_ERROR;
+
+        // reserve the handle before the file is touched, the full pool must not truncate the existing file
+        int handle = reserveHandle(type);
+        if (handle < 0)
+            return MB_FS_ERROR_FILE_POOL_FULL;
+
+        if (mode == mb_fs_open_mode_read)
+        {
+            if (!existed(filename.c_str(), type))
+            {
+                releaseHandle(handle);
+                return MB_FS_ERROR_FILE_NOT_FOUND;
+            }
+        }
+        else
+        {
+            if (mode == mb_fs_open_mode_write)
+                remove(filename, type);
+            createDirs(filename, type);
+        }
+
+        bool opened = false;
+
+#if defined(MBFS_FLASH_FS)
+        if (type == mbfs_flash)
+        {
+            file_pool[handle].flashFile = MBFS_FLASH_FS.open(filename.c_str(), mode == mb_fs_open_mode_read ? "r" : (mode == mb_fs_open_mode_write ? "w" : "a"));
+            opened = file_pool[handle].flashFile ? true : false;
+        }
+#endif
+
+#if defined(MBFS_SD_FS)
+        if (type == mbfs_sd)
+        {
+#if defined(MBFS_ESP32_SDFAT_ENABLED) || defined(MBFS_SDFAT_ENABLED)
+            opened = file_pool[handle].sdFile.open(filename.c_str(), mode == mb_fs_open_mode_read ? O_RDONLY : (O_RDWR | O_CREAT | O_APPEND));
+#else
+            if (mode == mb_fs_open_mode_read)
+                file_pool[handle].sdFile = MBFS_SD_FS.open(filename.c_str(), FILE_READ);
+#if defined(ESP32)
+            else if (mode == mb_fs_open_mode_append)
+                file_pool[handle].sdFile = MBFS_SD_FS.open(filename.c_str(), FILE_APPEND);
+#endif
+            else
+                file_pool[handle].sdFile = MBFS_SD_FS.open(filename.c_str(), FILE_WRITE);
+            opened = file_pool[handle].sdFile ? true : false;
+#endif
+        }
+#endif
+
+        if (!opened)
+        {
+            releaseHandle(handle);
+            return MB_FS_ERROR_FILE_IO_ERROR;
+        }
+
+        return handle;
+
+#endif
+        return MB_FS_ERROR_FILE_IO_ERROR;
+    }
+
+    // Close the file of handle and return it to the file pool.
+    void closeHandle(int handle)
+    {
+#if defined(MBFS_USE_FILE_STORAGE)
+        if (handle < 0 || handle >= MBFS_FILE_POOL_SIZE)
+            return;
+
+#if defined(MBFS_FLASH_FS)
+        if (file_pool[handle].type == mbfs_flash)
+            file_pool[handle].flashFile.close();
+#endif
+#if defined(MBFS_SD_FS)
+        if (file_pool[handle].type == mbfs_sd)
+            file_pool[handle].sdFile.close();
+#endif
+        releaseHandle(handle);
+#endif
+    }
+
+    // Get the number of handles that are not in use.
+    int freeHandles()
+    {
+        int count = 0;
+#if defined(MBFS_USE_FILE_STORAGE)
+        for (int i = 0; i < MBFS_FILE_POOL_SIZE; i++)
+        {
+            if (file_pool[i].type == mbfs_undefined)
+                count++;
+        }
+#endif
+        return count;
+    }
+
+// Get the Flash file instance of handle, the handle must be opened with mbfs_flash.
+#if defined(MBFS_FLASH_FS)
+    fs::File &getFlashFile(int handle)
+    {
+        return file_pool[handle].flashFile;
+    }
+#endif
+
+// Get the SD file instance of handle, the handle must be opened with mbfs_sd.
+#if defined(MBFS_SD_FS)
+    MBFS_SD_FILE &getSDFile(int handle)
+    {
+        return file_pool[handle].sdFile;
+    }
+#endif
+
     // Get name of opened file.
     const char *name(mbfs_file_type type)
     {
@@ -934,6 +1070,59 @@ private:
     MBFS_SD_FILE mb_sdFs;
 #endif
 
+#if defined(MBFS_USE_FILE_STORAGE)
+    struct mbfs_pool_item_t
+    {
+        // mbfs_undefined for the free handle
+        mbfs_file_type type = mbfs_undefined;
+#if defined(MBFS_FLASH_FS)
+        fs::File flashFile;
+#endif
+#if defined(MBFS_SD_FS)
+        MBFS_SD_FILE sdFile;
+#endif
+    };
+
+    mbfs_pool_item_t file_pool[MBFS_FILE_POOL_SIZE];
+#if defined(ESP32)
+    portMUX_TYPE pool_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+    // Take the free handle from the file pool, the web server may run in its own task (ESP32).
+    int reserveHandle(mbfs_file_type type)
+    {
+        int handle = -1;
+#if defined(ESP32)
+        portENTER_CRITICAL(&pool_mux);
+#endif
+        for (int i = 0; i < MBFS_FILE_POOL_SIZE; i++)
+        {
+            if (file_pool[i].type == mbfs_undefined)
+            {
+                file_pool[i].type = type;
+                handle = i;
+                break;
+            }
+        }
+#if defined(ESP32)
+        portEXIT_CRITICAL(&pool_mux);
+#endif
+        return handle;
+    }
+
+    // Return the reserved handle which was not opened to the file pool.
+    void releaseHandle(int handle)
+    {
+#if defined(ESP32)
+        portENTER_CRITICAL(&pool_mux);
+#endif
+        file_pool[handle].type = mbfs_undefined;
+#if defined(ESP32)
+        portEXIT_CRITICAL(&pool_mux);
+#endif
+    }
+#endif
+
     int openFile(const MB_String &filename, mb_fs_mem_storage_type type, mb_fs_open_mode mode)
     {
 
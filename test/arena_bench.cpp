@@ -0,0 +1,197 @@
+/**
+ * Host benchmark of the MB_JSON heap parse against the arena parse.
+ *
+ *   g++ -O2 -std=gnu++11 -Itest/host -Isrc test/arena_bench.cpp test/host/Arduino.cpp src/json/MB_JSON/MB_JSON.c -o arena_bench
+ *   ./arena_bench
+ *
+ * The event message and the element configs of 10 and 100 items are parsed and released with MB_JSON_Parse and
+ * MB_JSON_Delete, and with MB_JSON_ParseWithArena, MB_JSON_Delete and MB_JSON_FreeArena of the default block size.
+ * The hooks count the malloc calls, the peak of the requested bytes and the peak of the umm_malloc heap of one
+ * parse (ESP8266 and ESP32 Arduino core, 8 byte blocks with the 4 byte header), then the parse and release are
+ * timed. Both trees must print the same.
+ */
+
+#include <Arduino.h>
+#include <string>
+#include "json/MB_JSON/MB_JSON.h"
+
+static size_t mallocs = 0, live = 0, peak = 0, liveUmm = 0, peakUmm = 0;
+static int failures = 0;
+
+static size_t ummSize(size_t size)
+{
+    return (size + 4 + 7) / 8 * 8;
+}
+
+// the size is kept in front of the block to count the live bytes on free
+static void *countMalloc(size_t size)
+{
+    size_t *p = (size_t *)malloc(size + sizeof(max_align_t));
+    if (!p)
+        return NULL;
+    *p = size;
+    mallocs++;
+    live += size;
+    liveUmm += ummSize(size);
+    if (live > peak)
+        peak = live;
+    if (liveUmm > peakUmm)
+        peakUmm = liveUmm;
+    return (char *)p + sizeof(max_align_t);
+}
+
+static void countFree(void *ptr)
+{
+    if (!ptr)
+        return;
+    size_t *p = (size_t *)((char *)ptr - sizeof(max_align_t));
+    live -= *p;
+    liveUmm -= ummSize(*p);
+    free(p);
+}
+
+static void expect(bool ok, const char *name, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+// the {"esp":[{"id":..,"event":..,"value":..},..]} element config as ESPForm saves it
+static std::string makeConfig(int items)
+{
+    std::string s = "{\"esp\":[";
+    for (int k = 0; k < items; k++)
+    {
+        if (k > 0)
+            s += ",";
+        s += "{\"id\":\"element" + std::to_string(k) + "\",\"event\":" + std::to_string(k % 30) +
+             ",\"value\":\"value" + std::to_string(k) + "\"}";
+    }
+    return s + "]}";
+}
+
+static std::string printTree(MB_JSON *root)
+{
+    char *s = MB_JSON_PrintUnformatted(root);
+    std::string out = s ? s : "";
+    MB_JSON_free(s);
+    return out;
+}
+
+// parses and releases once, returns the printed tree
+static std::string parse(const std::string &text, bool arenaMode)
+{
+    std::string printed;
+    if (arenaMode)
+    {
+        MB_JSON_Arena arena;
+        MB_JSON_InitArena(&arena, 0);
+        MB_JSON *root = MB_JSON_ParseWithArena(text.c_str(), text.length() + 1, NULL, 1, &arena);
+        if (root)
+        {
+            // the print buffer is not counted
+            size_t m = mallocs, p = peak, u = peakUmm;
+            printed = printTree(root);
+            mallocs = m;
+            peak = p;
+            peakUmm = u;
+        }
+        MB_JSON_Delete(root);
+        MB_JSON_FreeArena(&arena);
+    }
+    else
+    {
+        MB_JSON *root = MB_JSON_Parse(text.c_str());
+        if (root)
+        {
+            size_t m = mallocs, p = peak, u = peakUmm;
+            printed = printTree(root);
+            mallocs = m;
+            peak = p;
+            peakUmm = u;
+        }
+        MB_JSON_Delete(root);
+    }
+    return printed;
+}
+
+static double bench(const std::string &text, bool arenaMode)
+{
+    const int rounds = 2000000 / (int)text.length() + 1;
+    size_t count = 0;
+
+    unsigned long t = micros();
+    for (int r = 0; r < rounds; r++)
+    {
+        if (arenaMode)
+        {
+            MB_JSON_Arena arena;
+            MB_JSON_InitArena(&arena, 0);
+            MB_JSON *root = MB_JSON_ParseWithArena(text.c_str(), text.length() + 1, NULL, 1, &arena);
+            count += root != NULL;
+            MB_JSON_Delete(root);
+            MB_JSON_FreeArena(&arena);
+        }
+        else
+        {
+            MB_JSON *root = MB_JSON_Parse(text.c_str());
+            count += root != NULL;
+            MB_JSON_Delete(root);
+        }
+    }
+    unsigned long us = micros() - t;
+
+    expect(count == (size_t)rounds, "bench", "parse failed");
+    return (double)us / rounds;
+}
+
+int main()
+{
+    MB_JSON_Hooks hooks = {countMalloc, countFree, NULL};
+    MB_JSON_InitHooks(&hooks);
+
+    const std::string inputs[] = {"{\"event\":4,\"type\":\"set\",\"id\":\"slider12\",\"value\":\"72\",\"n\":1}",
+                                  makeConfig(10), makeConfig(100)};
+    const char *names[] = {"event message", "config 10 items", "config 100 items"};
+
+    printf("%-18s %6s %16s %16s %18s\n", "input", "bytes", "heap", "arena", "heap/arena");
+    printf("%-18s %6s %16s %16s %18s\n", "", "", "mallocs/B/umm B", "mallocs/B/umm B", "us");
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++)
+    {
+        size_t heapMallocs, heapPeak, heapUmm, arenaMallocs, arenaPeak, arenaUmm;
+
+        mallocs = peak = peakUmm = 0;
+        std::string heapTree = parse(inputs[i], false);
+        heapMallocs = mallocs;
+        heapPeak = peak;
+        heapUmm = peakUmm;
+        expect(live == 0, names[i], "heap tree not freed");
+
+        mallocs = peak = peakUmm = 0;
+        std::string arenaTree = parse(inputs[i], true);
+        arenaMallocs = mallocs;
+        arenaPeak = peak;
+        arenaUmm = peakUmm;
+        expect(live == 0, names[i], "arena not freed");
+
+        expect(!heapTree.empty() && heapTree == arenaTree, names[i], "different trees");
+        expect(arenaMallocs < heapMallocs, names[i], "no fewer mallocs");
+
+        double heapUs = bench(inputs[i], false);
+        double arenaUs = bench(inputs[i], true);
+
+        char heapCol[32], arenaCol[32], timeCol[32];
+        snprintf(heapCol, sizeof(heapCol), "%zu/%zu/%zu", heapMallocs, heapPeak, heapUmm);
+        snprintf(arenaCol, sizeof(arenaCol), "%zu/%zu/%zu", arenaMallocs, arenaPeak, arenaUmm);
+        snprintf(timeCol, sizeof(timeCol), "%.2f / %.2f", heapUs, arenaUs);
+        printf("%-18s %6zu %16s %16s %18s\n", names[i], inputs[i].length(), heapCol, arenaCol, timeCol);
+    }
+
+    if (failures == 0)
+        printf("arena bench: all passed\n");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/**
+ * Host test of the MB_JSON arena parse, the edited arena trees and the parses from more than one thread.
+ *
+ *   g++ -O1 -g -std=gnu++11 -fsanitize=address -pthread -Isrc test/arena_test.cpp src/json/MB_JSON/MB_JSON.c -o arena_test
+ *   ./arena_test
+ *
+ * The allocations through the hooks are counted, every heap allocation of the edited tree must be freed by
+ * MB_JSON_Delete and the arena memory must never reach the free hook (AddressSanitizer reports the bad free).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "json/MB_JSON/MB_JSON.h"
+
+static std::atomic<long> live(0);
+static int failures = 0;
+
+static void *countMalloc(size_t size)
+{
+    live++;
+    return malloc(size);
+}
+
+static void countFree(void *p)
+{
+    if (p)
+        live--;
+    free(p);
+}
+
+static void expect(bool ok, const char *name, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+static const char *config = "{\"elements\":[{\"id\":\"slider\",\"event\":4,\"value\":\"72\"},"
+                            "{\"id\":\"text1\",\"event\":22,\"value\":\"Hello ESPForm\"}],\"name\":\"form\"}";
+
+static void testEdit()
+{
+    MB_JSON_Arena arena;
+    MB_JSON_InitArena(&arena, 64);
+    long before = live;
+
+    MB_JSON *root = MB_JSON_ParseWithArena(config, strlen(config) + 1, NULL, 1, &arena);
+    expect(root != NULL, "edit", "parse");
+    long arenaBlocks = live - before;
+
+    // the heap strings and items on the arena items
+    MB_JSON *elements = MB_JSON_GetObjectItem(root, "elements");
+    MB_JSON *text = MB_JSON_GetObjectItem(MB_JSON_GetArrayItem(elements, 1), "value");
+    MB_JSON_SetValuestring(text, "the longer value than the parsed one");
+    MB_JSON_AddItemToObject(root, "added", MB_JSON_CreateString("heap"));
+    MB_JSON_ReplaceItemInObject(MB_JSON_GetArrayItem(elements, 0), "value", MB_JSON_CreateString("73"));
+    MB_JSON_AddItemReferenceToObject(root, "ref", MB_JSON_GetArrayItem(elements, 1));
+
+    // the arena item moved to other tree with a new name
+    MB_JSON *other = MB_JSON_CreateObject();
+    MB_JSON_AddItemToObject(other, "renamed", MB_JSON_DetachItemFromObject(root, "name"));
+
+    char *printed = MB_JSON_PrintUnformatted(root);
+    expect(strstr(printed, "\"the longer value than the parsed one\"") != NULL, "edit", "set value");
+    expect(strstr(printed, "\"value\":\"73\"") != NULL, "edit", "replace");
+    expect(strstr(printed, "\"name\"") == NULL, "edit", "detach");
+    MB_JSON_free(printed);
+
+    MB_JSON_Delete(other);
+    MB_JSON_Delete(root);
+    expect(live - before == arenaBlocks, "edit", "heap memory of the tree not freed");
+
+    MB_JSON_FreeArena(&arena);
+    expect(live == before, "edit", "arena blocks not freed");
+}
+
+static void testInvalid()
+{
+    MB_JSON_Arena arena;
+    MB_JSON_InitArena(&arena, 0);
+    long before = live;
+
+    const char *invalid = "{\"a\":\"b\",\"c\":";
+    expect(MB_JSON_ParseWithArena(invalid, strlen(invalid) + 1, NULL, 1, &arena) == NULL, "invalid", "parsed");
+    MB_JSON_FreeArena(&arena);
+    expect(live == before, "invalid", "arena blocks not freed");
+}
+
+// each thread parses into its own arena
+static void parseLoop(int seed, bool *ok)
+{
+    MB_JSON_Arena arena;
+    MB_JSON_InitArena(&arena, 128);
+    *ok = true;
+
+    for (int i = 0; i < 20000; i++)
+    {
+        std::string s = "{\"id\":\"t" + std::to_string(seed) + "\",\"n\":" + std::to_string(i) + ",\"list\":[1,2,3,\"x\"]}";
+        MB_JSON *root = MB_JSON_ParseWithArena(s.c_str(), s.length() + 1, NULL, 1, &arena);
+        MB_JSON *n = MB_JSON_GetObjectItem(root, "n");
+        if (!n || n->valueint != i || strcmp(MB_JSON_GetObjectItem(root, "id")->valuestring + 1, std::to_string(seed).c_str()) != 0)
+            *ok = false;
+        MB_JSON_Delete(root);
+        MB_JSON_FreeArena(&arena);
+    }
+}
+
+int main()
+{
+    MB_JSON_Hooks hooks = {countMalloc, countFree, NULL};
+    MB_JSON_InitHooks(&hooks);
+
+    testEdit();
+    testInvalid();
+
+    bool ok[4];
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.push_back(std::thread(parseLoop, t, &ok[t]));
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+    for (int t = 0; t < 4; t++)
+        expect(ok[t], "threads", "wrong tree");
+    expect(live == 0, "threads", "memory not freed");
+
+    if (failures == 0)
+        printf("arena: all passed\n");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+/**
+ * Host benchmark of the MB_JSON array cursor against the indexed access from the first item.
+ *
+ *   g++ -O2 -std=gnu++11 -Itest/host -Isrc test/array_cursor_bench.cpp test/host/Arduino.cpp src/json/MB_JSON/MB_JSON.c -o array_cursor_bench
+ *   ./array_cursor_bench
+ *
+ * Every index of the 10, 100 and 1000 item arrays is read in order, backward and in the random order, with
+ * MB_JSON_GetArrayItem and with MB_JSON_GetArrayItemCursor. The cursor results and the cursor after the
+ * array was changed are checked first.
+ */
+
+#include <Arduino.h>
+#include <vector>
+#include "json/MB_JSON/MB_JSON.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char *name, const char *what, int size)
+{
+    if (!ok)
+    {
+        printf("FAIL %s (%d items): %s\n", name, size, what);
+        failures++;
+    }
+}
+
+static MB_JSON *makeArray(int size)
+{
+    MB_JSON *array = MB_JSON_CreateArray();
+    for (int i = 0; i < size; i++)
+        MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(i));
+    return array;
+}
+
+static std::vector<int> order(int size, int kind)
+{
+    std::vector<int> v(size);
+    for (int i = 0; i < size; i++)
+        v[i] = kind == 1 ? size - 1 - i : i;
+
+    if (kind == 2)
+    {
+        uint32_t x = 2463534242u;
+        for (int i = size - 1; i > 0; i--)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            std::swap(v[i], v[x % (i + 1)]);
+        }
+    }
+    return v;
+}
+
+static void check(int size)
+{
+    MB_JSON *array = makeArray(size);
+    MB_JSON_ArrayCursor cursor;
+    MB_JSON_ResetArrayCursor(&cursor);
+
+    expect(MB_JSON_GetArraySizeCursor(array, &cursor) == size, "size", "wrong size", size);
+    for (int kind = 0; kind < 3; kind++)
+    {
+        std::vector<int> v = order(size, kind);
+        for (int i = 0; i < size; i++)
+        {
+            MB_JSON *item = MB_JSON_GetArrayItemCursor(array, v[i], &cursor);
+            expect(item == MB_JSON_GetArrayItem(array, v[i]), "item", "wrong item", size);
+        }
+    }
+    expect(MB_JSON_GetArrayItemCursor(array, size, &cursor) == NULL, "item", "past the end", size);
+
+    // the cursor on the removed item and the cached size are rebuilt after the change
+    MB_JSON_GetArrayItemCursor(array, size / 2, &cursor);
+    MB_JSON_DeleteItemFromArray(array, size / 2);
+    expect(MB_JSON_GetArraySizeCursor(array, &cursor) == size - 1, "delete", "stale size", size);
+    expect(MB_JSON_GetArrayItemCursor(array, size / 2, &cursor) == MB_JSON_GetArrayItem(array, size / 2), "delete", "stale item", size);
+
+    MB_JSON_InsertItemInArray(array, 0, MB_JSON_CreateNumber(-1));
+    expect(MB_JSON_GetArraySizeCursor(array, &cursor) == size, "insert", "stale size", size);
+    expect(MB_JSON_GetArrayItemCursor(array, 0, &cursor)->valueint == -1, "insert", "stale item", size);
+
+    MB_JSON_Delete(array);
+}
+
+static double bench(MB_JSON *array, const std::vector<int> &v, bool useCursor)
+{
+    const int rounds = 2000000 / (int)v.size() + 1;
+    MB_JSON_ArrayCursor cursor;
+    MB_JSON_ResetArrayCursor(&cursor);
+    double total = 0;
+
+    unsigned long t = micros();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < v.size(); i++)
+            total += (useCursor ? MB_JSON_GetArrayItemCursor(array, v[i], &cursor) : MB_JSON_GetArrayItem(array, v[i]))->valuedouble;
+    }
+    unsigned long us = micros() - t;
+
+    if (total < 0)
+        printf("(checksum %f)\n", total);
+    return us * 1000.0 / ((double)rounds * v.size());
+}
+
+int main()
+{
+    static const int sizes[] = {10, 100, 1000};
+    static const char *kinds[] = {"forward", "backward", "random"};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        check(sizes[s]);
+
+    printf("%-6s %-9s %16s %16s\n", "items", "order", "plain ns/item", "cursor ns/item");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        MB_JSON *array = makeArray(sizes[s]);
+        for (int kind = 0; kind < 3; kind++)
+        {
+            std::vector<int> v = order(sizes[s], kind);
+            double plain = bench(array, v, false);
+            double cursor = bench(array, v, true);
+            printf("%-6d %-9s %16.1f %16.1f\n", sizes[s], kinds[kind], plain, cursor);
+        }
+        MB_JSON_Delete(array);
+    }
+
+    if (failures == 0)
+        printf("array cursor: all passed\n");
+
+    return failures == 0 ? 0 : 1;
+}
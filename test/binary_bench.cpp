@@ -0,0 +1,214 @@
+/**
+ * Host benchmark of the binary message mode against the JSON text messages.
+ *
+ *   g++ -O2 -std=gnu++11 -Itest/host -Isrc test/binary_bench.cpp test/host/Arduino.cpp -o binary_bench
+ *   ./binary_bench
+ *
+ * The encode side builds the batched element updates as ESPFormClass does (the set records with the element
+ * handles against the {"type":"batch","set":[["id","value"],...]} text), the decode side reads the client events
+ * (ESPFormBinaryReader against ESPFormDecoder). The value text round trip is checked first.
+ */
+
+#include <Arduino.h>
+#include <string>
+#include "ESPFormBinary.h"
+#include "ESPFormDecoder.h"
+
+static const char *ids[] = {"button1", "slider", "text1", "select1", "check1", "knob", "counter", "label"};
+static const size_t idCount = sizeof(ids) / sizeof(ids[0]);
+
+static espform_value_t valueAt(size_t i, size_t round)
+{
+    espform_value_t v;
+    switch (i % 4)
+    {
+    case 0:
+        v.type = espform_value_type_int;
+        v.intValue = (int32_t)(round * 37 + i);
+        break;
+    case 1:
+        v.type = espform_value_type_float;
+        v.floatValue = 0.1 * (double)(round % 1000) + 0.25;
+        break;
+    case 2:
+        v.type = (round + i) & 1 ? espform_value_type_true : espform_value_type_false;
+        break;
+    default:
+        v.type = espform_value_type_string;
+        v.str = "Hello ESPForm";
+        v.len = 13;
+        break;
+    }
+    return v;
+}
+
+static void fail(const char *what, const char *text)
+{
+    printf("FAIL %s %s\n", what, text);
+    exit(1);
+}
+
+static void checkText(double d, const char *expected)
+{
+    espform_value_t v;
+    v.type = espform_value_type_float;
+    v.floatValue = d;
+    char buf[ESPFORM_VALUE_TEXT_SIZE];
+    size_t len = 0;
+    const char *text = v.text(buf, len);
+    if (strcmp(text, expected) != 0 || len != strlen(expected))
+        fail("float text", text);
+}
+
+static void check()
+{
+    checkText(0.1, "0.1");
+    checkText(1.0 / 3.0, "0.3333333333333333");
+    checkText(123456789.125, "123456789.125");
+    checkText(-2.5e-10, "-2.5e-10");
+
+    // the float32 from the wire keeps its shortest text
+    ESPFormBinaryWriter w;
+    espform_value_t v;
+    v.type = espform_value_type_float;
+    v.floatValue = 0.1;
+    w.value(v);
+    v.type = espform_value_type_int;
+    v.intValue = -2147483647 - 1;
+    w.value(v);
+
+    ESPFormBinaryReader r(w.buf.data(), w.buf.size());
+    char buf[ESPFORM_VALUE_TEXT_SIZE];
+    size_t len = 0;
+    if (!r.value(v) || strcmp(v.text(buf, len), "0.1") != 0)
+        fail("float32 text", buf);
+    if (!r.value(v) || strcmp(v.text(buf, len), "-2147483648") != 0)
+        fail("int text", buf);
+}
+
+static void appendEscaped(std::string &s, const char *str, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (str[i] == '"' || str[i] == '\\')
+            s += '\\';
+        s += str[i];
+    }
+}
+
+int main()
+{
+    check();
+
+    const size_t rounds = 200000;
+    size_t binBytes = 0, textBytes = 0, total = 0;
+    char buf[ESPFORM_VALUE_TEXT_SIZE];
+
+    ESPFormBinaryWriter writer;
+    unsigned long t = micros();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        writer.clear();
+        for (size_t i = 0; i < idCount; i++)
+            writer.set((int)i, ids[i], valueAt(i, r));
+        binBytes += writer.buf.size();
+    }
+    unsigned long binEncode = micros() - t;
+
+    std::string text;
+    t = micros();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        text = "{\"type\":\"batch\",\"set\":[";
+        for (size_t i = 0; i < idCount; i++)
+        {
+            espform_value_t v = valueAt(i, r);
+            size_t len = 0;
+            const char *s = v.text(buf, len);
+            text += i > 0 ? ",[\"" : "[\"";
+            appendEscaped(text, ids[i], strlen(ids[i]));
+            text += "\",\"";
+            appendEscaped(text, s, len);
+            text += "\"]";
+        }
+        text += "]}";
+        textBytes += text.length();
+    }
+    unsigned long textEncode = micros() - t;
+
+    // one event record of each element, binary and the espform.js JSON
+    std::vector<std::vector<uint8_t> > binEvents;
+    std::vector<std::string> textEvents;
+    for (size_t i = 0; i < idCount; i++)
+    {
+        espform_value_t v = valueAt(i, 7);
+        ESPFormBinaryWriter w;
+        w.buf.push_back(ESPFORM_BIN_OP_EVENT);
+        w.ref((int)i, ids[i], strlen(ids[i]));
+        w.varint(4);
+        w.value(v);
+        binEvents.push_back(w.buf);
+
+        size_t len = 0;
+        const char *s = v.text(buf, len);
+        std::string e = "{\"type\":\"event\",\"id\":\"";
+        e += ids[i];
+        e += "\",\"event\":4,\"value\":\"";
+        appendEscaped(e, s, len);
+        e += "\"}";
+        textEvents.push_back(e);
+    }
+
+    size_t binEventBytes = 0, textEventBytes = 0;
+    for (size_t i = 0; i < idCount; i++)
+    {
+        binEventBytes += binEvents[i].size();
+        textEventBytes += textEvents[i].length();
+    }
+
+    t = micros();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < idCount; i++)
+        {
+            ESPFormBinaryReader reader(binEvents[i].data(), binEvents[i].size());
+            uint8_t op = 0;
+            int handle = -1;
+            const char *id = nullptr;
+            size_t idLen = 0, len = 0;
+            uint32_t event = 0;
+            espform_value_t v;
+            if (!reader.byte(op) || !reader.ref(handle, id, idLen) || !reader.varint(event) || !reader.value(v))
+                fail("binary decode", ids[i]);
+            v.text(buf, len);
+            total += handle + event + len;
+        }
+    }
+    unsigned long binDecode = micros() - t;
+
+    char msgBuf[128];
+    t = micros();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < idCount; i++)
+        {
+            espform_event_message_t msg;
+            size_t len = textEvents[i].length();
+            memcpy(msgBuf, textEvents[i].c_str(), len + 1);
+            if (!ESPFormDecoder::decode(msgBuf, len, msg))
+                fail("json decode", ids[i]);
+            total += msg.id.len + msg.value.len;
+        }
+    }
+    unsigned long textDecode = micros() - t;
+
+    double batches = rounds, events = (double)rounds * idCount;
+    printf("%-8s %14s %12s %14s %12s\n", "mode", "batches/s", "bytes/batch", "events/s", "bytes/event");
+    printf("%-8s %14.0f %12.1f %14.0f %12.1f\n", "binary", batches * 1e6 / (binEncode ? binEncode : 1), (double)binBytes / rounds,
+           events * 1e6 / (binDecode ? binDecode : 1), (double)binEventBytes / idCount);
+    printf("%-8s %14.0f %12.1f %14.0f %12.1f\n", "json", batches * 1e6 / (textEncode ? textEncode : 1), (double)textBytes / rounds,
+           events * 1e6 / (textDecode ? textDecode : 1), (double)textEventBytes / idCount);
+    printf("(checksum %zu)\n", total);
+
+    return 0;
+}
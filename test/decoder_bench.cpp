@@ -0,0 +1,140 @@
+/**
+ * Host benchmark of the event message decoding, ESPFormDecoder against the JSON DOM path it replaces.
+ *
+ *   g++ -O2 -std=gnu++11 -Itest/host -Isrc test/decoder_bench.cpp test/host/Arduino.cpp src/json/MB_JSON/MB_JSON.c -o decoder_bench
+ *   ./decoder_bench
+ *
+ * The payloads are the messages recorded from espform.js, the DOM path parses the message, looks up the
+ * four keys and prints each value to the heap string as the FirebaseJson get did.
+ */
+
+#include <Arduino.h>
+#include <new>
+#include "ESPFormDecoder.h"
+#include "json/MB_JSON/MB_JSON.h"
+
+static size_t allocs = 0;
+
+void *operator new(size_t size)
+{
+    allocs++;
+    void *p = malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static void *countMalloc(size_t size)
+{
+    allocs++;
+    return malloc(size);
+}
+
+static const char *payloads[] = {
+    "{\"type\":\"event\",\"id\":\"button1\",\"event\":1,\"value\":\"\"}",
+    "{\"type\":\"event\",\"id\":\"slider\",\"event\":4,\"value\":\"72\"}",
+    "{\"type\":\"event\",\"id\":\"text1\",\"event\":22,\"value\":\"Hello \\\"ESPForm\\\"\\n\"}",
+    "{\"type\":\"get\",\"id\":\"select1\",\"event\":0,\"value\":null}",
+    "{\"type\":\"event\",\"id\":\"check1\",\"event\":4,\"value\":true}",
+    "{\"type\":\"event\",\"id\":\"knob\",\"event\":5,\"value\":-12.5}",
+};
+
+static const size_t payloadCount = sizeof(payloads) / sizeof(payloads[0]);
+
+static bool decodes(const char *s)
+{
+    char buf[128];
+    espform_event_message_t msg;
+    strcpy(buf, s);
+    return ESPFormDecoder::decode(buf, strlen(buf), msg);
+}
+
+static void check()
+{
+    for (size_t i = 0; i < payloadCount; i++)
+    {
+        if (!decodes(payloads[i]))
+        {
+            printf("FAIL decode %s\n", payloads[i]);
+            exit(1);
+        }
+    }
+
+    // the invalid literals and numbers are left to the JSON parser
+    const char *invalid[] = {"tru", "nul", "falsey", "01", "1.", "-", "1e", "+1", ".5", "0x10", "truex"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        char s[96];
+        snprintf(s, sizeof(s), "{\"type\":\"event\",\"id\":\"a\",\"event\":1,\"value\":%s}", invalid[i]);
+        if (decodes(s))
+        {
+            printf("FAIL accepted %s\n", s);
+            exit(1);
+        }
+    }
+}
+
+static std::string nodeText(MB_JSON *root, const char *key)
+{
+    MB_JSON *node = MB_JSON_GetObjectItemCaseSensitive(root, key);
+    if (!node)
+        return std::string();
+    char *s = MB_JSON_PrintUnformatted(node);
+    std::string out(s);
+    MB_JSON_free(s);
+    return out;
+}
+
+int main()
+{
+    MB_JSON_Hooks hooks = {countMalloc, free, NULL};
+    MB_JSON_InitHooks(&hooks);
+
+    check();
+
+    const size_t rounds = 200000;
+    size_t total = 0, messages = rounds * payloadCount;
+    char buf[128];
+
+    allocs = 0;
+    unsigned long t = micros();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < payloadCount; i++)
+        {
+            espform_event_message_t msg;
+            size_t len = strlen(payloads[i]);
+            memcpy(buf, payloads[i], len + 1);
+            ESPFormDecoder::decode(buf, len, msg);
+            total += msg.id.len + msg.value.len;
+        }
+    }
+    unsigned long decoderTime = micros() - t;
+    double decoderAllocs = (double)allocs / messages;
+
+    allocs = 0;
+    t = micros();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < payloadCount; i++)
+        {
+            MB_JSON *root = MB_JSON_Parse(payloads[i]);
+            std::string type = nodeText(root, "type"), id = nodeText(root, "id"), event = nodeText(root, "event"), value = nodeText(root, "value");
+            total += id.length() + value.length() + type.length() + event.length();
+            MB_JSON_Delete(root);
+        }
+    }
+    unsigned long domTime = micros() - t;
+    double domAllocs = (double)allocs / messages;
+
+    printf("%-10s %12s %14s\n", "path", "messages/s", "allocs/message");
+    printf("%-10s %12.0f %14.1f\n", "decoder", messages * 1e6 / (decoderTime ? decoderTime : 1), decoderAllocs);
+    printf("%-10s %12.0f %14.1f\n", "json dom", messages * 1e6 / (domTime ? domTime : 1), domAllocs);
+    printf("(checksum %zu)\n", total);
+
+    return decoderAllocs == 0 ? 0 : 1;
+}
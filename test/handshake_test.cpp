@@ -0,0 +1,132 @@
+/**
+ * Host test of the WebSocket server handshake and frame reading with the split and partial tcp reads.
+ *
+ *   gcc -O2 -c -Itest/host src/WebSockets/libsha1/libsha1.c src/WebSockets/libb64/cencode.c src/WebSockets/libb64/cdecode.c
+ *   g++ -O2 -std=gnu++11 -Itest/host -Isrc test/handshake_test.cpp test/host/Arduino.cpp src/WebSockets/WebSockets.cpp
+ *       src/WebSockets/WebSocketsServer.cpp libsha1.o cencode.o cdecode.o -o handshake_test
+ *   ./handshake_test
+ *
+ * The server is built with the W5100 network type, test/host/Ethernet.h replays the scripted connections.
+ * The request bytes are delivered in pieces between the loop calls, the frames are read a few bytes per tcp read.
+ */
+
+#include <Arduino.h>
+#include "WebSockets/WebSocketsServer.h"
+
+class TestServer : public WebSocketsServer
+{
+public:
+    TestServer() : WebSocketsServer(81) {}
+
+    std::shared_ptr<HostConnection> accept()
+    {
+        std::shared_ptr<HostConnection> conn(new HostConnection());
+        _server->pending.push_back(conn);
+        return conn;
+    }
+};
+
+static const char *request = "GET / HTTP/1.1\r\n"
+                             "Host: 192.168.1.2:81\r\n"
+                             "Upgrade: websocket\r\n"
+                             "Connection: Upgrade\r\n"
+                             "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                             "Sec-WebSocket-Version: 13\r\n";
+
+// the RFC 6455 accept key of the request key above
+static const char *acceptKey = "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=";
+
+// the masked "Hello" text frame of RFC 6455 5.7
+static const uint8_t helloFrame[] = {0x81, 0x85, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d, 0x51, 0x58};
+
+static int failures = 0;
+static int connects = 0;
+static std::string received;
+
+static void expect(bool ok, const char *name, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+static void onEvent(uint8_t num, WStype_t type, uint8_t *payload, size_t length)
+{
+    if (type == WStype_CONNECTED)
+        connects++;
+    else if (type == WStype_TEXT)
+        received.assign((const char *)payload, length);
+}
+
+// deliver the request in pieces of the given size with a loop call after each piece
+static std::shared_ptr<HostConnection> replay(TestServer &server, const std::string &data, size_t piece)
+{
+    std::shared_ptr<HostConnection> conn = server.accept();
+    server.loop();
+    for (size_t pos = 0; pos < data.size(); pos += piece)
+    {
+        conn->arrive(data.substr(pos, piece));
+        server.loop();
+    }
+    server.loop();
+    return conn;
+}
+
+static void testHandshake(const char *name, size_t piece, const std::string &extra)
+{
+    TestServer server;
+    server.onEvent(onEvent);
+    server.begin();
+
+    connects = 0;
+    received.clear();
+
+    std::shared_ptr<HostConnection> conn = replay(server, std::string(request) + extra + "\r\n", piece);
+
+    expect(conn->tx.compare(0, 12, "HTTP/1.1 101") == 0, name, "no 101 response");
+    expect(conn->tx.find(acceptKey) != std::string::npos, name, "wrong accept key");
+    expect(connects == 1, name, "no connected event");
+
+    // the frame is read one byte per tcp read, the loop calls resume the frame in progress
+    conn->readChunk = 1;
+    conn->arrive(std::string((const char *)helloFrame, sizeof(helloFrame)));
+    for (size_t i = 0; i < sizeof(helloFrame) && received.empty(); i++)
+        server.loop();
+    expect(received == "Hello", name, "frame not received");
+    expect(conn->open, name, "disconnected");
+}
+
+static void testRejected(const char *name, const std::string &data)
+{
+    TestServer server;
+    server.onEvent(onEvent);
+    server.begin();
+
+    connects = 0;
+    std::shared_ptr<HostConnection> conn = replay(server, data, 7);
+
+    expect(conn->tx.compare(0, 12, "HTTP/1.1 431") == 0, name, "no 431 response");
+    expect(!conn->open, name, "connection kept");
+    expect(connects == 0, name, "connected");
+}
+
+int main()
+{
+    std::string longValue(WEBSOCKETS_HTTP_LINE_SIZE * 2, 'a');
+
+    testHandshake("one piece", 4096, "");
+    testHandshake("byte by byte", 1, "");
+    testHandshake("split lines", 5, "");
+    testHandshake("split crlf", 17, "");
+    testHandshake("long unread header", 3, "User-Agent: " + longValue + "\r\nCookie: " + longValue + "\r\n");
+
+    testRejected("long protocol", std::string(request) + "Sec-WebSocket-Protocol: " + longValue + "\r\n\r\n");
+    testRejected("long request line", "GET /" + longValue + " HTTP/1.1\r\n" + std::string(request).substr(16) + "\r\n");
+
+    if (failures == 0)
+        printf("handshake: all passed\n");
+
+    return failures == 0 ? 0 : 1;
+}
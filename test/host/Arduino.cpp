@@ -0,0 +1,82 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long micros()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(unsigned long ms)
+{
+    if (ms > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {}
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+
+long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+
+void randomSeed(unsigned long seed) { srand(seed); }
+
+static char *toBase(unsigned long value, char *buf, int base, bool neg)
+{
+    char tmp[72];
+    size_t n = 0;
+    do
+    {
+        int d = value % base;
+        tmp[n++] = d < 10 ? '0' + d : 'a' + d - 10;
+        value /= base;
+    } while (value > 0);
+
+    char *p = buf;
+    if (neg)
+        *p++ = '-';
+    while (n > 0)
+        *p++ = tmp[--n];
+    *p = 0;
+    return buf;
+}
+
+char *itoa(int value, char *buf, int base) { return ltoa(value, buf, base); }
+
+char *ltoa(long value, char *buf, int base)
+{
+    bool neg = value < 0 && base == 10;
+    return toBase(neg ? -(unsigned long)value : (unsigned long)value, buf, base, neg);
+}
+
+char *utoa(unsigned int value, char *buf, int base) { return toBase(value, buf, base, false); }
+
+char *ultoa(unsigned long value, char *buf, int base) { return toBase(value, buf, base, false); }
+
+char *dtostrf(double value, signed char width, unsigned char prec, char *buf)
+{
+    sprintf(buf, "%*.*f", width, prec, value);
+    return buf;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (n < 0)
+        return 0;
+    return write((const uint8_t *)buf, (size_t)n < sizeof(buf) ? n : sizeof(buf) - 1);
+}
@@ -0,0 +1,335 @@
+/**
+ * The minimal Arduino core for building the library parts on the host (Linux/macOS) in the tests.
+ * Flash strings are the plain C strings, the time functions run on the system clock.
+ */
+
+#ifndef ESPFORM_HOST_ARDUINO_H
+#define ESPFORM_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcat_P strcat
+#define strncat_P strncat
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcasecmp_P strcasecmp
+#define strncasecmp_P strncasecmp
+#define strstr_P strstr
+#define memcpy_P memcpy
+#define memcmp_P memcmp
+#define memccpy_P memccpy
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+
+#define HEX 16
+#define DEC 10
+
+#define bit(b) (1UL << (b))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+char *itoa(int value, char *buf, int base);
+char *ltoa(long value, char *buf, int base);
+char *utoa(unsigned int value, char *buf, int base);
+char *ultoa(unsigned long value, char *buf, int base);
+char *dtostrf(double value, signed char width, unsigned char prec, char *buf);
+
+class String
+{
+public:
+    String() {}
+    String(const char *s) : _s(s ? s : "") {}
+    String(const __FlashStringHelper *s) : _s(s ? reinterpret_cast<const char *>(s) : "") {}
+    String(char c) : _s(1, c) {}
+    explicit String(int v, unsigned char base = 10) { num(v, base); }
+    explicit String(unsigned int v, unsigned char base = 10) { num(v, base); }
+    explicit String(long v, unsigned char base = 10) { num(v, base); }
+    explicit String(unsigned long v, unsigned char base = 10) { num(v, base); }
+    explicit String(float v, unsigned char prec = 2) { flt(v, prec); }
+    explicit String(double v, unsigned char prec = 2) { flt(v, prec); }
+
+    const char *c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    bool reserve(unsigned int size)
+    {
+        _s.reserve(size);
+        return true;
+    }
+
+    bool concat(const String &s)
+    {
+        _s += s._s;
+        return true;
+    }
+    bool concat(const char *s)
+    {
+        _s += s ? s : "";
+        return true;
+    }
+    bool concat(const char *s, unsigned int len)
+    {
+        _s.append(s, len);
+        return true;
+    }
+    bool concat(char c)
+    {
+        _s += c;
+        return true;
+    }
+    bool concat(const __FlashStringHelper *s) { return concat(reinterpret_cast<const char *>(s)); }
+    bool concat(int v) { return concat(String(v)); }
+    bool concat(unsigned int v) { return concat(String(v)); }
+    bool concat(long v) { return concat(String(v)); }
+    bool concat(unsigned long v) { return concat(String(v)); }
+    bool concat(float v) { return concat(String(v)); }
+    bool concat(double v) { return concat(String(v)); }
+
+    template <typename T>
+    String &operator+=(const T &v)
+    {
+        concat(v);
+        return *this;
+    }
+
+    char operator[](unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+    char &operator[](unsigned int i) { return _s[i]; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+    void setCharAt(unsigned int i, char c)
+    {
+        if (i < _s.length())
+            _s[i] = c;
+    }
+
+    bool operator==(const String &s) const { return _s == s._s; }
+    bool operator==(const char *s) const { return _s == (s ? s : ""); }
+    bool operator!=(const String &s) const { return _s != s._s; }
+    bool operator!=(const char *s) const { return !(*this == s); }
+    bool operator<(const String &s) const { return _s < s._s; }
+    explicit operator bool() const { return true; }
+
+    bool equals(const String &s) const { return _s == s._s; }
+    bool equalsIgnoreCase(const String &s) const { return strcasecmp(c_str(), s.c_str()) == 0; }
+    bool startsWith(const String &s) const { return _s.compare(0, s._s.length(), s._s) == 0; }
+    bool endsWith(const String &s) const { return _s.length() >= s._s.length() && _s.compare(_s.length() - s._s.length(), s._s.length(), s._s) == 0; }
+
+    int indexOf(char c, unsigned int from = 0) const { return pos(_s.find(c, from)); }
+    int indexOf(const String &s, unsigned int from = 0) const { return pos(_s.find(s._s, from)); }
+    int lastIndexOf(char c) const { return pos(_s.rfind(c)); }
+    int lastIndexOf(const String &s) const { return pos(_s.rfind(s._s)); }
+
+    String substring(unsigned int from) const { return from < _s.length() ? String(_s.substr(from).c_str()) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from > to)
+            std::swap(from, to);
+        return from < _s.length() ? String(_s.substr(from, to - from).c_str()) : String();
+    }
+
+    void remove(unsigned int index) { remove(index, _s.length()); }
+    void remove(unsigned int index, unsigned int count)
+    {
+        if (index < _s.length())
+            _s.erase(index, count);
+    }
+    void replace(const String &from, const String &to)
+    {
+        size_t p = 0;
+        while (from._s.length() > 0 && (p = _s.find(from._s, p)) != std::string::npos)
+        {
+            _s.replace(p, from._s.length(), to._s);
+            p += to._s.length();
+        }
+    }
+    void trim()
+    {
+        size_t b = 0, e = _s.length();
+        while (b < e && isspace((uint8_t)_s[b]))
+            b++;
+        while (e > b && isspace((uint8_t)_s[e - 1]))
+            e--;
+        _s = _s.substr(b, e - b);
+    }
+    void toLowerCase()
+    {
+        for (size_t i = 0; i < _s.length(); i++)
+            _s[i] = tolower((uint8_t)_s[i]);
+    }
+    void toUpperCase()
+    {
+        for (size_t i = 0; i < _s.length(); i++)
+            _s[i] = toupper((uint8_t)_s[i]);
+    }
+
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return atof(c_str()); }
+    double toDouble() const { return atof(c_str()); }
+    void getBytes(unsigned char *buf, unsigned int size, unsigned int index = 0) const
+    {
+        if (size == 0)
+            return;
+        size_t n = index < _s.length() ? std::min((size_t)size - 1, _s.length() - index) : 0;
+        memcpy(buf, _s.c_str() + index, n);
+        buf[n] = 0;
+    }
+
+private:
+    std::string _s;
+
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+
+    template <typename T>
+    void num(T v, unsigned char base)
+    {
+        char buf[72];
+        if (base == 16)
+            snprintf(buf, sizeof(buf), "%lx", (unsigned long)v);
+        else
+            snprintf(buf, sizeof(buf), v < 0 ? "%ld" : "%lu", (long)v);
+        _s = buf;
+    }
+
+    void flt(double v, unsigned char prec)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", prec, v);
+        _s = buf;
+    }
+};
+
+class StringSumHelper : public String
+{
+public:
+    StringSumHelper(const String &s) : String(s) {}
+    StringSumHelper(const char *s) : String(s) {}
+};
+
+template <typename T>
+StringSumHelper operator+(const String &a, const T &b)
+{
+    StringSumHelper s(a);
+    s += b;
+    return s;
+}
+
+inline StringSumHelper operator+(const char *a, const String &b)
+{
+    StringSumHelper s(a);
+    s += b;
+    return s;
+}
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t size)
+    {
+        size_t n = 0;
+        while (n < size && write(buf[n]))
+            n++;
+        return n;
+    }
+    size_t write(const char *s) { return s ? write((const uint8_t *)s, strlen(s)) : 0; }
+    size_t write(const char *buf, size_t size) { return write((const uint8_t *)buf, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char *s) { return write(s); }
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned int v, int base = DEC) { return print(String(v, base)); }
+    size_t print(long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(double v, int prec = 2) { return print(String(v, prec)); }
+
+    template <typename T>
+    size_t println(const T &v) { return print(v) + println(); }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    size_t readBytes(char *buf, size_t size)
+    {
+        size_t n = 0;
+        int c;
+        while (n < size && (c = read()) >= 0)
+            buf[n++] = (char)c;
+        return n;
+    }
+    size_t readBytes(uint8_t *buf, size_t size) { return readBytes((char *)buf, size); }
+    String readStringUntil(char terminator)
+    {
+        String s;
+        int c;
+        while ((c = read()) >= 0 && c != terminator)
+            s += (char)c;
+        return s;
+    }
+    String readString() { return readStringUntil(0); }
+
+protected:
+    unsigned long _timeout = 1000;
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buf, size_t size) override { return fwrite(buf, 1, size, stdout); }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#include "IPAddress.h"
+
+#endif
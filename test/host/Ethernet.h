@@ -0,0 +1,98 @@
+#ifndef ESPFORM_HOST_ETHERNET_H
+#define ESPFORM_HOST_ETHERNET_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <memory>
+#include <deque>
+
+/**
+ * The scripted tcp connection of the host tests, the test appends the received bytes (arrive) while the server
+ * reads them, read hands out at most readChunk bytes per call to replay the partial reads.
+ */
+struct HostConnection
+{
+    std::string rx;
+    size_t rxPos = 0;
+    size_t readChunk = 0; // 0 for no limit
+    std::string tx;
+    bool open = true;
+
+    void arrive(const std::string &s) { rx += s; }
+};
+
+class EthernetClient : public Client
+{
+public:
+    EthernetClient() {}
+    EthernetClient(std::shared_ptr<HostConnection> conn) : _conn(conn) {}
+
+    int connect(IPAddress, uint16_t) override { return 0; }
+    int connect(const char *, uint16_t) override { return 0; }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        if (!connected())
+            return 0;
+        _conn->tx.append((const char *)buf, size);
+        return size;
+    }
+    using Print::write;
+    int availableForWrite() override { return connected() ? 4096 : 0; }
+
+    int available() override { return connected() ? (int)(_conn->rx.size() - _conn->rxPos) : 0; }
+    int read() override
+    {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int read(uint8_t *buf, size_t size) override
+    {
+        size_t n = std::min(size, (size_t)available());
+        if (_conn && _conn->readChunk > 0)
+            n = std::min(n, _conn->readChunk);
+        if (n == 0)
+            return -1;
+        memcpy(buf, _conn->rx.data() + _conn->rxPos, n);
+        _conn->rxPos += n;
+        return (int)n;
+    }
+    int peek() override { return available() > 0 ? (uint8_t)_conn->rx[_conn->rxPos] : -1; }
+    void flush() override {}
+    void stop() override
+    {
+        if (_conn)
+            _conn->open = false;
+    }
+    uint8_t connected() override { return _conn && _conn->open; }
+    operator bool() override { return (bool)_conn; }
+
+private:
+    std::shared_ptr<HostConnection> _conn;
+};
+
+class EthernetServer
+{
+public:
+    EthernetServer(uint16_t port) : _port(port) {}
+
+    void begin() {}
+
+    // the next accepted connection or the not connected client
+    EthernetClient available()
+    {
+        if (pending.empty())
+            return EthernetClient();
+        std::shared_ptr<HostConnection> conn = pending.front();
+        pending.pop_front();
+        return EthernetClient(conn);
+    }
+
+    std::deque<std::shared_ptr<HostConnection> > pending;
+
+private:
+    uint16_t _port;
+};
+
+#endif
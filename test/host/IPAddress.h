@@ -0,0 +1,32 @@
+#ifndef ESPFORM_HOST_IPADDRESS_H
+#define ESPFORM_HOST_IPADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress
+{
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+        _b[0] = a;
+        _b[1] = b;
+        _b[2] = c;
+        _b[3] = d;
+    }
+
+    uint8_t operator[](int i) const { return _b[i]; }
+    operator uint32_t() const { return _b[0] | (_b[1] << 8) | (_b[2] << 16) | ((uint32_t)_b[3] << 24); }
+
+    String toString() const
+    {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _b[0], _b[1], _b[2], _b[3]);
+        return String(buf);
+    }
+
+private:
+    uint8_t _b[4] = {0, 0, 0, 0};
+};
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef ESPFORM_HOST_SPI_H
+#define ESPFORM_HOST_SPI_H
+
+// the Ethernet library includes it, nothing is used on the host
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * Host test of MB_Deflate and MB_Inflate against the zlib reference implementation.
+ *
+ *   g++ -O2 -std=gnu++11 -Isrc test/inflate_test.cpp -lz -o inflate_test
+ *   ./inflate_test
+ *
+ * The MB_Deflate output (raw and gzip, each window size) is decompressed by zlib, the zlib raw deflate output
+ * (stored, fixed, dynamic Huffman and the RFC 7692 sync flushed messages) is decompressed by MB_Inflate.
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "deflate/MB_Deflate.h"
+#include "deflate/MB_Inflate.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char *name, const char *what, size_t len)
+{
+    if (!ok)
+    {
+        printf("FAIL %s (%zu bytes): %s\n", name, len, what);
+        failures++;
+    }
+}
+
+static std::vector<std::string> samples()
+{
+    std::vector<std::string> s;
+    s.push_back("");
+    s.push_back("a");
+    s.push_back("{\"type\":\"batch\",\"set\":[[\"slider\",\"72\"],[\"text1\",\"Hello ESPForm\"]]}");
+
+    std::string text;
+    for (int i = 0; i < 400; i++)
+        text += "<div class=\"espform-row\" id=\"row" + std::to_string(i) + "\"><input type=\"range\"></div>\n";
+    s.push_back(text);
+
+    s.push_back(std::string(70000, 'x'));
+
+    std::string noise;
+    uint32_t x = 2463534242u;
+    for (int i = 0; i < 50000; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        noise += (char)(x & 0xff);
+    }
+    s.push_back(noise);
+
+    // the long matches over the window edge
+    std::string periodic;
+    for (int i = 0; i < 60000; i++)
+        periodic += (char)('a' + (i % 4093) % 26);
+    s.push_back(periodic);
+    return s;
+}
+
+static bool zlibInflate(const std::vector<uint8_t> &in, std::string &out, int windowBits)
+{
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (inflateInit2(&z, windowBits) != Z_OK)
+        return false;
+
+    std::vector<uint8_t> buf(1 << 16);
+    z.next_in = (Bytef *)in.data();
+    z.avail_in = in.size();
+    int ret = Z_OK;
+    out.clear();
+    while (ret == Z_OK)
+    {
+        z.next_out = buf.data();
+        z.avail_out = buf.size();
+        ret = inflate(&z, Z_NO_FLUSH);
+        out.append((const char *)buf.data(), buf.size() - z.avail_out);
+        if (ret == Z_BUF_ERROR && z.avail_in == 0)
+            break;
+    }
+    inflateEnd(&z);
+    return ret == Z_STREAM_END;
+}
+
+static std::vector<uint8_t> zlibDeflate(const std::string &in, int level, int strategy, bool syncFlush)
+{
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    deflateInit2(&z, level, Z_DEFLATED, -15, 8, strategy);
+
+    std::vector<uint8_t> out(deflateBound(&z, in.size()) + 16);
+    z.next_in = (Bytef *)in.data();
+    z.avail_in = in.size();
+    z.next_out = out.data();
+    z.avail_out = out.size();
+    deflate(&z, syncFlush ? Z_SYNC_FLUSH : Z_FINISH);
+    out.resize(out.size() - z.avail_out);
+    deflateEnd(&z);
+    return out;
+}
+
+static void testDeflate(const std::string &in)
+{
+    MB_Deflate deflater;
+    for (uint8_t bits = 9; bits <= MB_DEFLATE_WINDOW_BITS; bits++)
+    {
+        deflater.setWindowBits(bits);
+
+        std::vector<uint8_t> raw, gz;
+        std::string out;
+        expect(deflater.compress((const uint8_t *)in.data(), in.size(), raw, mb_deflate_format_raw), "deflate raw", "compress", in.size());
+        expect(zlibInflate(raw, out, -15) && out == in, "deflate raw", "zlib output differs", in.size());
+
+        expect(deflater.compress((const uint8_t *)in.data(), in.size(), gz, mb_deflate_format_gzip), "deflate gzip", "compress", in.size());
+        expect(zlibInflate(gz, out, 16 + 15) && out == in, "deflate gzip", "zlib output differs", in.size());
+    }
+}
+
+static void testInflate(const std::string &in)
+{
+    static const int strategies[] = {Z_DEFAULT_STRATEGY, Z_FIXED, Z_HUFFMAN_ONLY, Z_RLE};
+    static const uint8_t tail[] = {0x00, 0x00, 0xff, 0xff};
+
+    MB_Inflate inflater;
+    std::vector<uint8_t> out(in.size() + 1);
+
+    for (int level = 0; level <= 9; level += 3)
+    {
+        for (size_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++)
+        {
+            std::vector<uint8_t> z = zlibDeflate(in, level, strategies[s], false);
+            int n = inflater.decompress(z.data(), z.size(), out.data(), out.size());
+            expect(n == (int)in.size() && memcmp(out.data(), in.data(), in.size()) == 0, "inflate", "output differs", in.size());
+
+            // the permessage-deflate message without the sync flush tail
+            z = zlibDeflate(in, level, strategies[s], true);
+            if (z.size() >= 4 && memcmp(z.data() + z.size() - 4, tail, 4) == 0)
+            {
+                n = inflater.decompress(z.data(), z.size() - 4, out.data(), out.size(), tail, 4);
+                expect(n == (int)in.size() && memcmp(out.data(), in.data(), in.size()) == 0, "inflate sync flush", "output differs", in.size());
+            }
+            else
+                expect(false, "inflate sync flush", "no sync flush tail", in.size());
+
+            if (in.size() > 1)
+            {
+                n = inflater.decompress(z.data(), z.size(), out.data(), in.size() - 1);
+                expect(n == MB_INFLATE_OVERFLOW, "inflate overflow", "not detected", in.size());
+            }
+        }
+    }
+}
+
+int main()
+{
+    std::vector<std::string> s = samples();
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        testDeflate(s[i]);
+        testInflate(s[i]);
+    }
+
+    // the reserved block type and the distance before the output start
+    static const uint8_t reserved[] = {0x07};
+    static const uint8_t farDistance[] = {0x03, 0x02, 0x00};
+    uint8_t out[64];
+    MB_Inflate inflater;
+    expect(inflater.decompress(reserved, sizeof(reserved), out, sizeof(out)) == MB_INFLATE_ERROR, "inflate invalid", "reserved block type", 1);
+    expect(inflater.decompress(farDistance, sizeof(farDistance), out, sizeof(out)) == MB_INFLATE_ERROR, "inflate invalid", "distance too far", 3);
+
+    if (failures == 0)
+        printf("inflate: all passed\n");
+
+    return failures == 0 ? 0 : 1;
+}
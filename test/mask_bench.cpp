@@ -0,0 +1,103 @@
+/**
+ * Host benchmark of the WebSocket payload mask, WebSockets::maskPayload against the byte loop it replaces.
+ *
+ *   gcc -O2 -c -Itest/host src/WebSockets/libsha1/libsha1.c src/WebSockets/libb64/cencode.c src/WebSockets/libb64/cdecode.c
+ *   g++ -O2 -std=gnu++11 -Itest/host -Isrc test/mask_bench.cpp test/host/Arduino.cpp src/WebSockets/WebSockets.cpp
+ *       libsha1.o cencode.o cdecode.o -o mask_bench
+ *   ./mask_bench
+ *
+ * The result is first compared with the byte loop for every buffer alignment, stream offset and the lengths
+ * around the word and the unrolled loop sizes, then both are timed from 16 bytes to 15 KB.
+ */
+
+#include <Arduino.h>
+#include <vector>
+#include "WebSockets/WebSockets.h"
+
+// the static mask function is protected
+class MaskAccess : public WebSockets
+{
+public:
+    using WebSockets::maskPayload;
+};
+
+static const uint8_t maskKey[4] = {0x37, 0xfa, 0x21, 0x3d};
+
+// the previous unmask loop of handleWebsocketPayloadCb
+static void maskBytes(uint8_t *data, size_t length, const uint8_t key[4], size_t offset)
+{
+    for (size_t i = 0; i < length; i++)
+        data[i] = (data[i] ^ key[(i + offset) % 4]);
+}
+
+static int failures = 0;
+
+static void check()
+{
+    std::vector<uint8_t> a(128 + 8), b(128 + 8);
+
+    for (size_t align = 0; align < 4; align++)
+    {
+        for (size_t offset = 0; offset < 8; offset++)
+        {
+            for (size_t len = 0; len <= 128; len++)
+            {
+                for (size_t i = 0; i < a.size(); i++)
+                    a[i] = b[i] = (uint8_t)(i * 131 + len);
+
+                MaskAccess::maskPayload(a.data() + align, len, maskKey, offset);
+                maskBytes(b.data() + align, len, maskKey, offset);
+
+                // the bytes around the payload are untouched too
+                if (a != b)
+                {
+                    printf("FAIL mask: align %zu, offset %zu, length %zu\n", align, offset, len);
+                    failures++;
+                }
+            }
+        }
+    }
+}
+
+static double bench(size_t size, bool words, uint32_t &sum)
+{
+    std::vector<uint8_t> buf(size + 1, 0x55);
+    uint8_t *data = buf.data() + 1; // the unaligned start as the payload after the frame header
+    const size_t total = 64 * 1024 * 1024;
+    size_t rounds = total / size;
+
+    unsigned long t = micros();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        if (words)
+            MaskAccess::maskPayload(data, size, maskKey);
+        else
+            maskBytes(data, size, maskKey, 0);
+        sum += data[r % size];
+    }
+    unsigned long us = micros() - t;
+
+    return (double)rounds * size / (us ? us : 1);
+}
+
+int main()
+{
+    check();
+
+    static const size_t sizes[] = {16, 64, 256, 1024, 4096, 15 * 1024};
+    uint32_t sum = 0;
+
+    printf("%-8s %14s %14s %8s\n", "bytes", "bytes MB/s", "words MB/s", "speedup");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        double bytes = bench(sizes[s], false, sum);
+        double words = bench(sizes[s], true, sum);
+        printf("%-8zu %14.0f %14.0f %7.1fx\n", sizes[s], bytes, words, words / bytes);
+    }
+    printf("(checksum %u)\n", sum);
+
+    if (failures == 0)
+        printf("mask: all passed\n");
+
+    return failures == 0 ? 0 : 1;
+}
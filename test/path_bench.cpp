@@ -0,0 +1,272 @@
+/**
+ * Host benchmark of the FirebaseJson string path against the compiled FirebaseJsonPath.
+ *
+ *   g++ -O2 -std=gnu++11 -Itest/host -Isrc test/path_bench.cpp test/host/Arduino.cpp src/json/FirebaseJson.cpp
+ *       src/json/MB_JSON/MB_JSON.c -o path_bench
+ *   ./path_bench
+ *
+ * The get, isMember and set with the compiled paths are first compared with the same string paths, for the
+ * existing and missing items, the missing nodes created by set, the trimmed and empty keys and the paths over
+ * the limits. Then "[k]/id", "[k]/event" and "[k]/value" of the 500 element array are read and replaced as the
+ * element config loop does, the string path built for every item against one path object with setIndex.
+ */
+
+#include <Arduino.h>
+#include <string>
+#include "json/FirebaseJson.h"
+
+static const int elementCount = 500;
+static int failures = 0;
+
+static void expect(bool ok, const char *name, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+static bool sameData(FirebaseJsonData &a, FirebaseJsonData &b)
+{
+    return a.success == b.success && a.typeNum == b.typeNum && a.stringValue == b.stringValue &&
+           a.intValue == b.intValue && a.type == b.type;
+}
+
+static std::string toStd(FirebaseJson &json)
+{
+    String s;
+    json.toString(s);
+    return s.c_str();
+}
+
+static std::string toStd(FirebaseJsonArray &arr)
+{
+    String s;
+    arr.toString(s);
+    return s.c_str();
+}
+
+// the element config array as ESPForm saves it, built with the string paths
+static void makeElements(FirebaseJsonArray &arr)
+{
+    char path[32];
+    for (int k = 0; k < elementCount; k++)
+    {
+        snprintf(path, sizeof(path), "[%d]/id", k);
+        arr.set(path, (String("element") + String(k)).c_str());
+        snprintf(path, sizeof(path), "[%d]/event", k);
+        arr.set(path, k % 30);
+        snprintf(path, sizeof(path), "[%d]/value", k);
+        arr.set(path, (String("value") + String(k)).c_str());
+    }
+}
+
+static void checkGet()
+{
+    FirebaseJsonArray arr;
+    makeElements(arr);
+
+    FirebaseJson json;
+    json.setJsonData("{\"a\":{\"b\":[1,{\"c\":\"x\"},true,null,2.5]},\"key with space\":{\"d\":\"y\"},\"n\":7}");
+
+    static const char *arrayPaths[] = {"[0]/id", "[499]/value", "[250]/event", "[7]", "/[3]/value/", " [12] / id ",
+                                       "[500]/id", "[3]/missing", "[3]/id/deeper", "[x]/id", ""};
+    for (size_t i = 0; i < sizeof(arrayPaths) / sizeof(arrayPaths[0]); i++)
+    {
+        FirebaseJsonData a, b;
+        bool ra = arr.get(a, arrayPaths[i]);
+        bool rb = arr.get(b, FirebaseJsonPath(arrayPaths[i]));
+        expect(ra == rb && sameData(a, b), "array get", arrayPaths[i]);
+    }
+
+    static const char *objectPaths[] = {"a/b/[1]/c", "a/b/[2]", "a/b/[3]", "a/b/[4]", "a/b", "//a//b/[0]", "n",
+                                        "key with space/d", " a / b / [1] / c ", "a/b/[9]", "a/x", "n/m", "missing",
+                                        "a/  /b/[0]", " n "};
+    for (size_t i = 0; i < sizeof(objectPaths) / sizeof(objectPaths[0]); i++)
+    {
+        FirebaseJsonData a, b;
+        bool ra = json.get(a, objectPaths[i]);
+        bool rb = json.get(b, FirebaseJsonPath(objectPaths[i]));
+        expect(ra == rb && sameData(a, b), "object get", objectPaths[i]);
+        expect(json.isMember(objectPaths[i]) == json.isMember(FirebaseJsonPath(objectPaths[i])), "isMember", objectPaths[i]);
+    }
+
+    FirebaseJsonData prettyA, prettyB;
+    json.get(prettyA, "a", true);
+    json.get(prettyB, FirebaseJsonPath("a"), true);
+    expect(sameData(prettyA, prettyB), "object get", "prettify");
+}
+
+static void checkSet()
+{
+    // the replaced items and the missing nodes, objects, array items and the null padding, created by set
+    static const char *paths[] = {"a/b/c", "a/b/c", "a/b/d", "a/[2]/e", "list/[3]", "list/[1]/x", "list/[5]/[2]",
+                                  " a / b / f ", "//g//", "a/   /k", " z ", "a/b/c/h", "list", "n"};
+
+    FirebaseJson byString, byPath;
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+    {
+        byString.set(paths[i], (int)i);
+        byPath.set(FirebaseJsonPath(paths[i]), (int)i);
+        expect(toStd(byString) == toStd(byPath), "object set", paths[i]);
+    }
+
+    byString.set("x/y", "text");
+    byPath.set(FirebaseJsonPath("x/y"), "text");
+    byString.set("x/z");
+    byPath.set(FirebaseJsonPath("x/z"));
+    byString.set("x/[1]", 1.5);
+    byPath.set(FirebaseJsonPath("x/[1]"), 1.5);
+    expect(toStd(byString) == toStd(byPath), "object set", "value types");
+
+    FirebaseJsonArray arrString, arrPath;
+    makeElements(arrString);
+    makeElements(arrPath);
+    static const char *arrayPaths[] = {"[3]/value", "[3]/added", "[502]/id", "[504]", "[1]/[2]/x", "[0]"};
+    for (size_t i = 0; i < sizeof(arrayPaths) / sizeof(arrayPaths[0]); i++)
+    {
+        arrString.set(arrayPaths[i], (int)i);
+        arrPath.set(FirebaseJsonPath(arrayPaths[i]), (int)i);
+        expect(toStd(arrString) == toStd(arrPath), "array set", arrayPaths[i]);
+    }
+
+    // the path on the other root type clears it as the string path does
+    FirebaseJson json;
+    FirebaseJsonArray arr;
+    json.setJsonData("[1,2]");
+    arr.setJsonArrayData("{\"a\":1}");
+    FirebaseJson json2;
+    FirebaseJsonArray arr2;
+    json2.setJsonData("[1,2]");
+    arr2.setJsonArrayData("{\"a\":1}");
+    json.set("a", 1);
+    json2.set(FirebaseJsonPath("a"), 1);
+    arr.set("[0]/a", 1);
+    arr2.set(FirebaseJsonPath("[0]/a"), 1);
+    expect(toStd(json) == toStd(json2) && toStd(arr) == toStd(arr2), "set", "root type");
+}
+
+static void checkCompile()
+{
+    FirebaseJsonPath path;
+    std::string tooLong(FIREBASEJSON_PATH_MAX_LENGTH, 'a');
+    expect(!path.compile(tooLong.c_str()) && !path.valid(), "compile", "path too long");
+
+    std::string tooMany;
+    for (int i = 0; i <= FIREBASEJSON_PATH_MAX_SEGMENTS; i++)
+        tooMany += "a/";
+    expect(!path.compile(tooMany.c_str()) && !path.valid(), "compile", "too many keys");
+
+    // the invalid path finds nothing and changes nothing
+    FirebaseJson json;
+    json.set("a", 1);
+    FirebaseJsonData data;
+    expect(!json.get(data, path) && !json.isMember(path), "compile", "invalid path found");
+    std::string before = toStd(json);
+    json.set(path, 2);
+    expect(toStd(json) == before, "compile", "invalid path set");
+
+    expect(path.compile("[9]/value") && path.setIndex(0, 10) && strcmp(path.key(0), "[10]") == 0 &&
+               strcmp(path.key(1), "value") == 0 && path.index(0) == 10,
+           "compile", "setIndex");
+    expect(!path.setIndex(1, 3), "compile", "setIndex on the key");
+}
+
+static double benchGet(FirebaseJsonArray &arr, bool compiled, int rounds, long &sum)
+{
+    FirebaseJsonData data;
+    FirebaseJsonPath idPath("[0]/id"), eventPath("[0]/event"), valuePath("[0]/value");
+    char path[32];
+
+    unsigned long t = micros();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int k = 0; k < elementCount; k++)
+        {
+            if (compiled)
+            {
+                idPath.setIndex(0, k);
+                eventPath.setIndex(0, k);
+                valuePath.setIndex(0, k);
+                arr.get(data, idPath);
+                sum += data.stringValue.length();
+                arr.get(data, eventPath);
+                sum += data.intValue;
+                arr.get(data, valuePath);
+                sum += data.stringValue.length();
+            }
+            else
+            {
+                snprintf(path, sizeof(path), "[%d]/id", k);
+                arr.get(data, path);
+                sum += data.stringValue.length();
+                snprintf(path, sizeof(path), "[%d]/event", k);
+                arr.get(data, path);
+                sum += data.intValue;
+                snprintf(path, sizeof(path), "[%d]/value", k);
+                arr.get(data, path);
+                sum += data.stringValue.length();
+            }
+        }
+    }
+    return (micros() - t) / 1000.0;
+}
+
+static double benchSet(FirebaseJsonArray &arr, bool compiled, int rounds)
+{
+    FirebaseJsonPath valuePath("[0]/value");
+    char path[32];
+
+    unsigned long t = micros();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (int k = 0; k < elementCount; k++)
+        {
+            if (compiled)
+            {
+                valuePath.setIndex(0, k);
+                arr.set(valuePath, r);
+            }
+            else
+            {
+                snprintf(path, sizeof(path), "[%d]/value", k);
+                arr.set(path, r);
+            }
+        }
+    }
+    return (micros() - t) / 1000.0;
+}
+
+int main()
+{
+    checkGet();
+    checkSet();
+    checkCompile();
+
+    const int rounds = 20;
+    long sumString = 0, sumPath = 0;
+    FirebaseJsonArray arr;
+    makeElements(arr);
+
+    double getString = benchGet(arr, false, rounds, sumString);
+    double getPath = benchGet(arr, true, rounds, sumPath);
+    expect(sumString == sumPath, "bench", "different get results");
+
+    FirebaseJsonArray arrString, arrPath;
+    makeElements(arrString);
+    makeElements(arrPath);
+    double setString = benchSet(arrString, false, rounds);
+    double setPath = benchSet(arrPath, true, rounds);
+    expect(toStd(arrString) == toStd(arrPath), "bench", "different set results");
+
+    printf("%d rounds of %d elements\n", rounds, elementCount);
+    printf("%-22s %12s %12s %8s\n", "", "string ms", "compiled ms", "speedup");
+    printf("%-22s %12.1f %12.1f %7.1fx\n", "get id, event, value", getString, getPath, getString / getPath);
+    printf("%-22s %12.1f %12.1f %7.1fx\n", "set value", setString, setPath, setString / setPath);
+
+    if (failures == 0)
+        printf("path: all passed\n");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+/**
+ * Host test of MB_JSONReader with the strings longer than the token buffer.
+ *
+ *   g++ -O2 -std=gnu++11 -Itest/host -Isrc test/reader_test.cpp test/host/Arduino.cpp -o reader_test
+ *   ./reader_test
+ *
+ * The element config with the long id and values (plain, escaped and \u encoded) is fed in chunks of several
+ * sizes and read from a Stream, the string pieces joined by the visitor must equal the original text.
+ * The long key and number still fail with MB_JSON_READER_ERROR_TOKEN_SIZE.
+ */
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "json/MB_JSONReader.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char *name, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+// collects the keys and the joined string values
+class JoinVisitor : public MB_JSONVisitor
+{
+public:
+    std::vector<std::string> keys;
+    std::vector<std::string> strings;
+    size_t pieces = 0;
+
+    bool key(const char *key, size_t len) override
+    {
+        keys.push_back(std::string(key, len));
+        return true;
+    }
+
+    bool value(const mb_json_reader_value_t &value) override
+    {
+        if (value.type != MB_JSON_String)
+            return true;
+        if (!_continued)
+            strings.push_back(std::string());
+        strings.back().append(value.str, value.len);
+        expect(value.len == strlen(value.str), "piece", "not null terminated");
+        _continued = value.more;
+        pieces++;
+        return true;
+    }
+
+private:
+    bool _continued = false;
+};
+
+class StringStream : public Stream
+{
+public:
+    StringStream(const std::string &s) : _s(s) {}
+    int available() override { return (int)(_s.size() - _pos); }
+    int read() override { return _pos < _s.size() ? (uint8_t)_s[_pos++] : -1; }
+    int peek() override { return _pos < _s.size() ? (uint8_t)_s[_pos] : -1; }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    std::string _s;
+    size_t _pos = 0;
+};
+
+static std::string longText(size_t len)
+{
+    std::string s;
+    for (size_t i = 0; s.size() < len; i++)
+        s += (char)('a' + i % 26);
+    return s;
+}
+
+static void testLongStrings()
+{
+    std::string id = longText(MB_JSON_READER_TOKEN_SIZE - 1);
+    std::string value = longText(MB_JSON_READER_TOKEN_SIZE * 4 + 7);
+
+    // the escaped and \u encoded text, the 3 and 4 byte UTF-8 characters cross the piece ends
+    std::string escapedJson, escaped;
+    for (size_t i = 0; escaped.size() < MB_JSON_READER_TOKEN_SIZE * 3; i++)
+    {
+        escapedJson += "\\\"x\\n\\u20ac\\ud83d\\ude00";
+        escaped += "\"x\n\xe2\x82\xac\xf0\x9f\x98\x80";
+    }
+
+    std::string json = "{\"esp\":[{\"id\":\"" + id + "\",\"event\":4,\"value\":\"" + value + "\"},"
+                       "{\"id\":\"text1\",\"value\":\"" + escapedJson + "\"},{\"id\":\"\",\"value\":\"short\"}]}";
+
+    static const size_t chunks[] = {1, 3, 64, 100000};
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++)
+    {
+        JoinVisitor visitor;
+        MB_JSONReader reader(visitor);
+        reader.reset();
+        for (size_t pos = 0; pos < json.size(); pos += chunks[c])
+            reader.parse(json.data() + pos, std::min(chunks[c], json.size() - pos));
+
+        expect(reader.end(), "long strings", "read error");
+        expect(visitor.strings.size() == 6, "long strings", "wrong value count");
+        if (visitor.strings.size() == 6)
+        {
+            expect(visitor.strings[0] == id, "long strings", "id of the token size");
+            expect(visitor.strings[1] == value, "long strings", "long value");
+            expect(visitor.strings[3] == escaped, "long strings", "escaped value");
+            expect(visitor.strings[4].empty() && visitor.strings[5] == "short", "long strings", "short value");
+        }
+        expect(visitor.pieces > visitor.strings.size(), "long strings", "not passed in pieces");
+    }
+
+    JoinVisitor visitor;
+    MB_JSONReader reader(visitor);
+    StringStream stream(json);
+    expect(reader.read(stream) && visitor.strings.size() == 6 && visitor.strings[1] == value, "stream", "long value");
+}
+
+static void testTokenSize()
+{
+    std::string longKey = "{\"" + longText(MB_JSON_READER_TOKEN_SIZE) + "\":1}";
+    std::string longNumber = "[" + std::string(MB_JSON_READER_TOKEN_SIZE, '1') + "]";
+    const std::string *docs[] = {&longKey, &longNumber};
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        JoinVisitor visitor;
+        MB_JSONReader reader(visitor);
+        reader.reset();
+        expect(!reader.parse(docs[i]->data(), docs[i]->size()) && reader.error() == MB_JSON_READER_ERROR_TOKEN_SIZE, "token size", i == 0 ? "long key" : "long number");
+    }
+}
+
+int main()
+{
+    testLongStrings();
+    testTokenSize();
+
+    if (failures == 0)
+        printf("reader: all passed\n");
+
+    return failures == 0 ? 0 : 1;
+}
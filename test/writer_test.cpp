@@ -0,0 +1,281 @@
+/**
+ * Host test of MB_JSON_PrintToWriter against MB_JSON_Print and MB_JSON_PrintUnformatted.
+ *
+ *   g++ -O1 -g -std=gnu++11 -fsanitize=address -Isrc test/writer_test.cpp src/json/MB_JSON/MB_JSON.c -o writer_test
+ *   ./writer_test
+ *
+ * The random trees with the escaped and control characters, the numbers, the strings and raw values longer than
+ * the buffer and the deep nesting are printed with the buffer sizes from MB_JSON_WRITER_MIN_BUFFER_SIZE up, the
+ * written text must equal the allocated print and the writer never gets more than the buffer. The bytes after the
+ * buffer are checked to be untouched. The writer that writes less than it was given stops the print with the
+ * written text as the prefix of the full print.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "json/MB_JSON/MB_JSON.h"
+
+static int failures = 0;
+static uint32_t seed = 2463534242u;
+
+static void expect(bool ok, const char *name, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+static uint32_t next()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+struct Output
+{
+    std::string text;
+    size_t buffer;
+    size_t calls;
+    size_t shortAt; // the call that writes less, 0 for none
+    bool oversized;
+};
+
+static size_t collect(void *context, const char *data, size_t length)
+{
+    Output *out = (Output *)context;
+    out->calls++;
+    if (length >= out->buffer)
+        out->oversized = true;
+    if (out->shortAt > 0 && out->calls == out->shortAt)
+        length /= 2;
+    out->text.append(data, length);
+    return length;
+}
+
+static std::string randomText(size_t len)
+{
+    static const char *pieces[] = {"a", "Z", "7", " ", "\"", "\\", "/", "\n", "\t", "\r", "\b", "\f", "\x01", "\x1f",
+                                   "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80"};
+    std::string s;
+    while (s.size() < len)
+        s += pieces[next() % (sizeof(pieces) / sizeof(pieces[0]))];
+    return s;
+}
+
+static MB_JSON *randomValue(int depth)
+{
+    uint32_t kind = next() % (depth > 5 ? 7 : 9);
+    switch (kind)
+    {
+    case 0:
+        return MB_JSON_CreateNull();
+    case 1:
+        return MB_JSON_CreateBool(next() % 2);
+    case 2:
+        return MB_JSON_CreateNumber((int32_t)next());
+    case 3:
+        return MB_JSON_CreateNumber((double)(int32_t)next() / (next() % 1000 + 1) * 1e-3);
+    case 4:
+        return MB_JSON_CreateString(randomText(next() % 8).c_str());
+    case 5:
+        // up to 3 times of the largest tested buffer around the minimum
+        return MB_JSON_CreateString(randomText(next() % 160).c_str());
+    case 6:
+    {
+        std::string raw = "[";
+        size_t n = next() % 60;
+        for (size_t i = 0; i < n; i++)
+            raw += (i ? "," : "") + std::to_string(next() % 100000);
+        return MB_JSON_CreateRaw((raw + "]").c_str());
+    }
+    case 7:
+    {
+        MB_JSON *array = MB_JSON_CreateArray();
+        size_t n = next() % 5;
+        for (size_t i = 0; i < n; i++)
+            MB_JSON_AddItemToArray(array, randomValue(depth + 1));
+        return array;
+    }
+    default:
+    {
+        MB_JSON *object = MB_JSON_CreateObject();
+        size_t n = next() % 5;
+        for (size_t i = 0; i < n; i++)
+            MB_JSON_AddItemToObject(object, randomText(next() % 12).c_str(), randomValue(depth + 1));
+        return object;
+    }
+    }
+}
+
+static std::string print(const MB_JSON *item, bool format)
+{
+    char *s = format ? MB_JSON_Print(item) : MB_JSON_PrintUnformatted(item);
+    std::string out = s ? s : "";
+    MB_JSON_free(s);
+    return out;
+}
+
+static bool printToWriter(const MB_JSON *item, size_t size, bool format, Output &out, size_t shortAt = 0)
+{
+    const size_t guard = 16;
+    std::vector<char> buffer(size + guard, '\x5a');
+
+    out.text.clear();
+    out.buffer = size;
+    out.calls = 0;
+    out.shortAt = shortAt;
+    out.oversized = false;
+
+    bool ok = MB_JSON_PrintToWriter(item, buffer.data(), (int)size, format, collect, &out);
+
+    for (size_t i = size; i < size + guard; i++)
+    {
+        if (buffer[i] != '\x5a')
+        {
+            expect(false, "writer", "buffer overflow");
+            break;
+        }
+    }
+    return ok;
+}
+
+static void checkTree(MB_JSON *tree, const char *name)
+{
+    static const size_t sizes[] = {MB_JSON_WRITER_MIN_BUFFER_SIZE, MB_JSON_WRITER_MIN_BUFFER_SIZE + 1,
+                                   MB_JSON_WRITER_MIN_BUFFER_SIZE + 2, MB_JSON_WRITER_MIN_BUFFER_SIZE + 3,
+                                   MB_JSON_WRITER_MIN_BUFFER_SIZE + 5, MB_JSON_WRITER_MIN_BUFFER_SIZE + 7,
+                                   MB_JSON_WRITER_MIN_BUFFER_SIZE * 2 - 1, 64, 100, 1024};
+
+    for (int format = 0; format < 2; format++)
+    {
+        std::string expected = print(tree, format);
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            Output out;
+            bool ok = printToWriter(tree, sizes[s], format, out);
+            expect(ok, name, format ? "formatted print failed" : "print failed");
+            expect(out.text == expected, name, format ? "formatted text differs" : "text differs");
+            expect(!out.oversized, name, "write larger than the buffer");
+        }
+    }
+}
+
+static void testRandom()
+{
+    for (int i = 0; i < 400; i++)
+    {
+        MB_JSON *tree = randomValue(0);
+        checkTree(tree, "random");
+        MB_JSON_Delete(tree);
+    }
+}
+
+static void testLong()
+{
+    // the single long string and raw values, the number and escape at every piece boundary
+    for (size_t len = 0; len < 3 * MB_JSON_WRITER_MIN_BUFFER_SIZE; len++)
+    {
+        MB_JSON *array = MB_JSON_CreateArray();
+        MB_JSON_AddItemToArray(array, MB_JSON_CreateString(std::string(len, 'x').c_str()));
+        MB_JSON_AddItemToArray(array, MB_JSON_CreateString((std::string(len, 'y') + "\x01\"").c_str()));
+        MB_JSON_AddItemToArray(array, MB_JSON_CreateRaw(("\"" + std::string(len, 'r') + "\"").c_str()));
+        MB_JSON_AddItemToArray(array, MB_JSON_CreateNumber(-1.2345678901234567e-300));
+        MB_JSON *object = MB_JSON_CreateObject();
+        MB_JSON_AddItemToObject(object, std::string(len, 'k').c_str(), MB_JSON_CreateNumber(len));
+        MB_JSON_AddItemToArray(array, object);
+        checkTree(array, "long");
+        MB_JSON_Delete(array);
+    }
+}
+
+static MB_JSON *nested(int depth)
+{
+    MB_JSON *root = MB_JSON_CreateArray();
+    MB_JSON *parent = root;
+    for (int d = 1; d < depth; d += 2)
+    {
+        MB_JSON *child = MB_JSON_CreateObject();
+        MB_JSON_AddItemToObject(child, "v", MB_JSON_CreateString("text"));
+        MB_JSON_AddItemToArray(parent, child);
+        parent = MB_JSON_AddArrayToObject(child, "a");
+    }
+    return root;
+}
+
+static void testNesting()
+{
+    // the formatted print needs the indent and the line end in the buffer
+    MB_JSON *root = nested(MB_JSON_WRITER_MIN_BUFFER_SIZE - 2);
+    checkTree(root, "nesting");
+    MB_JSON_Delete(root);
+
+    // the deeper tree fails without writing past the buffer, the unformatted print has no indent
+    root = nested(MB_JSON_WRITER_MIN_BUFFER_SIZE + 8);
+    std::string expected = print(root, true);
+    Output out;
+    expect(!printToWriter(root, MB_JSON_WRITER_MIN_BUFFER_SIZE, true, out), "nesting", "too deep printed");
+    expect(expected.compare(0, out.text.size(), out.text) == 0, "nesting", "not the prefix");
+    expect(printToWriter(root, MB_JSON_WRITER_MIN_BUFFER_SIZE, false, out) && out.text == print(root, false), "nesting", "unformatted");
+    MB_JSON_Delete(root);
+}
+
+static void testShortWrite()
+{
+    MB_JSON *tree = NULL;
+    std::string expected;
+    while (expected.size() < 20 * MB_JSON_WRITER_MIN_BUFFER_SIZE)
+    {
+        MB_JSON_Delete(tree);
+        tree = randomValue(0);
+        expected = print(tree, false);
+    }
+
+    for (size_t shortAt = 1; shortAt <= 20; shortAt++)
+    {
+        Output out;
+        bool ok = printToWriter(tree, MB_JSON_WRITER_MIN_BUFFER_SIZE, false, out, shortAt);
+        expect(!ok, "short write", "not failed");
+        expect(out.calls == shortAt, "short write", "written after the short write");
+        expect(expected.compare(0, out.text.size(), out.text) == 0, "short write", "not the prefix");
+    }
+    MB_JSON_Delete(tree);
+}
+
+static void testArguments()
+{
+    MB_JSON *tree = MB_JSON_CreateString("x");
+    char buffer[MB_JSON_WRITER_MIN_BUFFER_SIZE];
+    Output out;
+    out.buffer = sizeof(buffer);
+    out.calls = out.shortAt = 0;
+    out.oversized = false;
+
+    expect(!MB_JSON_PrintToWriter(tree, buffer, MB_JSON_WRITER_MIN_BUFFER_SIZE - 1, false, collect, &out), "arguments", "small buffer");
+    expect(!MB_JSON_PrintToWriter(NULL, buffer, sizeof(buffer), false, collect, &out), "arguments", "no item");
+    expect(!MB_JSON_PrintToWriter(tree, NULL, sizeof(buffer), false, collect, &out), "arguments", "no buffer");
+    expect(!MB_JSON_PrintToWriter(tree, buffer, sizeof(buffer), false, NULL, &out), "arguments", "no writer");
+    expect(out.calls == 0, "arguments", "written");
+    MB_JSON_Delete(tree);
+}
+
+int main()
+{
+    testRandom();
+    testLong();
+    testNesting();
+    testShortWrite();
+    testArguments();
+
+    if (failures == 0)
+        printf("writer: all passed\n");
+
+    return failures == 0 ? 0 : 1;
+}
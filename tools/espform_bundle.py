@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+Pack the web page files into the ESPForm asset bundle header.
+
+    python3 espform_bundle.py -o bundle.h -n web_bundle data/
+
+The files in the directories are added with their path relative to the directory,
+e.g. data/css/style.css is served as /css/style.css. Each file is gzip compressed
+unless the compressed data is not smaller, the file with .gz or .br extension is taken
+as already compressed and served without the extension.
+
+The encoding variants to emit are selected with -e, e.g. -e br,gzip,identity emits
+all of them and the device picks one by the browser's Accept-Encoding. The brotli
+compression requires the Python brotli package (pip install brotli).
+
+The browsers advertise br in Accept-Encoding only over HTTPS, the ESPForm web server
+is plain HTTP, so the br variant is only used behind a TLS proxy and otherwise just
+takes the flash space, gzip is the default.
+
+Add the bundle in the sketch with
+
+    #include "bundle.h"
+    ESPForm.addBundle(web_bundle);
+
+The bundle format is described in src/ESPFormBundle.h.
+"""
+
+import argparse
+import gzip
+import os
+import struct
+import sys
+
+VERSION = 1
+EMPTY_SLOT = 0xFFFF
+FLAG_GZIP = 1
+FLAG_BR = 2
+
+# the encoding flags of the variant, also their order in the bundle
+ENCODINGS = {"identity": 0, "gzip": FLAG_GZIP, "br": FLAG_BR}
+SUFFIXES = {".gz": FLAG_GZIP, ".br": FLAG_BR}
+
+# the order of ESPForm_MIMEInfo in src/MIMEInfo.h
+EXTENSIONS = [".html", ".htm", ".css", ".txt", ".js", ".json", ".png", ".gif", ".jpg", ".ico", ".svg",
+              ".ttf", ".otf", ".woff", ".woff2", ".eot", ".sfnt", ".xml", ".pdf", ".zip", ".gz", ".appcache"]
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def mime_index(path):
+    # the device matches the extension case-insensitively (strcasecmp_P)
+    path = path.lower()
+    for i, ext in enumerate(EXTENSIONS):
+        if path.endswith(ext):
+            return i
+    return len(EXTENSIONS)
+
+
+def compress(data, encoding):
+    if encoding == FLAG_GZIP:
+        # mtime 0 keeps the output (and the ETag) the same for the same input
+        return gzip.compress(data, 9, mtime=0)
+    try:
+        import brotli
+    except ImportError:
+        sys.exit("the br encoding requires the brotli package, pip install brotli")
+    return brotli.compress(data, quality=11)
+
+
+def load(path, name, encodings):
+    """Return the request path and the {encoding flag: data} variants of the file."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    for suffix, encoding in SUFFIXES.items():
+        if name.endswith(suffix):
+            return name[:-len(suffix)], {encoding: data}
+
+    variants = {}
+    for encoding in encodings:
+        if encoding != 0:
+            packed = compress(data, encoding)
+            if len(packed) < len(data):
+                variants[encoding] = packed
+
+    if 0 in encodings or not variants:
+        variants[0] = data
+    return name, variants
+
+
+def collect(inputs, root, encodings):
+    files = {}
+    for item in inputs:
+        if os.path.isdir(item):
+            base = root or item
+            for dirpath, _, names in os.walk(item):
+                for n in sorted(names):
+                    full = os.path.join(dirpath, n)
+                    files["/" + os.path.relpath(full, base).replace(os.sep, "/")] = full
+        else:
+            base = root or os.path.dirname(item)
+            files["/" + os.path.relpath(item, base).replace(os.sep, "/")] = item
+
+    # the precompressed file replaces the variant of its encoding
+    variants = {}
+    for name in sorted(files, key=lambda n: any(n.endswith(s) for s in SUFFIXES)):
+        path, v = load(files[name], name, encodings)
+        variants.setdefault(path, {}).update(v)
+
+    entries = []
+    for path in sorted(variants):
+        for encoding in sorted(variants[path]):
+            entries.append((path, variants[path][encoding], encoding))
+    return entries
+
+
+def pack(entries):
+    count = len(entries)
+    if count == 0 or count >= EMPTY_SLOT:
+        sys.exit("the bundle must have 1 to 65534 files")
+
+    slot_count = 16
+    while slot_count < count * 2:
+        slot_count <<= 1
+
+    # the variants share the path string
+    paths = []
+    for e in entries:
+        if not paths or paths[-1] != e[0].encode("utf-8"):
+            paths.append(e[0].encode("utf-8"))
+    path_base = 12 + count * 24 + slot_count * 2
+    data_base = path_base + sum(len(p) + 1 for p in paths)
+
+    # the data is 4 bytes aligned for the flash access
+    data_base = (data_base + 3) & ~3
+
+    table = bytearray()
+    slots = [EMPTY_SLOT] * slot_count
+    path_offset = path_base
+    data_offset = data_base
+    blobs = bytearray()
+    last = None
+
+    for index, (path, data, encoding) in enumerate(entries):
+        raw = path.encode("utf-8")
+        route = fnv1a(raw)
+
+        # only the first variant of the path is in the slot table
+        if raw != last:
+            if last is not None:
+                path_offset += len(last) + 1
+            last = raw
+            i = route & (slot_count - 1)
+            while slots[i] != EMPTY_SLOT:
+                i = (i + 1) & (slot_count - 1)
+            slots[i] = index
+
+        content_hash = fnv1a(data) or 1
+        table += struct.pack("<IIIIIBBH", path_offset, data_offset, len(data), content_hash, route,
+                             mime_index(path), encoding, len(raw))
+
+        pad = (-len(data)) & 3
+        blobs += data + b"\0" * pad
+        data_offset += len(data) + pad
+
+    out = bytearray(b"ESPB")
+    out += struct.pack("<BBHHH", VERSION, 0, count, slot_count, 0)
+    out += table
+    out += struct.pack("<%dH" % slot_count, *slots)
+    for p in paths:
+        out += p + b"\0"
+    out += b"\0" * (data_base - len(out))
+    out += blobs
+    return bytes(out)
+
+
+def write_header(out, name, entries, bundle):
+    lines = ["// generated by espform_bundle.py, do not edit", "//"]
+    names = dict((v, k) for k, v in ENCODINGS.items())
+    for path, data, encoding in entries:
+        lines.append("// %s %d bytes %s" % (path, len(data), names[encoding]))
+    lines.append("")
+    lines.append("#pragma once")
+    lines.append("")
+    lines.append("#include <Arduino.h>")
+    lines.append("")
+    lines.append("static const uint8_t %s[] PROGMEM __attribute__((aligned(4))) = {" % name)
+    for i in range(0, len(bundle), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in bundle[i:i + 16]) + ",")
+    lines.append("};")
+    lines.append("")
+    out.write("\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack the web page files into the ESPForm asset bundle header.")
+    parser.add_argument("inputs", nargs="+", help="the files or directories to pack")
+    parser.add_argument("-o", "--output", default="bundle.h", help="the output header file")
+    parser.add_argument("-n", "--name", default="web_bundle", help="the array name")
+    parser.add_argument("--root", help="the directory which the request paths are relative to")
+    parser.add_argument("-e", "--encodings", default="gzip",
+                        help="the comma separated encoding variants to emit, identity, gzip and br (default gzip), "
+                             "br is only requested by the browsers over HTTPS")
+    args = parser.parse_args()
+
+    encodings = []
+    for name in args.encodings.split(","):
+        if name.strip() not in ENCODINGS:
+            sys.exit("unknown encoding " + name)
+        encodings.append(ENCODINGS[name.strip()])
+
+    if FLAG_BR in encodings and FLAG_GZIP not in encodings:
+        sys.stderr.write("warning: the browsers request br only over HTTPS, add gzip for the plain HTTP server\n")
+
+    entries = collect(args.inputs, args.root, encodings)
+    bundle = pack(entries)
+
+    with open(args.output, "w") as f:
+        write_header(f, args.name, entries, bundle)
+
+    print("%s: %d files, %d bytes" % (args.output, len(entries), len(bundle)))
+
+
+if __name__ == "__main__":
+    main()